@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	10/10/2016
-* Last mod: 	05/12/2016
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	The NVIC registers can only be accessed from the priviliged mode. Since the
@@ -207,3 +207,27 @@ uint32_t nvic_get_priority(IRQn_Type irq) {
 	else 
 		return (SCB->SHP[EXCEP_IRQ_No + irq] >> PRIO_BIT_OFFSET) & PRIO_Msk;
 }
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	nvic_get_active_priority
+* Purpose:    	Get the priority of the exception/interrupt currently being handled
+* Arguments: 	-
+* Returns: 		
+*		priority of the active exception (0 - highest, 7 - lowest). 0 for the 
+*		exceptions with fixed priority (NMI, Hard Fault) and MIN_IRQ_PRIO + 1 if
+*		no exception is active (Thread mode)
+--------------------------------------------------------------------------------*/
+uint32_t nvic_get_active_priority(void) {
+	
+	// Exception number of the active exception
+	uint32_t exception = __get_ipsr();
+	
+	if (exception == 0)
+		return MIN_IRQ_PRIO + 1;
+	else if (exception < 4)
+		return 0;
+	else 
+		return nvic_get_priority((IRQn_Type) ((int32_t) exception - 16));
+}
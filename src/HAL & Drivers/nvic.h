@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	10/10/2016
-* Last mod: 	11/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -95,3 +95,16 @@ uint32_t nvic_set_priority(IRQn_Type irq, uint32_t priority);
 *		priority of given IRQ (0 - highest, 7 - lowest)
 --------------------------------------------------------------------------------*/
 uint32_t nvic_get_priority(IRQn_Type irq);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	nvic_get_active_priority
+* Purpose:    	Get the priority of the exception/interrupt currently being handled
+* Arguments: 	-
+* Returns: 		
+*		priority of the active exception (0 - highest, 7 - lowest). 0 for the 
+*		exceptions with fixed priority (NMI, Hard Fault) and MIN_IRQ_PRIO + 1 if
+*		no exception is active (Thread mode)
+--------------------------------------------------------------------------------*/
+uint32_t nvic_get_active_priority(void);
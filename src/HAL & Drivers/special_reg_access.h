@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	30/09/2016
-* Last mod: 	11/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 	
 *	This file acts as a bridge between KrisOS kernel C and Assembly code. Thanks
@@ -138,8 +138,9 @@ uint32_t __get_ipsr(void);
 
 /*------------------------------------------------------------------------------
 * Function:    	__start_critical
-* Purpose:    	Enter critical section by disabling interrupts and saving the 
-* 				prevous interrupt control value in PRIMASK register
+* Purpose:    	Enter critical section by masking the interrupts which are allowed
+*				to call the kernel (priority MAX_SYSCALL_PRIORITY or lower) and 
+*				saving the previous value of BASEPRI
 * Arguments: 	-	
 * Returns: 		-
 *-----------------------------------------------------------------------------*/
@@ -149,7 +150,7 @@ void __start_critical(void);
 
 /*------------------------------------------------------------------------------
 * Function:    	__end_critical
-* Purpose:    	End critical section by restoring the previous value of PRIMASK
+* Purpose:    	End critical section by restoring the previous value of BASEPRI
 * Arguments: 	-	
 * Returns: 		-
 *-----------------------------------------------------------------------------*/
@@ -4,7 +4,7 @@
 ; Author: 		Krzysztof Koch
 ; Version:		V1.00
 ; Date created:	26/09/2016
-; Last mod: 	11/03/2017
+; Last mod: 	18/10/2026
 ;
 ; Note: 		
 ;	Methods allowing access to Cortex-M4 internal registers and other
@@ -190,31 +190,37 @@ __get_ipsr		PROC
 
 ;-------------------------------------------------------------------------------
 ; Function:    	__start_critical
-; Purpose:    	Enter critical section by disabling interrupts and saving the 
-; 				prevous interrupt control value in PRIMASK register
+; Purpose:    	Enter critical section by masking the interrupts which are allowed
+;				to call the kernel (priority MAX_SYSCALL_PRIORITY or lower) and 
+;				saving the previous value of BASEPRI. Interrupts with a higher
+;				priority are never delayed by the kernel. BASEPRI_MAX is used, so 
+;				the masking level can only be raised by nested critical sections.
 ; Arguments: 	-	
 ; Returns: 		-
 ;-------------------------------------------------------------------------------
 				EXPORT	__start_critical
+				IMPORT 	syscallMaskLevel
 __start_critical\
 				PROC
-				MRS		R0, PRIMASK
+				MRS		R0, BASEPRI
 				PUSH 	{R0}
-				CPSID	I
+				LDR 	R0, =syscallMaskLevel
+				LDR 	R0, [R0]
+				MSR		BASEPRI_MAX, R0
 				BX 		LR
 				ENDP
 
 
 ;-------------------------------------------------------------------------------
 ; Function:    	__end_critical
-; Purpose:    	End critical section by restoring the previous value of PRIMASK
+; Purpose:    	End critical section by restoring the previous value of BASEPRI
 ; Arguments: 	-	
 ; Returns: 		-
 ;-------------------------------------------------------------------------------
 				EXPORT	__end_critical
 __end_critical	PROC
 				POP 	{R0}
-				MSR		PRIMASK, R0
+				MSR		BASEPRI, R0
 				BX 		LR
 				ENDP
 
@@ -4,7 +4,7 @@
 ; Author: 		Krzysztof Koch
 ; Version:		V1.00
 ; Date created:	26/09/2016
-; Last mod: 	10/03/2016
+; Last mod: 	18/10/2026
 ;
 ; Note: 		
 ;	System startup code containing stack and heap definitions as well as simple 
@@ -283,6 +283,13 @@ UsageFault_Handler\
 ; they use PSP as the stack pointer. This means that this test is done 'just in case'.
 ; as it should always be the PSP which is saved before the SVC call continues and is 
 ; restored before the SVC Call returns
+;
+; If the call has blocked the calling task or woken a more urgent one, SVC_Handler_C
+; returns 1 (and cancels the pending PendSV). The context switch is then made right
+; here, by branching to the context switching code of the PendSV handler with the
+; SVC's EXC_RETURN in LR, instead of in a PendSV exception tail-chained after the 
+; SVC returns. The exception frame stacked on SVC entry is reused as it is. 
+; Asynchronous preemption (interrupts, OS timer) still switches through PendSV.
 ;-------------------------------------------------------------------------------					
 SVC_Handler     PROC
 				IMPORT 	scheduler
@@ -296,7 +303,10 @@ SVC_Handler     PROC
 				BL 		SVC_Handler_C
 				LDR 	R1, =scheduler		; Restore the EXC_RETURN so that 
 				LDR		LR, [R1, #8] 		; any changes to the MSP or PSP
-				BX 		LR 					; don't propagate to the calling user code
+											; don't propagate to the calling user code
+				CMP 	R0, #0 				; Switch the context straight away if
+				BNE 	ContextSwitch 		; the call has requested it
+				BX 		LR 					
                 ENDP
 					
 					
@@ -354,10 +364,14 @@ DebugMon_Handler\
 ;-------------------------------------------------------------------------------	
 PendSV_Handler	PROC
 				IMPORT 	scheduler
+				IMPORT 	syscallMaskLevel
+				IMPORT 	kernelInfo
                 EXPORT  PendSV_Handler
 					
-				; Save current context
-				CPSID	I 					; Disable Interrupts
+				; Save current context (also entered from SVC_Handler)
+ContextSwitch	LDR 	R1, =syscallMaskLevel ; Mask the interrupts which can call
+				LDR 	R1, [R1] 			; the kernel. The ones above 
+				MSR 	BASEPRI, R1 		; MAX_SYSCALL_PRIORITY stay enabled
 				MRS 	R0, PSP				; Get current PSP
 				TST 	LR, #0x10			; Check if floating point context should 
                 IT 		EQ					; be saved and save floating point registers 
@@ -369,9 +383,26 @@ PendSV_Handler	PROC
 				LDR 	R1, [R2] 			; context saving, remains to be saved inside
 				STR 	R0, [R1] 			; task's metadata runPtr->sp = R0
 											
-				; Load next context
+				; Count the switch on the kernel information page, unless the 
+				; running task is resumed (the switch was cancelled by the scheduler).
+				; Same as KrisOS_seqlock_write_begin/end around kernelInfo.contextSwitches++
 				LDR 	R3, [R2, #4] 		; Load the pointer to the next task to run
-				LDR		R0, [R3]			; Load the SP of the next task R0 = scheduler->topPrioTask->sp
+				CMP 	R3, R1
+				BEQ 	LoadContext
+				LDR 	R12, =kernelInfo
+				LDR 	R1, [R12] 			; Make the sequence odd (update in progress)
+				ADD 	R1, R1, #1
+				STR 	R1, [R12]
+				DMB
+				LDR 	R0, [R12, #20] 		; kernelInfo.contextSwitches++
+				ADD 	R0, R0, #1
+				STR 	R0, [R12, #20]
+				DMB
+				ADD 	R1, R1, #1 			; Make the sequence even again
+				STR 	R1, [R12]
+											
+				; Load next context
+LoadContext		LDR		R0, [R3]			; Load the SP of the next task R0 = scheduler->topPrioTask->sp
 				STR		R3, [R2]			; scheduler->runPtr = scheduler->topPrioTask
 				LDMIA 	R0!, {R2-R11} 		; Restore the values of LR, CONTROL and R4-R11 
 				MOV		LR, R2 				; from the task's private stack
@@ -381,7 +412,8 @@ PendSV_Handler	PROC
 				IT		EQ 					; Test bit 4. If zero, need to unstack 
 				VLDMIAEQ R0!, {S16-S31} 	; floating point registers
 				MSR 	PSP, R0 			; Set PSP to next task's stack pointer
-				CPSIE	I					; Re-enable Interrupts 
+				MOV 	R1, #0 				; Unmask interrupts (PendSV and SVC have
+				MSR 	BASEPRI, R1 		; the lowest priority, nothing was masked)
 				BX 		LR					; return
                 ENDP
 					
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	30/09/2016
-* Last mod: 	11/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		Methods for controlling the system clock speed, periodic 
 *				interrupts using SysTick timer, as well as other timing utilities
@@ -124,13 +124,68 @@ void systick_config(uint32_t cycles) {
 	// Main clock as source, SysTick enabled with IRQs. 
 	SYSTICK->CTRL |= (1 << CTRL_CLK_SRC) | (1 << CTRL_INTEN) | (1 << CTRL_ENABLE);	
 
-	// Reset the OS 'ticks' counter
-	KrisOS.ticks = 0;
+	// Reset the OS 'ticks' counter and start the first time slice
+	KrisOS.ticks = KrisOS.ticksHigh = 0;
+	KrisOS.sliceTicks = TIME_SLICE;
 	
 	// OS clock ticks are the most important events in the KrisOS operating system. So,
-	// they have maximum priority
-	nvic_set_priority(SysTick_IRQn, 0);
+	// they have the maximum priority an interrupt calling the kernel can have
+	nvic_set_priority(SysTick_IRQn, MAX_SYSCALL_PRIORITY);
 
 }
 
 
+
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_counter_init
+* Purpose:    	Enable the DWT CPU cycle counter used for performance measurements
+*				and for the kernel's high-resolution timestamps
+* Arguments: 	-
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_counter_init(void) {
+	
+	// The DWT unit is only powered when trace is enabled in the debug monitor
+	DEMCR |= 1U << DEMCR_TRCENA;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= 1 << DWT_CYCCNTENA;
+}
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_stat_update
+* Purpose:    	Record the number of CPU cycles elapsed since 'start' 
+* Arguments: 	
+*		stat - statistic to update
+*		start - DWT cycle counter value at the start of the measured section
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_stat_update(CycleStat* stat, uint32_t start) {
+	
+	// Unsigned subtraction handles the cycle counter wrap-around
+	uint32_t elapsed = DWT->CYCCNT - start;
+	
+	stat->last = elapsed;
+	stat->total += elapsed;
+	stat->count++;
+	if (elapsed > stat->max)
+		stat->max = elapsed;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_stat_reset
+* Purpose:    	Clear the statistic given (start a new measurement period)
+* Arguments: 	
+*		stat - statistic to reset
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_stat_reset(CycleStat* stat) {
+	stat->last = stat->max = stat->total = stat->count = 0;
+}
+#endif
+
+
@@ -4,11 +4,12 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	30/09/2016
-* Last mod: 	04/12/2016
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
 #include "common.h"
+#include "KrisOS.h"
 
 
 
@@ -68,3 +69,39 @@ void system_clock_config(uint32_t oscSrc, uint32_t divider);
 void systick_config(uint32_t cycles);
 
 
+
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_counter_init
+* Purpose:    	Enable the DWT CPU cycle counter used for performance measurements
+*				and for the kernel's high-resolution timestamps
+* Arguments: 	-
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_counter_init(void);
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_stat_update
+* Purpose:    	Record the number of CPU cycles elapsed since 'start' 
+* Arguments: 	
+*		stat - statistic to update
+*		start - DWT cycle counter value at the start of the measured section
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_stat_update(CycleStat* stat, uint32_t start);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	cycle_stat_reset
+* Purpose:    	Clear the statistic given (start a new measurement period)
+* Arguments: 	
+*		stat - statistic to reset
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+void cycle_stat_reset(CycleStat* stat);
+#endif
+
+
@@ -20,6 +20,7 @@
 *		8. Inter-Integrated Circuit interface 
 *		9. Analog-to-Digital 
 *		10. Pulse Width 
+*		11. Data Watchpoint and Trace (cycle counter)
 *	
 *******************************************************************************/
 #include "common.h"
@@ -189,6 +190,25 @@ typedef struct
 
 
 
+/*-------------------------------------------------------------------------------
+* Floating point unit registers
+*------------------------------------------------------------------------------*/
+typedef struct {
+       uint32_t RESERVED0;
+  __IO uint32_t FPCCR;                  // Floating-point Context Control Register 
+  __IO uint32_t FPCAR;                  // Floating-point Context Address Register 
+  __IO uint32_t FPDSCR;                 // Floating-point Default Status Control Register 
+} FPU_Type;
+#define FPU_Base 0xE000EF30
+#define FPU ((FPU_Type*) FPU_Base)
+
+// FPCCR register 
+#define ASPEN 31 					// Automatic State Preservation Enable
+#define LSPEN 30 					// Lazy State Preservation Enable
+#define LSPACT 0					// Lazy State Preservation Active
+
+
+
 /*-------------------------------------------------------------------------------
 * System control registers
 *------------------------------------------------------------------------------*/
@@ -414,6 +434,14 @@ typedef struct {                          // SYSCTL Structure
 #define RCGC_PWM0 0
 #define RCGC_PWM1 1
 
+// RCGCWTIMER 32/64-Bit Wide General-Purpose Timer Run mode clock gating control
+#define RCGC_WTIMER0 0
+#define RCGC_WTIMER1 1
+#define RCGC_WTIMER2 2
+#define RCGC_WTIMER3 3
+#define RCGC_WTIMER4 4
+#define RCGC_WTIMER5 5
+
 // RCGCGPIO register 
 #define RCGCGPIO_PORTA 0
 #define RCGCGPIO_PORTB 1
@@ -495,6 +523,27 @@ typedef struct
 
 
 
+/*-------------------------------------------------------------------------------
+* Data Watchpoint and Trace unit registers (cycle counter only)
+*------------------------------------------------------------------------------*/
+typedef struct
+{
+	__IO uint32_t CTRL;                  	// DWT Control Register
+	__IO uint32_t CYCCNT;                   // DWT Cycle Count Register
+} DWT_Type;
+
+#define DWT_Base 0xE0001000
+#define DWT ((DWT_Type*) DWT_Base)
+
+// CTRL register 
+#define DWT_CYCCNTENA 0
+
+// Debug Exception and Monitor Control Register (enables the DWT unit)
+#define DEMCR (*((__IO uint32_t*) 0xE000EDFC))
+#define DEMCR_TRCENA 24
+
+
+
 /*-------------------------------------------------------------------------------
 * GPIO registers
 *------------------------------------------------------------------------------*/
@@ -1111,4 +1160,77 @@ typedef struct {                                    // PWM0 Structure
 #define PWMENABLE_PWM7EN 7
 
 
+
+/*-------------------------------------------------------------------------------
+* General-Purpose Timer registers 
+*------------------------------------------------------------------------------*/
+typedef struct {                                    // WTIMER0 Structure
+  __IO uint32_t  CFG;                               // GPTM Configuration
+  __IO uint32_t  TAMR;                              // GPTM Timer A Mode
+  __IO uint32_t  TBMR;                              // GPTM Timer B Mode
+  __IO uint32_t  CTL;                               // GPTM Control
+  __IO uint32_t  SYNC;                              // GPTM Synchronize
+  __I  uint32_t  RESERVED;
+  __IO uint32_t  IMR;                               // GPTM Interrupt Mask
+  __IO uint32_t  RIS;                               // GPTM Raw Interrupt Status
+  __IO uint32_t  MIS;                               // GPTM Masked Interrupt Status
+  __O  uint32_t  ICR;                               // GPTM Interrupt Clear
+  __IO uint32_t  TAILR;                             // GPTM Timer A Interval Load
+  __IO uint32_t  TBILR;                             // GPTM Timer B Interval Load
+  __IO uint32_t  TAMATCHR;                          // GPTM Timer A Match
+  __IO uint32_t  TBMATCHR;                          // GPTM Timer B Match
+  __IO uint32_t  TAPR;                              // GPTM Timer A Prescale
+  __IO uint32_t  TBPR;                              // GPTM Timer B Prescale
+  __IO uint32_t  TAPMR;                             // GPTM TimerA Prescale Match
+  __IO uint32_t  TBPMR;                             // GPTM TimerB Prescale Match
+  __IO uint32_t  TAR;                               // GPTM Timer A
+  __IO uint32_t  TBR;                               // GPTM Timer B
+  __IO uint32_t  TAV;                               // GPTM Timer A Value
+  __IO uint32_t  TBV;                               // GPTM Timer B Value
+  __IO uint32_t  RTCPD;                             // GPTM RTC Predivide
+  __IO uint32_t  TAPS;                              // GPTM Timer A Prescale Snapshot
+  __IO uint32_t  TBPS;                              // GPTM Timer B Prescale Snapshot
+  __IO uint32_t  TAPV;                              // GPTM Timer A Prescale Value
+  __IO uint32_t  TBPV;                              // GPTM Timer B Prescale Value
+  __I  uint32_t  RESERVED1[981];
+  __IO uint32_t  PP;                                // GPTM Peripheral Properties
+} TIMER_Type;
+
+#define WTIMER0_BASE 0x40036000UL
+#define WTIMER0 ((TIMER_Type*) WTIMER0_BASE)
+
+// CFG Configuration Register (32/64-bit wide timers)
+#define GPTMCFG_64BIT 0x0
+#define GPTMCFG_32BIT 0x4
+
+// TAMR Timer A Mode Register
+#define TAMR_TAMR 0
+#define TAMR_TACMR 2
+#define TAMR_TAAMS 3
+#define TAMR_TACDIR 4
+#define TAMR_TAMIE 5
+#define TAMR_TAWOT 6
+#define TAMR_TASNAPS 7
+#define TAMR_TAILD 8
+#define TAMR_TAPWMIE 9
+#define TAMR_TAMRSU 10
+#define TAMR_TAPLO 11
+
+// TAMR timer modes
+#define TAMR_ONE_SHOT 0x1
+#define TAMR_PERIODIC 0x2
+#define TAMR_CAPTURE 0x3
+
+// CTL Control Register
+#define GPTMCTL_TAEN 0
+#define GPTMCTL_TASTALL 1
+
+// IMR/RIS/MIS/ICR Interrupt Registers
+#define GPTMINT_TATO 0
+#define GPTMINT_CAM 1
+#define GPTMINT_CAE 2
+#define GPTMINT_RTC 3
+#define GPTMINT_TAM 4
+
+
 #endif
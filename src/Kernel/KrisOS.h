@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	30/09/2016
-* Last mod: 	14/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -21,15 +21,34 @@
 #define USE_MUTEX 					// Use mutexes
 #define USE_SEMAPHORE 				// Use semaphores
 #define USE_QUEUE 					// Use queues
+#define USE_PQUEUE 					// Use priority message queues
+#define USE_MAILBOX 				// Use latest-value mailboxes
+#define USE_TOPIC 					// Use publish/subscribe topics
+#define USE_RWLOCK 					// Use reader-writer locks
+#define USE_EVENT_GROUP 			// Use event flag groups
+#define USE_NOTIFY 					// Use direct-to-task notifications
+#define USE_CONDVAR 				// Use condition variables
+#define USE_BARRIER 				// Use cyclic barriers
+#define USE_SOFT_TIMER 				// Use software timers
+#define USE_HR_TIMER 				// Use the microsecond-resolution hardware timer service
+#define USE_WORKQUEUE 				// Use deferred interrupt work queues
+#define USE_BASIC_TASK 				// Use run-to-completion basic tasks sharing one stack
+#define USE_COROUTINE 				// Use stackless coroutines run by one kernel task
 #define USE_HEAP 					// Use dynamic memory
 #define USE_UART 					// Enable UART driver
 #define SHOW_DIAGNOSTIC_DATA		// Show OS usage statistics etc.
+//#define SYNC_BENCHMARK			// Create the benchmark tasks the stats task measures with
 
 
 
 /*******************************************************************************
 * Resolve KrisOS feature dependencies, some optional features have to 'go together'
 *******************************************************************************/
+// The benchmarks are run and reported by the stats task
+#if defined SYNC_BENCHMARK && !defined SHOW_DIAGNOSTIC_DATA
+	#define SHOW_DIAGNOSTIC_DATA
+#endif
+
 // To display diagnostic data the UART interface via USB must be enabled
 #if defined SHOW_DIAGNOSTIC_DATA && !defined USE_UART
 	#define USE_UART
@@ -41,6 +60,38 @@
 	#define USE_SEMAPHORE
 #endif
 
+// Priority queues use semaphores the same way as FIFO queues do
+#if defined USE_PQUEUE && !defined USE_SEMAPHORE
+	#define USE_SEMAPHORE
+#endif
+
+// Topics use semaphores for keeping track of free sample buffers and samples
+// waiting for each subscriber
+#if defined USE_TOPIC && !defined USE_SEMAPHORE
+	#define USE_SEMAPHORE
+#endif
+
+// Condition variables are always used together with a mutex
+#if defined USE_CONDVAR && !defined USE_MUTEX
+	#define USE_MUTEX
+#endif
+
+// The timer service task is woken by the OS timer interrupt with a task 
+// notification
+#if defined USE_SOFT_TIMER && !defined USE_NOTIFY
+	#define USE_NOTIFY
+#endif
+
+// Work queue workers are woken with task notifications as well
+#if defined USE_WORKQUEUE && !defined USE_NOTIFY
+	#define USE_NOTIFY
+#endif
+
+// So is the coroutine executor task
+#if defined USE_COROUTINE && !defined USE_NOTIFY
+	#define USE_NOTIFY
+#endif
+
 
 
 /*******************************************************************************
@@ -50,6 +101,20 @@ typedef struct Task Task;			// Task Control Block
 typedef struct Mutex Mutex; 		// Mutex
 typedef struct Semaphore Semaphore; // Semaphore
 typedef struct Queue Queue; 		// Queue
+typedef struct QueueOps QueueOps;	// Typed queue copy routines
+typedef struct PriorityQueue PriorityQueue; // Priority message queue
+typedef struct SeqLock SeqLock; 	// Sequence lock
+typedef struct Mailbox Mailbox; 	// Latest-value mailbox
+typedef struct Topic Topic; 		// Publish/subscribe topic
+typedef struct TopicBuffer TopicBuffer; 		// Reference-counted topic sample buffer
+typedef struct TopicSubscriber TopicSubscriber; // Topic subscriber
+typedef struct RwLock RwLock; 		// Reader-writer lock
+typedef struct EventGroup EventGroup; // Event flag group
+typedef struct CondVar CondVar; 	// Condition variable
+typedef struct Barrier Barrier; 	// Cyclic barrier
+typedef struct SoftTimer SoftTimer; // Software timer
+typedef struct HrTimer HrTimer; 	// High-resolution (hardware) timer event
+typedef struct Coroutine Coroutine; // Stackless coroutine
 typedef struct __FILE __FILE;		// File definition (for redirecting output stream)
 
 
@@ -70,19 +135,52 @@ typedef struct __FILE __FILE;		// File definition (for redirecting output stream
 // Definition of infinity, for pernamently suspending tasks using KrisOS_task_sleep()
 #define TIME_INFINITY 0
 
+// Longest finite delay or timeout (in OS 'ticks'). The kernel keeps time in 32-bit
+// wrapping 'ticks', so longer ones are shortened to this value (about 2.5 days 
+// at the OS clock frequency of 10kHz)
+#define TIME_MAX_DELAY 0x7FFFFFFFU
+
+// Exit status returned by the timed waits if the timeout expires before the
+// object waited on becomes available. Kept apart from the fatal EXIT codes in
+// assertions.h so that the two can't be mistaken for one another
+#define EXIT_TIMEOUT 11
+
 // System clock frequency
 extern uint32_t SYSTEM_CLOCK_FREQ;
 
 
+/*-----------------------------------------------------------------------------
+* Interrupt priority setup
+------------------------------------------------------------------------------*/
+// The most urgent interrupt priority (1-7, 0 is the highest) allowed to call the 
+// KrisOS *_ISR functions. Kernel critical sections mask only the interrupts with
+// this or lower priority, so interrupts with a higher priority (0 to 
+// MAX_SYSCALL_PRIORITY - 1) are never delayed by the kernel, but they must not 
+// use any KrisOS services. The OS timer interrupt runs at this priority.
+#define MAX_SYSCALL_PRIORITY 2
+
+
 /*-----------------------------------------------------------------------------
 * Scheduler setup
 ------------------------------------------------------------------------------*/
 // Time quantum size for preemptive scheduling (in OS clock 'ticks')
 #define TIME_SLICE 500
 
+// Wake-up slack (in OS 'ticks') the tasks' sleeps get by default and the largest
+// slack a sleep can be given. A task with slack can be woken up to that many
+// 'ticks' early, together with another task, so that one wake-up serves both.
+#define TIMER_SLACK_DEFAULT 0
+#define TIMER_SLACK_MAX 100
+
 // Size of the task registry (for debugging purposes) 
 #define TASK_REGISTRY_SIZE 20
 
+// Switch to the next task right at the exit of an SVC call which has blocked the
+// calling task (or woken a more urgent one), instead of in a PendSV exception
+// tail-chained to it. Comment out to compare the semaphore ping-pong round trip
+// reported by the stats task (with SYNC_BENCHMARK enabled).
+#define SVC_DIRECT_SWITCH
+
 
 /*-----------------------------------------------------------------------------
 * Heap Manager setup
@@ -95,6 +193,14 @@ extern uint32_t SYSTEM_CLOCK_FREQ;
 #define MIN_BLOCK_SIZE (4 * sizeof(HeapBlock))
 
 
+/*-----------------------------------------------------------------------------
+* Mutex setup
+------------------------------------------------------------------------------*/
+// Maximum number of tasks in a chain of 'waiting-for' dependencies which have
+// their priority boosted by the priority inheritance algorithm
+#define MTX_INHERIT_MAX_DEPTH 8
+
+
 /*-----------------------------------------------------------------------------
 * Serial Monitor setup 
 * The UART interface over USB is preconfigured to:
@@ -115,6 +221,91 @@ extern Mutex uartMtx;
 #endif
 
 
+/*-----------------------------------------------------------------------------
+* Priority queue setup
+------------------------------------------------------------------------------*/
+// Number of priority ranges the message queueing latency is reported for. The 
+// 256 message priorities are split evenly between the classes.
+#define PQUEUE_LATENCY_CLASSES 4
+
+
+/*-----------------------------------------------------------------------------
+* Topic setup
+------------------------------------------------------------------------------*/
+// Number of samples each topic subscriber can have waiting (preferably a power 
+// of 2)
+#define TOPIC_SUBSCRIBER_DEPTH 4
+
+
+/*-----------------------------------------------------------------------------
+* Software timer setup
+------------------------------------------------------------------------------*/
+// Number of slots of the timer wheel (has to be a power of 2). The timers are
+// hashed into the slots by their expiry time, so that each slot holds few of them.
+#define TIMER_WHEEL_SIZE 64
+
+// Priority and private stack size (in bytes) of the timer service task which 
+// runs the timer callbacks
+#define TIMER_TASK_PRIO 0
+#define TIMER_TASK_STACK_SIZE 512
+
+
+/*-----------------------------------------------------------------------------
+* High-resolution timer setup
+------------------------------------------------------------------------------*/
+// Maximum number of high-resolution timer events pending at the same time
+// (size of the deadline heap, at most 255)
+#define HR_TIMER_CAPACITY 16
+
+// Longest delay (in microseconds) a high-resolution timer event can be started
+// with. Longer delays should use the OS 'ticks'.
+#define HR_TIMER_MAX_DELAY_US 1000000
+
+// Sleeps shorter than this (in microseconds) are spun instead of blocking, as 
+// two context switches would take longer than the sleep itself
+#define HR_SLEEP_SPIN_US 10
+
+
+/*-----------------------------------------------------------------------------
+* Work queue setup
+------------------------------------------------------------------------------*/
+// Number of work queues and the priorities of their worker tasks (one worker 
+// per queue, e.g. an urgent queue and a background one)
+#define WORKQUEUE_NO 2
+#define WORKQUEUE_PRIORITIES {1, 200}
+
+// Number of work items each queue can hold (has to be a power of 2) and the 
+// private stack size (in bytes) of each worker task
+#define WORKQUEUE_CAPACITY 16
+#define WORKQUEUE_STACK_SIZE 512
+
+
+/*-----------------------------------------------------------------------------
+* Basic task setup
+------------------------------------------------------------------------------*/
+// Size of the stack shared by all the basic tasks (in bytes). It has to hold one 
+// basic task of each priority level preempting one another, each with about 
+// 100-200 bytes of context saved when preempted, on top of its own stack usage.
+#define BASIC_STACK_SIZE 1024
+
+// Number of activations of a basic task which can be queued while it is 
+// already active (further activations fail)
+#define BASIC_ACTIVATIONS_MAX 3
+
+
+/*-----------------------------------------------------------------------------
+* Coroutine setup
+------------------------------------------------------------------------------*/
+// Priority and private stack size (in bytes) of the task running the coroutines
+// (all the coroutines share its stack)
+#define COROUTINE_TASK_PRIO 100
+#define COROUTINE_TASK_STACK_SIZE 512
+
+// Period (in OS 'ticks') the coroutines awaiting a condition (KrisOS_co_await)
+// check it again with
+#define COROUTINE_POLL_PERIOD 10
+
+
 /*-----------------------------------------------------------------------------
 * Usage statistics task setup
 ------------------------------------------------------------------------------*/
@@ -125,6 +316,23 @@ extern Mutex uartMtx;
 // Statistics task'S priority
 #define DIAG_DATA_PRIO (UINT8_MAX - 1)
 
+// Number of tasks created for the barrier benchmark (SYNC_BENCHMARK). Together 
+// with the stats task, they synchronise at barriers of 2, 4 and 8 parties.
+#define BARRIER_BENCH_TASKS 7
+
+// Number of reader tasks created for the contended reader benchmark 
+// (SYNC_BENCHMARK). They read next to the stats task through a reader-writer
+// lock and through a mutex.
+#define READER_BENCH_TASKS 3
+
+// Task registry entries taken by the benchmark tasks (pong, mutexBench and the
+// barrier and reader benchmark tasks), on top of TASK_REGISTRY_SIZE
+#ifdef SYNC_BENCHMARK
+	#define SYNC_BENCH_TASK_NO (2 + BARRIER_BENCH_TASKS + READER_BENCH_TASKS)
+#else
+	#define SYNC_BENCH_TASK_NO 0
+#endif
+
 
 
 /*******************************************************************************
@@ -141,6 +349,12 @@ typedef enum {
 	SLEEPING,
 	MTX_WAIT,
 	SEM_WAIT,
+	RW_WAIT,
+	EVENT_WAIT,
+	NOTIFY_WAIT,
+	COND_WAIT,
+	BARRIER_WAIT,
+	DORMANT,
 	REMOVED,
 } TaskState;
 
@@ -158,10 +372,32 @@ typedef struct Task {
 	int32_t id; 					// Task unique identifier
 	uint8_t priority; 				// Task priority
 	TaskState status; 				// Current task status
-	uint64_t waitCounter;			// The time (in OS 'ticks') when the task should be woken up
+	uint32_t waitCounter;			// The time (in OS 'ticks') when the task should be woken up
 	uint32_t* stackBottom; 			// Pointer to the bottom of private stack (full-descending). 
 	void* waitingObj;				// Synchronisation object the task is waiting for (Mutex/Semaphore)
 	uint8_t basePrio; 				// Base priority of the task given (used for priority inheritance)
+	Task* timerNext; 				// Pointer to the next task in the scheduler's blocked (timer) queue
+	Task* timerPrevious; 			// Pointer to the previous task in the blocked (timer) queue
+	Task** waitQueue; 				// Waiting queue of the object the task is blocked on (timed waits)
+	uint16_t timerSlack; 			// Wake-up slack of the task's sleeps (in OS 'ticks')
+	uint16_t waitSlack; 			// Slack of the current sleep (earliest wake-up at 
+									// waitCounter - waitSlack)
+#ifdef USE_BASIC_TASK
+	void* entry; 					// Code of a basic task, started at each activation 
+									// (NULL for the extended tasks)
+	Task* basicBelow; 				// Basic task started before this one (on the shared stack)
+	uint8_t activations; 			// Activations of the basic task queued while active
+	uint8_t isStarted; 				// 1 if the basic task has a frame on the shared stack
+	uint8_t isPrivileged; 			// 1 if the basic task runs privileged
+#endif
+#ifdef USE_EVENT_GROUP
+	uint32_t eventMask; 			// Event flags waited for
+	uint8_t eventOptions; 			// Event wait options (EVENT_WAIT_ALL, EVENT_CLEAR_ON_EXIT)
+#endif
+#ifdef USE_NOTIFY
+	volatile uint32_t notifyValue; 	// Notification word (0 - no notification pending)
+	uint8_t notifyOptions; 			// Notification wait options (NOTIFY_CLEAR)
+#endif
 #ifdef USE_MUTEX
 	Mutex* mutexHeld; 				// List of mutexes held
 #endif
@@ -177,11 +413,19 @@ typedef struct Task {
 * Mutex definiton
 ------------------------------------------------------------------------------*/
 #ifdef USE_MUTEX
+// Ceiling of the mutexes using priority inheritance instead of the priority 
+// ceiling protocol
+#define MTX_NO_CEILING UINT8_MAX
+
 typedef struct Mutex {
 	Task* owner; 					// Task owning the mutex
 	Task* waitingQueue; 			// Queue of tasks waiting for the mutex
+	uint8_t ceiling; 				// Priority the owner runs at (MTX_NO_CEILING - inheritance)
+	uint8_t listed; 				// Is the mutex on the owner's list of mutexes held
+	Mutex* nextHeld; 				// Next mutex in the owner's list of mutexes held
 #ifdef SHOW_DIAGNOSTIC_DATA 		// Last time mutex was taken (for critical
-	uint64_t timeTaken; 			// section length calculation)
+	uint32_t timeTaken; 			// section length calculation)
+	uint32_t maxLockTime; 			// Longest lock time not yet collected by the kernel
 #endif
 } Mutex;
 
@@ -195,6 +439,9 @@ typedef struct Mutex {
 typedef struct Semaphore {
 	uint32_t counter; 				// Semaphore counter value
 	Task* waitingQueue; 			// Queue of tasks waiting for the semaphore
+#ifdef USE_COROUTINE
+	volatile uint32_t coroutineWaiters; // Number of coroutines awaiting the semaphore
+#endif
 } Semaphore;
 #endif
 
@@ -205,13 +452,327 @@ typedef struct Semaphore {
 #ifdef USE_QUEUE
 typedef struct Queue {
 	uint8_t* buffer; 				// Buffer storing the data placed in the queue
-	size_t bufferSize; 				// Buffer size in bytes
+	uint8_t* bufferEnd; 			// First byte past the end of the buffer
 	size_t itemSize; 				// Size (in bytes) of a single item stored
 	uint8_t* head;					// Current values of the head and tail pointers
 	uint8_t* tail;			
+	const QueueOps* ops; 			// Typed copy routines, NULL for generic (memcpy) queues
 	Semaphore elementsStored;		// Number of elements currently in the queue 
 	Semaphore remainingCapacity;	// Remaining buffer capacity (in number of elements)
 } Queue;
+
+// Item copy routines of a typed queue. Generated per item type by 
+// KrisOS_queue_typed_template so that the item size is a compile-time constant
+typedef struct QueueOps {
+	void (*enqueue)(Queue* queue, const void* item);	// Copy the item in and advance head
+	void (*dequeue)(Queue* queue, void* item); 			// Copy the item out and advance tail
+	size_t itemSize; 									// sizeof the item type
+} QueueOps;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Priority queue
+------------------------------------------------------------------------------*/
+#ifdef USE_PQUEUE
+// Heap entry describing a single message stored
+typedef struct {
+	uint32_t sequence; 				// Write order (FIFO among equal priorities)
+	uint16_t slot; 					// Index of the slot holding the message
+	uint8_t priority; 				// Message priority, 0 is the most urgent
+#ifdef SHOW_DIAGNOSTIC_DATA
+	uint32_t timeQueued; 			// Cycle counter value when the message was written
+#endif
+} PQueueEntry;
+
+// Memory (in bytes) needed for the heap and slots of a priority queue
+#define PQUEUE_MEMORY_SIZE(CAPACITY, ITEM_SIZE) 							\
+	((CAPACITY) * (sizeof(PQueueEntry) + (ITEM_SIZE)))
+
+typedef struct PriorityQueue {
+	PQueueEntry* heap; 				// Binary min-heap of the messages stored
+	uint8_t* buffer; 				// Message slots
+	size_t capacity; 				// Number of messages the queue can fit
+	size_t itemSize; 				// Size (in bytes) of a single message
+	size_t count; 					// Number of entries in the heap
+	uint32_t sequence; 				// Sequence number of the next message written
+	Semaphore elementsStored;		// Number of messages currently in the queue 
+	Semaphore remainingCapacity;	// Remaining capacity (in number of messages)
+} PriorityQueue;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Sequence lock
+------------------------------------------------------------------------------*/
+typedef struct SeqLock {
+	volatile uint32_t sequence; 	// Update counter, odd while an update is in progress
+} SeqLock;
+
+
+/*-----------------------------------------------------------------------------
+* Kernel information page. Published by the kernel and read by the tasks using
+* KrisOS_kernel_info. It takes a single 64-byte aligned block of memory, so that
+* it can be given its own read-only MPU region. The context switching code 
+* (startup.s) relies on the offset of 'contextSwitches'.
+------------------------------------------------------------------------------*/
+typedef struct KernelInfo {
+	SeqLock lock; 					// Protects the page against torn reads
+	Task* runningTask; 				// Task running (or about to be switched to)
+	uint64_t ticks; 				// OS 'ticks' since the OS start
+	uint32_t tickTimestamp; 		// CPU cycle counter (DWT) value at the last 'tick'
+	uint32_t contextSwitches; 		// Number of task switches since the OS start
+	uint32_t taskNo; 				// Number of tasks in the scheduler
+	uint32_t mutexNo; 				// Number of mutexes in use
+	uint32_t semNo; 				// Number of semaphores in use (a queue uses two)
+	uint32_t queueNo; 				// Number of queues (FIFO and priority) in use
+	uint32_t reserved[6]; 			// Pads the page to 64 bytes
+} KernelInfo;
+
+
+/*-----------------------------------------------------------------------------
+* Mailbox
+------------------------------------------------------------------------------*/
+#ifdef USE_MAILBOX
+typedef struct Mailbox {
+	SeqLock lock; 					// Protects the item against torn reads
+	uint8_t* buffer; 				// Memory storing the most recent item
+	size_t itemSize; 				// Size (in bytes) of the item
+#ifdef SHOW_DIAGNOSTIC_DATA 		// Number of times a reader had to repeat a
+	uint32_t readRetries; 			// torn read (updated by the readers)
+#endif
+} Mailbox;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Topic
+------------------------------------------------------------------------------*/
+#ifdef USE_TOPIC
+// What to do with a new sample when a subscriber's ring is full
+typedef enum {
+	TOPIC_DROP_OLDEST, 				// Drop the oldest unread sample
+	TOPIC_BLOCK, 					// Make the publisher wait
+} TopicPolicy;
+
+// Header of a sample buffer in the topic pool. The sample follows the header.
+typedef struct TopicBuffer {
+	TopicBuffer* nextFree; 			// Next buffer in the pool's free list
+	uint32_t refCount; 				// Number of subscribers yet to release the sample
+} TopicBuffer;
+
+// Size of a single pool buffer (header + sample rounded up to 8 bytes)
+#define TOPIC_SLOT_SIZE(ITEM_SIZE) (sizeof(TopicBuffer) + (((ITEM_SIZE) + 7) & ~7U))
+
+typedef struct TopicSubscriber {
+	Topic* topic; 					// Topic subscribed to
+	TopicSubscriber* next; 			// Next subscriber of the same topic
+	TopicBuffer* ring[TOPIC_SUBSCRIBER_DEPTH]; // Samples not yet received
+	uint32_t head; 					// Free-running ring write and read counters
+	uint32_t tail;
+	TopicPolicy policy; 			// Behaviour when the ring is full
+	Semaphore samplesReady; 		// Number of samples waiting in the ring
+	Semaphore freeSlots; 			// Free ring slots (TOPIC_BLOCK policy only)
+	uint32_t dropped; 				// Samples dropped for this subscriber
+} TopicSubscriber;
+
+typedef struct Topic {
+	TopicBuffer* freeList; 			// Buffers currently not in use
+	Semaphore freeBuffers; 			// Number of buffers on the free list
+	TopicSubscriber* subscribers; 	// List of subscribers
+	size_t itemSize; 				// Size (in bytes) of a single sample
+	uint32_t published; 			// Number of samples published
+	uint32_t dropped; 				// Number of samples dropped (over all subscribers)
+} Topic;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Reader-writer lock
+------------------------------------------------------------------------------*/
+#ifdef USE_RWLOCK
+// Reader-writer lock state word flags. The remaining bits count the readers.
+#define RWLOCK_WRITER 0x80000000U 			// A writer holds the lock
+#define RWLOCK_WRITERS_WAITING 0x40000000U 	// At least one writer is waiting
+#define RWLOCK_READERS 0x3FFFFFFFU 			// Number of readers holding the lock
+
+typedef struct RwLock {
+	volatile uint32_t state; 		// Writer flags and reader count
+	Task* writer; 					// Task holding the lock for writing
+	Task* readQueue; 				// Queue of readers waiting
+	Task* writeQueue; 				// Queue of writers waiting
+} RwLock;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Event flag group
+------------------------------------------------------------------------------*/
+#ifdef USE_EVENT_GROUP
+// Event wait options (can be combined). By default, any of the flags waited 
+// for satisfies the wait and the flags are left set.
+#define EVENT_WAIT_ANY 0x00 		// Wait for any of the flags given
+#define EVENT_WAIT_ALL 0x01 		// Wait for all of the flags given
+#define EVENT_CLEAR_ON_EXIT 0x02 	// Clear the flags waited for once the wait is satisfied
+
+typedef struct EventGroup {
+	volatile uint32_t flags; 		// Current state of the 32 event flags
+	Task* waitingQueue; 			// Queue of tasks waiting for flags
+} EventGroup;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Direct-to-task notification
+------------------------------------------------------------------------------*/
+#ifdef USE_NOTIFY
+// Actions performed on the notification word of the task notified
+typedef enum {
+	NOTIFY_INCREMENT, 				// Increment the word (counting semaphore)
+	NOTIFY_SET_BITS, 				// OR the value given into the word (event flags)
+	NOTIFY_OVERWRITE, 				// Replace the word with the value given (mailbox)
+} NotifyAction;
+
+// Notification wait options. A wait taking a notification decrements the word,
+// unless it is cleared.
+#define NOTIFY_DECREMENT 0x00 		// Decrement the word (counting semaphore)
+#define NOTIFY_CLEAR 0x01 			// Clear the word (binary semaphore/flags/mailbox)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Condition variable
+------------------------------------------------------------------------------*/
+#ifdef USE_CONDVAR
+typedef struct CondVar {
+	Task* waitingQueue; 			// Queue of tasks waiting for a signal
+} CondVar;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Cyclic barrier
+------------------------------------------------------------------------------*/
+#ifdef USE_BARRIER
+// Barrier options. With BARRIER_LEADER_STEP the tasks are released only once
+// the leader (last task to arrive) has run its serial step and called 
+// KrisOS_barrier_release.
+#define BARRIER_NO_OPTIONS 0x00
+#define BARRIER_LEADER_STEP 0x01
+
+// Value returned by KrisOS_barrier_wait to the leader of the phase
+#define BARRIER_LEADER 3
+
+// Number of classes (2, 3-4, 5-8, 9+ tasks) the phase cost is reported for
+#define BARRIER_PHASE_CLASSES 4
+
+typedef struct Barrier {
+	uint32_t parties; 				// Number of tasks synchronised by the barrier
+	uint32_t arrived; 				// Number of tasks arrived in the current phase
+	uint8_t options; 				// Barrier options (BARRIER_LEADER_STEP)
+	Task* waitingQueue; 			// Queue of tasks waiting for the phase to end
+#ifdef SHOW_DIAGNOSTIC_DATA
+	uint32_t phaseCycles; 			// CPU cycles spent in the kernel in the current phase
+#endif
+} Barrier;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Software timer
+------------------------------------------------------------------------------*/
+#ifdef USE_SOFT_TIMER
+// Software timer modes
+#define TIMER_ONE_SHOT 0
+#define TIMER_AUTO_RELOAD 1
+
+// Function called when a timer expires (given the timer which has expired)
+typedef void (*TimerCallback)(SoftTimer* expired);
+
+typedef struct SoftTimer {
+	SoftTimer* next; 				// Next timer in the same timer wheel slot
+	SoftTimer* previous; 			// Previous timer in the same timer wheel slot
+	uint32_t expiry; 				// Time (in OS 'ticks') the timer expires at
+	uint32_t period; 				// Timer period (in OS 'ticks')
+	TimerCallback callback; 		// Function run by the timer service task on expiry
+	uint8_t mode; 					// TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+	uint8_t isActive; 				// 1 if the timer is running
+} SoftTimer;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* High-resolution timer event
+------------------------------------------------------------------------------*/
+#ifdef USE_HR_TIMER
+// Heap index of an event which isn't pending
+#define HR_TIMER_INACTIVE 0xFF
+
+// Function called inside the hardware timer interrupt handler when an event
+// expires (given the event which has expired)
+typedef void (*HrTimerCallback)(HrTimer* expired);
+
+typedef struct HrTimer {
+	uint32_t deadline; 				// Hardware timer count the event expires at
+	HrTimerCallback callback; 		// Function run by the timer interrupt on expiry
+	void* context; 					// User data passed to the callback with the event
+	uint8_t heapIndex; 				// Position in the deadline heap (HR_TIMER_INACTIVE)
+} HrTimer;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Work queue item
+------------------------------------------------------------------------------*/
+#ifdef USE_WORKQUEUE
+// Function run by a worker task (given the argument submitted with it)
+typedef void (*WorkFunction)(void* argument);
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Coroutine definition
+------------------------------------------------------------------------------*/
+#ifdef USE_COROUTINE
+// Values returned by the coroutine code (see KrisOS_co_begin)
+#define CO_WAITING 0 					// Coroutine suspended at an await
+#define CO_ENDED 1 						// Coroutine completed
+
+// Events a coroutine can wait for. A coroutine not started yet (zeroed) or 
+// completed is inactive.
+#define CO_INACTIVE 0 					// Not run by the executor
+#define CO_READY 1 						// Nothing (resumed at the next pass)
+#define CO_WAIT_POLL 2 					// Condition checked periodically
+#define CO_WAIT_DELAY 3 				// Delay given, not started yet
+#define CO_WAIT_TIME 4 					// Wake-up time
+#define CO_WAIT_NOTIFY 5 				// Notification
+#define CO_WAIT_RELEASE 6 				// Release of a semaphore (or queue)
+
+// Coroutine code. Resumed where it has last suspended by every call.
+typedef uint32_t (*CoroutineFunction)(Coroutine* self);
+
+typedef struct Coroutine {
+	uint16_t resumePoint; 			// Source line to resume at (0 - beginning)
+	uint8_t waitType; 				// Event waited for (CO_INACTIVE/CO_READY/CO_WAIT_...)
+	volatile uint8_t notified; 		// 1 if a notification is pending
+	CoroutineFunction function; 	// Coroutine code
+	void* context; 					// User data given at the start
+	uint32_t wakeTime; 				// Delay or wake-up time (in OS 'ticks')
+	Coroutine* next; 				// Next coroutine run by the executor
+} Coroutine;
+#endif
+
+
+/*-----------------------------------------------------------------------------
+* Cycle count statistics (measured using the DWT cycle counter)
+------------------------------------------------------------------------------*/
+#ifdef SHOW_DIAGNOSTIC_DATA
+typedef struct {
+	uint32_t last; 					// Last sample (in CPU cycles)
+	uint32_t max; 					// Maximum sample recorded
+	uint32_t total; 				// Sum of all samples recorded
+	uint32_t count; 				// Number of samples recorded
+} CycleStat;
 #endif
 
 
@@ -262,6 +823,74 @@ typedef struct __FILE {
 #define SVC_QUEUE_TRY_READ 32 		// Attempt to read from a queue
 #define SVC_QUEUE_ENQUEUE 33 		// Place an item on a queue
 #define SVC_QUEUE_DEQUEUE 34 	 	// Take an item off a queue
+#define SVC_QUEUE_INIT_TYPED 35 	// Initialise a typed queue
+#define SVC_MAILBOX_INIT 36 		// Initialise a mailbox
+#define SVC_MAILBOX_CREATE 37 		// Create a mailbox using heap
+#define SVC_MAILBOX_DELETE 38 		// Delete a mailbox
+#define SVC_MAILBOX_WRITE 39 		// Overwrite the item stored in a mailbox
+#define SVC_TOPIC_INIT 40 			// Initialise a topic
+#define SVC_TOPIC_SUBSCRIBE 41 		// Register a topic subscriber
+#define SVC_TOPIC_TAKE_BUFFER 42 	// Take a sample buffer from the topic pool
+#define SVC_TOPIC_DELIVER 43 		// Deliver a sample to the subscribers
+#define SVC_TOPIC_TAKE_SAMPLE 44 	// Take a sample off a subscriber's ring
+#define SVC_TOPIC_RELEASE 45 		// Release a sample received
+#define SVC_QUEUE_TRY_WRITE_FRONT 46 // Attempt to write to the front of a queue
+#define SVC_QUEUE_ENQUEUE_FRONT 47 	// Place an item at the front of a queue
+#define SVC_PQUEUE_INIT 48 			// Initialise a priority queue
+#define SVC_PQUEUE_CREATE 49 		// Create a priority queue
+#define SVC_PQUEUE_DELETE 50 		// Delete a priority queue
+#define SVC_PQUEUE_TRY_WRITE 51 	// Attempt to write to a priority queue
+#define SVC_PQUEUE_TRY_READ 52 		// Attempt to read from a priority queue
+#define SVC_PQUEUE_PUSH 53 			// Place a message on a priority queue
+#define SVC_PQUEUE_POP 54 			// Take the most urgent message off a priority queue
+#define SVC_SEM_ACQUIRE_TIMED 55 	// Acquire a semaphore, give up after a timeout
+#define SVC_MTX_LOCK_TIMED 56 		// Take a mutex, give up after a timeout
+#define SVC_SCHED_LOCK 57 			// Lock the scheduler (defer rescheduling)
+#define SVC_SCHED_UNLOCK 58 		// Unlock the scheduler
+#define SVC_MTX_INIT_CEILING 59 	// Initialise a priority ceiling mutex
+#define SVC_MTX_CREATE_CEILING 60 	// Create a priority ceiling mutex using heap
+#define SVC_RWLOCK_INIT 61 			// Initialise a reader-writer lock
+#define SVC_RWLOCK_CREATE 62 		// Create a reader-writer lock using heap
+#define SVC_RWLOCK_DELETE 63 		// Delete a reader-writer lock
+#define SVC_RWLOCK_READ_LOCK 64 	// Take a reader-writer lock for reading
+#define SVC_RWLOCK_READ_UNLOCK 65 	// Release a reader-writer lock held for reading
+#define SVC_RWLOCK_WRITE_LOCK 66 	// Take a reader-writer lock for writing
+#define SVC_RWLOCK_WRITE_UNLOCK 67 	// Release a reader-writer lock held for writing
+#define SVC_EVENT_GROUP_INIT 68 	// Initialise an event flag group
+#define SVC_EVENT_GROUP_CREATE 69 	// Create an event flag group using heap
+#define SVC_EVENT_GROUP_DELETE 70 	// Delete an event flag group
+#define SVC_EVENT_GROUP_SET 71 		// Set event flags
+#define SVC_EVENT_GROUP_WAIT 72 	// Wait for a combination of event flags
+#define SVC_NOTIFY 73 				// Notify a task
+#define SVC_NOTIFY_WAIT 74 			// Wait for a notification
+#define SVC_CONDVAR_INIT 75 		// Initialise a condition variable
+#define SVC_CONDVAR_CREATE 76 		// Create a condition variable using heap
+#define SVC_CONDVAR_DELETE 77 		// Delete a condition variable
+#define SVC_CONDVAR_WAIT 78 		// Release a mutex and wait for a signal
+#define SVC_CONDVAR_SIGNAL 79 		// Wake the top priority waiter
+#define SVC_CONDVAR_BROADCAST 80 	// Wake all the waiters
+#define SVC_BARRIER_INIT 81 		// Initialise a barrier
+#define SVC_BARRIER_CREATE 82 		// Create a barrier using heap
+#define SVC_BARRIER_DELETE 83 		// Delete a barrier
+#define SVC_BARRIER_WAIT 84 		// Arrive at a barrier and wait for the others
+#define SVC_BARRIER_RELEASE 85 		// Release the tasks after the leader's serial step
+#define SVC_TIMER_INIT 86 			// Initialise a software timer
+#define SVC_TIMER_CREATE 87 		// Create a software timer using heap
+#define SVC_TIMER_DELETE 88 		// Delete a software timer
+#define SVC_TIMER_START 89 			// Start a software timer
+#define SVC_TIMER_STOP 90 			// Stop a software timer
+#define SVC_TIMER_RESET 91 			// Restart a software timer from a full period
+#define SVC_HRTIMER_START 92 		// Start a high-resolution timer event
+#define SVC_HRTIMER_CANCEL 93 		// Cancel a high-resolution timer event
+#define SVC_HRTIMER_SLEEP 94 		// Suspend a task for a number of microseconds
+#define SVC_TASK_SLEEP_SLACK 95 	// Suspend a task with a wake-up slack
+#define SVC_WORK_SUBMIT 96 			// Submit a work item to a work queue
+#define SVC_BASIC_TASK_NEW 97 		// Create a basic task
+#define SVC_BASIC_TASK_ACTIVATE 98 	// Activate a basic task
+#define SVC_BASIC_TASK_TERMINATE 99 // Terminate the running basic task
+#define SVC_COROUTINE_START 100 	// Start a coroutine
+#define SVC_TASK_SET_SLACK 101 		// Set the wake-up slack of the running task
+#define SVC_COUNT 102 				// Number of SVC calls (size of the dispatch table)
 
 
 
@@ -423,6 +1052,37 @@ uint32_t __svc(SVC_TASK_SLEEP) KrisOS_task_sleep(uint32_t ticks);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_task_sleep_slack
+* Purpose:    	Suspend the execution of the running task for at least the number
+*				of OS 'ticks' given and at most 'slack' 'ticks' longer. Within that 
+*				window the task is woken together with other tasks, so that fewer
+*				wake-ups are needed.
+* Arguments: 	
+*		ticks - minimum number of OS 'ticks' to suspend execution of the task by
+*		slack - number of 'ticks' the wake-up can be delayed by (at most 
+*				TIMER_SLACK_MAX)
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TASK_SLEEP_SLACK) KrisOS_task_sleep_slack(uint32_t ticks, uint32_t slack);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_task_set_slack
+* Purpose:    	Set the wake-up slack used by the KrisOS_task_sleep calls of the
+*				running task (TIMER_SLACK_DEFAULT initially)
+* Arguments: 	
+*		slack - number of 'ticks' the wake-ups can be delayed by (at most 
+*				TIMER_SLACK_MAX)
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TASK_SET_SLACK) KrisOS_task_set_slack(uint32_t slack);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	KrisOS_task_yield
 * Purpose:    	Request a context switch to another task (cooperative scheduling)
@@ -445,6 +1105,32 @@ uint32_t __svc(SVC_TASK_DELETE) KrisOS_task_delete(void);
 
 
 
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sched_lock
+* Purpose:    	Lock the scheduler. The calling task won't be preempted by other
+*				tasks until the matching KrisOS_sched_unlock. Interrupts are still
+*				handled. Calls can be nested. The task must not block meanwhile.
+* Arguments:	-
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_SCHED_LOCK) KrisOS_sched_lock(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sched_unlock
+* Purpose:    	Unlock the scheduler. All the tasks woken up while it was locked
+*				are scheduled with a single decision at the outermost unlock.
+* Arguments:	-
+* Returns: 
+* 		exit status, EXIT_FAILURE if the scheduler isn't locked
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_SCHED_UNLOCK) KrisOS_sched_unlock(void);
+
+
+
 #ifdef USE_HEAP
 /*-------------------------------------------------------------------------------
 * Function:    	KrisOS_malloc
@@ -484,6 +1170,22 @@ uint32_t __svc(SVC_MTX_INIT) KrisOS_mutex_init(Mutex* toInit);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_init_ceiling
+* Purpose:    	Initialise the mutex given to use the immediate priority ceiling
+*				protocol. The owner runs at the ceiling priority until it unlocks
+*				the mutex, so no priority inheritance is necessary. Tasks with
+*				a base priority higher than the ceiling can't lock the mutex.
+* Arguments:	
+* 		toInit - mutex to initialise
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MTX_INIT_CEILING) KrisOS_mutex_init_ceiling(Mutex* toInit, uint8_t ceiling);
+
+
+
 #ifdef USE_HEAP
 /*-------------------------------------------------------------------------------
 * Function:    	KrisOS_mutex_create
@@ -496,6 +1198,18 @@ Mutex* __svc(SVC_MTX_CREATE) KrisOS_mutex_create(void);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_create_ceiling
+* Purpose:    	Create a priority ceiling mutex using dynamic memory allocation.
+* Arguments:	
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		Pointer to the mutex created
+--------------------------------------------------------------------------------*/
+Mutex* __svc(SVC_MTX_CREATE_CEILING) KrisOS_mutex_create_ceiling(uint8_t ceiling);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	KrisOS_mutex_delete
 * Purpose:    	Delete the mutex specified 
@@ -518,7 +1232,7 @@ uint32_t __svc(SVC_MTX_DELETE) KrisOS_mutex_delete(Mutex* toDelete);
 * Returns: 		
 *		exit status. EXIT_FAILURE if the mutex can't be locked immediately
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_MTX_TRY_LOCK) KrisOS_mutex_try_lock(Mutex* toLock);
+uint32_t KrisOS_mutex_try_lock(Mutex* toLock);
 
 
 
@@ -530,7 +1244,21 @@ uint32_t __svc(SVC_MTX_TRY_LOCK) KrisOS_mutex_try_lock(Mutex* toLock);
 * Returns: 		
 *		exit status
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_MTX_LOCK) KrisOS_mutex_lock(Mutex* toLock);
+uint32_t KrisOS_mutex_lock(Mutex* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_lock_timed
+* Purpose:    	Take the mutex given. Wait if the mutex is already taken, but for
+*				no longer than the timeout specified.
+* Arguments:	
+*		toLock - mutex to lock
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the mutex hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mutex_lock_timed(Mutex* toLock, uint32_t timeout);
 
 
 
@@ -542,7 +1270,7 @@ uint32_t __svc(SVC_MTX_LOCK) KrisOS_mutex_lock(Mutex* toLock);
 * Returns: 		
 *		exit status, EXIT_FAILURE if the calling task doesn't own the mutex specified 
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_MTX_UNLOCK) KrisOS_mutex_unlock(Mutex* toUnlock);
+uint32_t KrisOS_mutex_unlock(Mutex* toUnlock);
 #endif
 
 
@@ -595,7 +1323,7 @@ uint32_t __svc(SVC_SEM_DELETE) KrisOS_sem_delete(Semaphore* toDelete);
 * Returns: 		
 *		exit status. EXIT_FAILURE if semaphore can't be taken
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_SEM_TRY_ACQUIRE) KrisOS_sem_try_acquire(Semaphore* toAcquire);
+uint32_t KrisOS_sem_try_acquire(Semaphore* toAcquire);
 
 
 
@@ -606,7 +1334,21 @@ uint32_t __svc(SVC_SEM_TRY_ACQUIRE) KrisOS_sem_try_acquire(Semaphore* toAcquire)
 * 		toAcquire - semaphore to acquire
 * Returns: -
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_SEM_ACQUIRE) KrisOS_sem_acquire(Semaphore* toAcquire);
+uint32_t KrisOS_sem_acquire(Semaphore* toAcquire);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_acquire_timed
+* Purpose:    	Decrement the semaphore. Wait if unsuccessful, but for no longer
+*				than the timeout specified.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the semaphore hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_sem_acquire_timed(Semaphore* toAcquire, uint32_t timeout);
 
 
 
@@ -619,7 +1361,7 @@ uint32_t __svc(SVC_SEM_ACQUIRE) KrisOS_sem_acquire(Semaphore* toAcquire);
 * Returns: 		
 *		exit status
 --------------------------------------------------------------------------------*/
-uint32_t __svc(SVC_SEM_RELEASE) KrisOS_sem_release(Semaphore* toRelease);
+uint32_t KrisOS_sem_release(Semaphore* toRelease);
 
 
 
@@ -663,6 +1405,24 @@ uint32_t KrisOS_sem_acquire_ISR(Semaphore* toAcquire);
 --------------------------------------------------------------------------------*/
 uint32_t __svc(SVC_QUEUE_INIT) KrisOS_queue_init(Queue* toInit, void* bufferMemory, 
 												  size_t capacity, size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_init_typed
+* Purpose:    	Initialise the queue given to use the type-specific copy routines
+*				instead of the generic memcpy-based ones. Use the 
+*				KrisOS_queue_typed_template macro to generate 'ops'.
+* Arguments:	
+* 		toInit - queue to initialise
+*		bufferMemory - pointer to the memory area to be used as data buffer
+*		capacity - buffer memory size (in number of items it can fit)
+*		ops - typed copy routines (defines the item size too)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_QUEUE_INIT_TYPED) KrisOS_queue_init_typed(Queue* toInit, void* bufferMemory, 
+															 size_t capacity, const QueueOps* ops);
 					
 		
 
@@ -751,58 +1511,1411 @@ uint32_t KrisOS_queue_read(Queue* toRead, void* item);
 
 
 /*-------------------------------------------------------------------------------
-* Function:    	KrisOS_queue_write_ISR
-* Purpose:    	Put the item given in the queue specified while inside ISR (don't wait)
+* Function:    	KrisOS_queue_write_timed
+* Purpose:    	Put the item given in the queue specified. Wait if the queue
+*				is full, but for no longer than the timeout specified.
 * Arguments:	
 * 		toWrite - queue to write to
 *		item - pointer to the item to be put in the queue
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
 * Returns: 		
-*		exit status
+*		exit status, EXIT_TIMEOUT if no space has been freed on time
 --------------------------------------------------------------------------------*/
-uint32_t KrisOS_queue_write_ISR(Queue* toWrite, const void* item);
+uint32_t KrisOS_queue_write_timed(Queue* toWrite, const void* item, uint32_t timeout);
 
 
 
 /*-------------------------------------------------------------------------------
-* Function:    	KrisOS_queue_read_ISR
-* Purpose:    	Read the next item from the queue specified while inside ISR (don't wait)
+* Function:    	KrisOS_queue_read_timed
+* Purpose:    	Read the next item from the queue specified. Wait if the queue
+*				is empty, but for no longer than the timeout specified.
 * Arguments:	
 * 		toRead - queue to read from
 *		item - item read from the queue
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
 * Returns: 		
-*		exit status
+*		exit status, EXIT_TIMEOUT if no item has arrived on time
 --------------------------------------------------------------------------------*/
-uint32_t KrisOS_queue_read_ISR(Queue* toRead, void* item);
-					
-#endif
+uint32_t KrisOS_queue_read_timed(Queue* toRead, void* item, uint32_t timeout);
 
 
 
-#ifdef SHOW_DIAGNOSTIC_DATA
 /*-------------------------------------------------------------------------------
-* Function:    	KrisOS_task_stack_usage
-* Purpose:    	Pre-set the task's private stack memory area to some known value
-*				in order to estimate the stack usage later
+* Function:    	KrisOS_queue_try_write_front
+* Purpose:    	Put the item given at the front of the queue specified, so that it
+*				is read next. Don't wait if the queue is full.
 * Arguments:	
-*		toPrepare - pointer to the top of the task's stack memory to initialise
-* 		size - size of stack memory
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
 * Returns: 		
-*		exit status
+*		exit status, EXIT_FAILURE for a typed queue
 --------------------------------------------------------------------------------*/
-uint32_t KrisOS_task_stack_usage(uint32_t* toPrepare, uint32_t size);
-#endif
+uint32_t __svc(SVC_QUEUE_TRY_WRITE_FRONT) KrisOS_queue_try_write_front(Queue* toWrite, 
+																	   const void* item);
 
 
 
 /*-------------------------------------------------------------------------------
-* Macro:    	KrisOS_task_static_template
-* Purpose:    	MACRO speeding up the static task declaration by automatically declaring 
-*				and initialising variables and constants to be passed to 
-*				KrisOS_task_create_static.
+* Function:    	KrisOS_queue_write_front
+* Purpose:    	Put the item given at the front of the queue specified, so that it
+*				is read next. Wait if the queue is full.
 * Arguments:	
-*		NAME - unique name of the task and prefix to the task description variable names.
-*			   1. task function name - void <NAME>(void)
-*			   2. task struct - Task <NAME>Task
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status, EXIT_FAILURE for a typed queue
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_front(Queue* toWrite, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_write_ISR
+* Purpose:    	Put the item given in the queue specified while inside ISR (don't wait)
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_ISR(Queue* toWrite, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_read_ISR
+* Purpose:    	Read the next item from the queue specified while inside ISR (don't wait)
+* Arguments:	
+* 		toRead - queue to read from
+*		item - item read from the queue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_read_ISR(Queue* toRead, void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_write_front_ISR
+* Purpose:    	Put the item given at the front of the queue specified while inside
+*				ISR (don't wait)
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status, EXIT_FAILURE for a typed queue
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_front_ISR(Queue* toWrite, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_fill_level
+* Purpose:    	Get the number of items waiting in the queue given. A single word
+*				is read, so no SVC call is made and the value can't be torn.
+* Arguments:	
+* 		queue - queue to check
+* Returns: 		
+*		number of items in the queue (not counting the ones being read)
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_fill_level(const Queue* queue);
+					
+#endif
+
+
+
+#ifdef USE_PQUEUE
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_init
+* Purpose:    	Initialise the priority queue given
+* Arguments:	
+* 		toInit - priority queue to initialise
+*		memory - memory area of PQUEUE_MEMORY_SIZE(capacity, itemSize) bytes
+*				 for the heap and the message slots (word-aligned)
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_INIT) KrisOS_pqueue_init(PriorityQueue* toInit, void* memory, 
+												   size_t capacity, size_t itemSize);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_create
+* Purpose:    	Create and initialise a priority queue using dynamic memory
+* Arguments:	
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		pointer to the priority queue created
+--------------------------------------------------------------------------------*/
+PriorityQueue* __svc(SVC_PQUEUE_CREATE) KrisOS_pqueue_create(size_t capacity, size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_delete
+* Purpose:    	Remove the priority queue given
+* Arguments:	
+* 		toDelete - priority queue to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_DELETE) KrisOS_pqueue_delete(PriorityQueue* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_try_write
+* Purpose:    	Put the message given in the priority queue. Don't wait if the 
+*				queue is full.
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_TRY_WRITE) KrisOS_pqueue_try_write(PriorityQueue* toWrite, 
+															 const void* item, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_try_read
+* Purpose:    	Read the most urgent message from the priority queue. Don't wait 
+*				if the queue is empty.
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_TRY_READ) KrisOS_pqueue_try_read(PriorityQueue* toRead, void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_write
+* Purpose:    	Put the message given in the priority queue. Wait if the queue
+*				is full.
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_write(PriorityQueue* toWrite, const void* item, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_read
+* Purpose:    	Read the most urgent message from the priority queue. Wait if the
+*				queue is empty.
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_read(PriorityQueue* toRead, void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_write_ISR
+* Purpose:    	Put the message given in the priority queue while inside ISR 
+*				(don't wait)
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_write_ISR(PriorityQueue* toWrite, const void* item, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_read_ISR
+* Purpose:    	Read the most urgent message from the priority queue while inside
+*				ISR (don't wait)
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_read_ISR(PriorityQueue* toRead, void* item);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_init
+* Purpose:    	Initialise the sequence lock given
+* Arguments:	
+* 		toInit - sequence lock to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_init(SeqLock* toInit);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_write_begin
+* Purpose:    	Mark the start of an update of the data protected by the lock. 
+*				Writers must not interleave, so it has to be called inside a
+*				critical section or by the only writer of the data.
+* Arguments:	
+* 		lock - sequence lock to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_seqlock_write_begin(SeqLock* lock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_write_end
+* Purpose:    	Mark the end of an update of the data protected by the lock. 
+*				Has to be called by the writer which called
+*				KrisOS_seqlock_write_begin (inside the same critical section).
+* Arguments:	
+* 		lock - sequence lock to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_seqlock_write_end(SeqLock* lock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_read_begin
+* Purpose:    	Start reading the data protected by the lock given
+* Arguments:	
+* 		lock - sequence lock to read
+* Returns: 		
+*		sequence number to pass to KrisOS_seqlock_read_retry
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_read_begin(const SeqLock* lock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_read_retry
+* Purpose:    	Check if the data read since KrisOS_seqlock_read_begin might have
+*				been modified by a writer in the meantime.
+* Arguments:	
+* 		lock - sequence lock to check
+*		sequence - value returned by KrisOS_seqlock_read_begin
+* Returns: 		
+*		1 if the read has to be repeated, 0 if the data read is consistent
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_read_retry(const SeqLock* lock, uint32_t sequence);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_kernel_info
+* Purpose:    	Take a consistent snapshot of the kernel information page (time,
+*				running task and counters). No SVC call is made and interrupts 
+*				aren't masked, so it can be called from any task and from the 
+*				interrupts allowed to call the kernel.
+* Arguments:	
+* 		snapshot - where to copy the kernel information to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_kernel_info(KernelInfo* snapshot);
+
+
+
+#ifdef USE_MAILBOX
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_init
+* Purpose:    	Initialise the mailbox given
+* Arguments:	
+* 		toInit - mailbox to initialise
+*		bufferMemory - memory area to store the item in
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MAILBOX_INIT) KrisOS_mailbox_init(Mailbox* toInit, void* bufferMemory, 
+													 size_t itemSize);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_create
+* Purpose:    	Create and initialise a mailbox using dynamic memory allocation
+* Arguments:	
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		pointer to the mailbox created
+--------------------------------------------------------------------------------*/
+Mailbox* __svc(SVC_MAILBOX_CREATE) KrisOS_mailbox_create(size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_delete
+* Purpose:    	Delete the mailbox given
+* Arguments:	
+* 		toDelete - mailbox to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MAILBOX_DELETE) KrisOS_mailbox_delete(Mailbox* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_write
+* Purpose:    	Overwrite the item stored in the mailbox. Never blocks.
+* Arguments:	
+* 		toWrite - mailbox to write to
+*		item - pointer to the new value
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MAILBOX_WRITE) KrisOS_mailbox_write(Mailbox* toWrite, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_write_ISR
+* Purpose:    	Overwrite the item stored in the mailbox from inside an interrupt
+*				service routine
+* Arguments:	
+* 		toWrite - mailbox to write to
+*		item - pointer to the new value
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mailbox_write_ISR(Mailbox* toWrite, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_read
+* Purpose:    	Copy the most recent item from the mailbox. Doesn't block, doesn't
+*				enter the kernel and doesn't mask interrupts.
+* Arguments:	
+* 		toRead - mailbox to read from
+*		item - where to copy the item to
+* Returns: 		
+*		exit status. EXIT_FAILURE if nothing has been written to the mailbox yet
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mailbox_read(Mailbox* toRead, void* item);
+#endif
+
+
+
+#ifdef USE_TOPIC
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_init
+* Purpose:    	Initialise the topic given. Use KrisOS_topic_template to allocate
+*				the pool memory.
+* Arguments:	
+* 		toInit - topic to initialise
+*		poolMemory - memory area for the sample buffers (8-byte aligned,
+*					 bufferNo * TOPIC_SLOT_SIZE(itemSize) bytes long)
+*		bufferNo - number of sample buffers in the pool
+*		itemSize - size of a single sample
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TOPIC_INIT) KrisOS_topic_init(Topic* toInit, void* poolMemory, 
+												 size_t bufferNo, size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_subscribe
+* Purpose:    	Register a subscriber to the topic given. Subscribe before the 
+*				samples start being published.
+* Arguments:	
+* 		topic - topic to subscribe to
+*		subscriber - subscriber to initialise and register
+*		policy - what to do when the subscriber's ring is full
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TOPIC_SUBSCRIBE) KrisOS_topic_subscribe(Topic* topic, TopicSubscriber* subscriber,
+														   TopicPolicy policy);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_loan
+* Purpose:    	Get an empty sample buffer from the topic's pool. Wait if the 
+*				pool is empty.
+* Arguments:	
+* 		topic - topic to publish on later
+* Returns: 		
+*		pointer to the sample memory to fill in
+--------------------------------------------------------------------------------*/
+void* KrisOS_topic_loan(Topic* topic);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_publish
+* Purpose:    	Deliver the sample to all subscribers of the topic. Wait for the 
+*				TOPIC_BLOCK subscribers which have no room left.
+* Arguments:	
+* 		topic - topic to publish on
+*		sample - sample buffer obtained from KrisOS_topic_loan
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_topic_publish(Topic* topic, void* sample);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_receive
+* Purpose:    	Get the oldest unread sample. Wait if there are none.
+* Arguments:	
+* 		subscriber - subscriber reading the topic
+* Returns: 		
+*		pointer to the sample, release it with KrisOS_topic_release when done
+--------------------------------------------------------------------------------*/
+const void* KrisOS_topic_receive(TopicSubscriber* subscriber);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_release
+* Purpose:    	Release the sample received. The sample buffer returns to the 
+*				pool once all subscribers have released it.
+* Arguments:	
+* 		topic - topic the sample was published on
+*		sample - sample to release
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TOPIC_RELEASE) KrisOS_topic_release(Topic* topic, const void* sample);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_lag
+* Purpose:    	Get the number of samples published but not yet received by 
+*				the subscriber given
+* Arguments:	
+* 		subscriber - subscriber to check
+* Returns: 		
+*		number of samples waiting
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_topic_lag(const TopicSubscriber* subscriber);
+#endif
+
+
+
+#ifdef USE_RWLOCK
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_init
+* Purpose:    	Initialise the reader-writer lock given
+* Arguments:	
+* 		toInit - reader-writer lock to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_INIT) KrisOS_rwlock_init(RwLock* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_create
+* Purpose:    	Create a reader-writer lock using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the reader-writer lock created
+--------------------------------------------------------------------------------*/
+RwLock* __svc(SVC_RWLOCK_CREATE) KrisOS_rwlock_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_delete
+* Purpose:    	Delete the reader-writer lock given
+* Arguments:	
+* 		toDelete - reader-writer lock to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock is held or waited on
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_DELETE) KrisOS_rwlock_delete(RwLock* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_lock
+* Purpose:    	Take the lock for reading. Many readers can hold the lock at the
+*				same time. Wait if a writer holds the lock or is waiting for it.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_read_lock(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_unlock
+* Purpose:    	Release the lock held for reading
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock isn't held for reading
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_read_unlock(RwLock* toUnlock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_lock
+* Purpose:    	Take the lock for writing (exclusive access). Wait if the lock 
+*				is held by readers or another writer.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_write_lock(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_unlock
+* Purpose:    	Release the lock held for writing
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task isn't the writer
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_write_unlock(RwLock* toUnlock);
+#endif
+
+
+
+#ifdef USE_EVENT_GROUP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_init
+* Purpose:    	Initialise the event flag group given, with all flags cleared
+* Arguments:	
+* 		toInit - event group to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_EVENT_GROUP_INIT) KrisOS_event_group_init(EventGroup* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_create
+* Purpose:    	Create an event flag group using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the event group created
+--------------------------------------------------------------------------------*/
+EventGroup* __svc(SVC_EVENT_GROUP_CREATE) KrisOS_event_group_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_delete
+* Purpose:    	Delete the event flag group given
+* Arguments:	
+* 		toDelete - event group to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the group
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_EVENT_GROUP_DELETE) KrisOS_event_group_delete(EventGroup* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_set
+* Purpose:    	Set the flags given and wake all the tasks whose wait is now 
+*				satisfied
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to set
+* Returns: 		
+*		state of the flags after the tasks woken have cleared theirs
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_EVENT_GROUP_SET) KrisOS_event_group_set(EventGroup* group, uint32_t flags);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_set_ISR
+* Purpose:    	Set the flags given inside an interrupt service routine
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to set
+* Returns: 		
+*		state of the flags after the tasks woken have cleared theirs
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_set_ISR(EventGroup* group, uint32_t flags);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_clear
+* Purpose:    	Clear the flags given. Never blocks, doesn't enter the kernel.
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to clear
+* Returns: 		
+*		state of the flags before they have been cleared
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_clear(EventGroup* group, uint32_t flags);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_get
+* Purpose:    	Get the current state of the flags
+* Arguments:	
+* 		group - event group to read
+* Returns: 		
+*		state of the flags
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_get(const EventGroup* group);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_wait
+* Purpose:    	Wait until any or all (EVENT_WAIT_ALL) of the flags given are set
+* Arguments:	
+* 		group - event group to wait on
+*		flags - flags to wait for
+*		options - EVENT_WAIT_ANY/EVENT_WAIT_ALL, optionally with EVENT_CLEAR_ON_EXIT
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		state of the flags which satisfied the wait (before clearing), 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_wait(EventGroup* group, uint32_t flags, uint8_t options,
+								 uint32_t timeout);
+#endif
+
+
+
+#ifdef USE_NOTIFY
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify
+* Purpose:    	Update the notification word of the task given and wake it up if
+*				it is waiting for a notification
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify(Task* toNotify, uint32_t value, NotifyAction action);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_ISR
+* Purpose:    	Notify the task given inside an interrupt service routine
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify_ISR(Task* toNotify, uint32_t value, NotifyAction action);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_wait
+* Purpose:    	Wait until the notification word of the calling task is non-zero
+*				and take the notification
+* Arguments:	
+*		options - NOTIFY_DECREMENT/NOTIFY_CLEAR
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		notification word before it has been taken, 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify_wait(uint8_t options, uint32_t timeout);
+#endif
+
+
+
+#ifdef USE_CONDVAR
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_init
+* Purpose:    	Initialise the condition variable given
+* Arguments:	
+* 		toInit - condition variable to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_CONDVAR_INIT) KrisOS_condvar_init(CondVar* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_create
+* Purpose:    	Create a condition variable using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the condition variable created
+--------------------------------------------------------------------------------*/
+CondVar* __svc(SVC_CONDVAR_CREATE) KrisOS_condvar_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_delete
+* Purpose:    	Delete the condition variable given
+* Arguments:	
+* 		toDelete - condition variable to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the condition variable
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_CONDVAR_DELETE) KrisOS_condvar_delete(CondVar* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_wait
+* Purpose:    	Release the mutex given and wait for a signal, atomically. The 
+*				mutex is locked again before the call returns. The predicate 
+*				waited for should be checked again in a loop.
+* Arguments:	
+* 		cond - condition variable to wait on
+*		mtx - mutex held by the calling task, protecting the predicate
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task doesn't own the mutex
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_CONDVAR_WAIT) KrisOS_condvar_wait(CondVar* cond, Mutex* mtx);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_signal
+* Purpose:    	Wake the top priority task waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_condvar_signal(CondVar* cond);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_broadcast
+* Purpose:    	Wake all the tasks waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_condvar_broadcast(CondVar* cond);
+#endif
+
+
+
+#ifdef USE_BARRIER
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_barrier_init
+* Purpose:    	Initialise the barrier given
+* Arguments:	
+* 		toInit - barrier to initialise
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BARRIER_INIT) KrisOS_barrier_init(Barrier* toInit, uint32_t parties, 
+													 uint8_t options);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_barrier_create
+* Purpose:    	Create a barrier using dynamic memory allocation
+* Arguments:	
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		pointer to the barrier created
+--------------------------------------------------------------------------------*/
+Barrier* __svc(SVC_BARRIER_CREATE) KrisOS_barrier_create(uint32_t parties, uint8_t options);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_barrier_delete
+* Purpose:    	Delete the barrier given
+* Arguments:	
+* 		toDelete - barrier to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting at the barrier
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BARRIER_DELETE) KrisOS_barrier_delete(Barrier* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_barrier_wait
+* Purpose:    	Arrive at the barrier and wait until all the tasks have arrived.
+*				The last task to arrive is the leader of the phase and doesn't wait.
+* Arguments:	
+* 		toWait - barrier to wait at
+* Returns: 		
+*		BARRIER_LEADER to the leader, EXIT_SUCCESS to the other tasks
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BARRIER_WAIT) KrisOS_barrier_wait(Barrier* toWait);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_barrier_release
+* Purpose:    	Release the tasks waiting at a BARRIER_LEADER_STEP barrier, once 
+*				the leader has finished its serial step
+* Arguments:	
+* 		toRelease - barrier to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if not all the tasks have arrived
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BARRIER_RELEASE) KrisOS_barrier_release(Barrier* toRelease);
+#endif
+
+
+
+#ifdef USE_SOFT_TIMER
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_init
+* Purpose:    	Initialise the software timer given. The timer is stopped.
+* Arguments:	
+* 		toInit - timer to initialise
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TIMER_INIT) KrisOS_timer_init(SoftTimer* toInit, TimerCallback callback,
+												 uint32_t period, uint8_t mode);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_create
+* Purpose:    	Create a software timer using dynamic memory allocation
+* Arguments:	
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		pointer to the timer created
+--------------------------------------------------------------------------------*/
+SoftTimer* __svc(SVC_TIMER_CREATE) KrisOS_timer_create(TimerCallback callback, 
+													   uint32_t period, uint8_t mode);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_delete
+* Purpose:    	Stop the software timer given and delete it
+* Arguments:	
+* 		toDelete - timer to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TIMER_DELETE) KrisOS_timer_delete(SoftTimer* toDelete);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_start
+* Purpose:    	Start the software timer given, so that it expires after its 
+*				period. A timer which is already running isn't affected.
+* Arguments:	
+* 		toStart - timer to start
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TIMER_START) KrisOS_timer_start(SoftTimer* toStart);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_stop
+* Purpose:    	Stop the software timer given
+* Arguments:	
+* 		toStop - timer to stop
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TIMER_STOP) KrisOS_timer_stop(SoftTimer* toStop);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_timer_reset
+* Purpose:    	Restart the software timer given, so that it expires a full period
+*				from now. A stopped timer is started.
+* Arguments:	
+* 		toReset - timer to restart
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TIMER_RESET) KrisOS_timer_reset(SoftTimer* toReset);
+#endif
+
+
+
+#ifdef USE_HR_TIMER
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_start
+* Purpose:    	Start the high-resolution timer event given, so that its callback
+*				is run by the hardware timer interrupt handler after the delay given.
+*				The callback can use the KrisOS *_ISR functions. A pending event is
+*				restarted.
+* Arguments:	
+* 		toStart - event to start
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+*		callback - function run when the event expires
+*		context - user data stored in the event
+* Returns: 		
+*		exit status, EXIT_FAILURE if the delay is too long or there are already
+*		HR_TIMER_CAPACITY events pending
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_HRTIMER_START) KrisOS_hrtimer_start(HrTimer* toStart, uint32_t delayUs,
+													   HrTimerCallback callback, 
+													   void* context);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_start_ISR
+* Purpose:    	Start the high-resolution timer event given inside an interrupt 
+*				service routine
+* Arguments:	
+* 		toStart - event to start
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+*		callback - function run when the event expires
+*		context - user data stored in the event
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_hrtimer_start_ISR(HrTimer* toStart, uint32_t delayUs, 
+								  HrTimerCallback callback, void* context);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_cancel
+* Purpose:    	Cancel the high-resolution timer event given (if it is pending)
+* Arguments:	
+* 		toCancel - event to cancel
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_HRTIMER_CANCEL) KrisOS_hrtimer_cancel(HrTimer* toCancel);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_cancel_ISR
+* Purpose:    	Cancel the high-resolution timer event given inside an interrupt
+*				service routine
+* Arguments:	
+* 		toCancel - event to cancel
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_hrtimer_cancel_ISR(HrTimer* toCancel);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_task_sleep_us
+* Purpose:    	Suspend the execution of the calling task for the number of 
+*				microseconds given. Sleeps shorter than HR_SLEEP_SPIN_US are spun.
+* Arguments:	
+* 		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_task_sleep_us(uint32_t delayUs);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_udelay
+* Purpose:    	Busy-wait for the number of microseconds given. Can be used by
+*				tasks and interrupt handlers. The delay is a lower bound (the 
+*				caller can be preempted).
+* Arguments:	
+* 		delayUs - delay in microseconds
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_udelay(uint32_t delayUs);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_ndelay
+* Purpose:    	Busy-wait for the number of nanoseconds given (rounded up to the 
+*				length of one spin loop iteration)
+* Arguments:	
+* 		delayNs - delay in nanoseconds
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_ndelay(uint32_t delayNs);
+#endif
+
+
+
+#ifdef USE_WORKQUEUE
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_work_submit
+* Purpose:    	Submit a work item to the work queue given. The function is run 
+*				by the worker task of the queue.
+* Arguments:	
+* 		queue - work queue number (0 to WORKQUEUE_NO - 1)
+*		function - function to run
+*		argument - argument to run the function with
+* Returns: 		
+*		exit status, EXIT_FAILURE if the queue is full
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_WORK_SUBMIT) KrisOS_work_submit(uint32_t queue, WorkFunction function,
+												   void* argument);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_work_submit_ISR
+* Purpose:    	Submit a work item to the work queue given inside an interrupt 
+*				service routine. The item is queued without any lock, so the work
+*				deferred costs the interrupt handler little more than a 
+*				notification of the worker task.
+* Arguments:	
+* 		queue - work queue number (0 to WORKQUEUE_NO - 1)
+*		function - function to run
+*		argument - argument to run the function with
+* Returns: 		
+*		exit status, EXIT_FAILURE if the queue is full
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_work_submit_ISR(uint32_t queue, WorkFunction function, void* argument);
+#endif
+
+
+
+#ifdef USE_BASIC_TASK
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_basic_task_create
+* Purpose:    	Create a basic task. A basic task has no private stack. Each of 
+*				its activations runs the code given to completion on the stack
+*				shared by all the basic tasks, so the code must not block (sleep,
+*				wait on objects or lock mutexes). The task is created suspended
+*				(dormant).
+* Arguments:	
+* 		toCreate - pointer to the task control block of the task to create
+*		startAddr - pointer to the task code (function)
+*		priority - task priority. The higher the number the lower the priority.
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BASIC_TASK_NEW) KrisOS_basic_task_create(Task* toCreate, void* startAddr,
+															uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_basic_task_activate
+* Purpose:    	Activate the basic task given. A dormant task is made ready, the
+*				activations of an active one are queued (up to 
+*				BASIC_ACTIVATIONS_MAX), so that it is run again once completed.
+* Arguments:	
+* 		toActivate - basic task to activate
+* Returns: 		
+*		exit status, EXIT_FAILURE if no more activations can be queued
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BASIC_TASK_ACTIVATE) KrisOS_basic_task_activate(Task* toActivate);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_basic_task_activate_ISR
+* Purpose:    	Activate the basic task given inside an interrupt service routine
+* Arguments:	
+* 		toActivate - basic task to activate
+* Returns: 		
+*		exit status, EXIT_FAILURE if no more activations can be queued
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_basic_task_activate_ISR(Task* toActivate);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_basic_task_terminate
+* Purpose:    	Terminate the running basic task (the same as returning from its 
+*				code). The task is run again if it has activations queued.
+* Arguments:	-
+* Returns: 		
+*		doesn't return to the calling basic task, EXIT_FAILURE if called by
+*		an extended task
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_BASIC_TASK_TERMINATE) KrisOS_basic_task_terminate(void);
+#endif
+
+
+
+#ifdef USE_COROUTINE
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_coroutine_start
+* Purpose:    	Start a coroutine. The coroutine is run by the coroutine executor
+*				task, until its code reaches KrisOS_co_end. The coroutine has to
+*				be zeroed (e.g. static) before it is started for the first time.
+* Arguments:	
+* 		toStart - coroutine to start
+*		function - coroutine code
+*		context - user data, available to the code as self->context
+* Returns: 		
+*		exit status, EXIT_FAILURE if the coroutine is still running
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_COROUTINE_START) KrisOS_coroutine_start(Coroutine* toStart, 
+														   CoroutineFunction function,
+														   void* context);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_coroutine_notify
+* Purpose:    	Notify the coroutine given, resuming it if it awaits a 
+*				notification (KrisOS_co_await_notify). Notifications aren't 
+*				counted, one is kept pending until awaited.
+* Arguments:	
+* 		toNotify - coroutine to notify
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_coroutine_notify(Coroutine* toNotify);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_coroutine_notify_ISR
+* Purpose:    	Notify the coroutine given inside an interrupt service routine
+* Arguments:	
+* 		toNotify - coroutine to notify
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_coroutine_notify_ISR(Coroutine* toNotify);
+
+
+
+/*-------------------------------------------------------------------------------
+* Macros:    	KrisOS_co_begin, KrisOS_co_end
+* Purpose:    	Enclose the code of a coroutine (a CoroutineFunction). The 
+*				coroutine is a switch statement over the source lines it has
+*				suspended at, so it has no stack of its own: 
+*			   1. Local variables aren't kept while the coroutine is suspended.
+*				  Keep the state in the context (or in static variables).
+*			   2. The awaits can't be placed inside other switch statements or 
+*				  in functions called by the coroutine.
+*			   3. The code mustn't block the executor task (use the awaits 
+*				  instead of the blocking KrisOS calls).
+* Arguments:	
+*		self - the coroutine (the argument of the CoroutineFunction)
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_begin(self) 							\
+	switch ((self)->resumePoint) { 						\
+		case 0:
+
+#define KrisOS_co_end(self) 							\
+	} 													\
+	(self)->resumePoint = 0; 							\
+	return CO_ENDED;
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_co_yield
+* Purpose:    	Suspend the coroutine, letting the other coroutines run. It is
+*				resumed at the next pass of the executor.
+* Arguments:	
+*		self - the coroutine
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_yield(self) 							\
+	do { 												\
+		(self)->resumePoint = __LINE__; 				\
+		(self)->waitType = CO_READY; 					\
+		return CO_WAITING; 								\
+		case __LINE__:; 								\
+	} while (0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_co_await
+* Purpose:    	Suspend the coroutine until the condition given is true. The 
+*				condition is polled every COROUTINE_POLL_PERIOD OS 'ticks' (use
+*				KrisOS_co_await_release for the conditions on kernel objects).
+* Arguments:	
+*		self - the coroutine
+*		condition - expression to wait for (evaluated again at each check)
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_await(self, condition) 				\
+	do { 												\
+		(self)->resumePoint = __LINE__; 				\
+		case __LINE__: 									\
+		if (!(condition)) { 							\
+			(self)->waitType = CO_WAIT_POLL; 			\
+			return CO_WAITING; 							\
+		} 												\
+	} while (0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_co_await_release
+* Purpose:    	Suspend the coroutine until the condition given is true. The 
+*				condition is checked again whenever the semaphore given is 
+*				released, as the coroutine is registered with it while waiting.
+* Arguments:	
+*		self - the coroutine
+*		sem - semaphore the condition depends on (evaluated more than once)
+*		condition - expression to wait for (evaluated again at each release)
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_await_release(self, sem, condition) 	\
+	do { 												\
+		(self)->resumePoint = __LINE__; 				\
+		(sem)->coroutineWaiters++; 						\
+		case __LINE__: 									\
+		if (!(condition)) { 							\
+			(self)->waitType = CO_WAIT_RELEASE; 		\
+			return CO_WAITING; 							\
+		} 												\
+		(sem)->coroutineWaiters--; 						\
+	} while (0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Macros:    	KrisOS_co_await_sem, KrisOS_co_await_queue_read, 
+*				KrisOS_co_await_queue_write
+* Purpose:    	Suspend the coroutine until the semaphore given is acquired, an
+*				item is read from the queue given or written to it. The coroutine
+*				is resumed when the semaphore is released, or when an item is 
+*				written to the queue (read from it), not polled.
+* Arguments:	
+*		self - the coroutine
+*		sem - semaphore to acquire
+*		queue - queue to read/write
+*		item - item buffer (mustn't be a local variable of the coroutine)
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_await_sem(self, sem) 					\
+	KrisOS_co_await_release(self, sem, KrisOS_sem_try_acquire(sem) == EXIT_SUCCESS)
+
+#define KrisOS_co_await_queue_read(self, queue, item) 	\
+	KrisOS_co_await_release(self, &(queue)->elementsStored, 	\
+							KrisOS_queue_try_read(queue, item) == EXIT_SUCCESS)
+
+#define KrisOS_co_await_queue_write(self, queue, item) 	\
+	KrisOS_co_await_release(self, &(queue)->remainingCapacity, \
+							KrisOS_queue_try_write(queue, item) == EXIT_SUCCESS)
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_co_sleep
+* Purpose:    	Suspend the coroutine for the number of OS 'ticks' given. The 
+*				executor task sleeps until the earliest wake-up time.
+* Arguments:	
+*		self - the coroutine
+*		delay - number of OS 'ticks' to suspend the coroutine by
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_sleep(self, delay) 					\
+	do { 												\
+		(self)->resumePoint = __LINE__; 				\
+		(self)->wakeTime = (delay); 					\
+		(self)->waitType = CO_WAIT_DELAY; 				\
+		return CO_WAITING; 								\
+		case __LINE__:; 								\
+	} while (0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_co_await_notify
+* Purpose:    	Suspend the coroutine until it is notified (see 
+*				KrisOS_coroutine_notify) and take the notification
+* Arguments:	
+*		self - the coroutine
+--------------------------------------------------------------------------------*/
+#define KrisOS_co_await_notify(self) 					\
+	do { 												\
+		(self)->resumePoint = __LINE__; 				\
+		case __LINE__: 									\
+		if (!(self)->notified) { 						\
+			(self)->waitType = CO_WAIT_NOTIFY; 			\
+			return CO_WAITING; 							\
+		} 												\
+		(self)->notified = 0; 							\
+	} while (0)
+#endif
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_task_stack_usage
+* Purpose:    	Pre-set the task's private stack memory area to some known value
+*				in order to estimate the stack usage later
+* Arguments:	
+*		toPrepare - pointer to the top of the task's stack memory to initialise
+* 		size - size of stack memory
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_task_stack_usage(uint32_t* toPrepare, uint32_t size);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_task_static_template
+* Purpose:    	MACRO speeding up the static task declaration by automatically declaring 
+*				and initialising variables and constants to be passed to 
+*				KrisOS_task_create_static.
+* Arguments:	
+*		NAME - unique name of the task and prefix to the task description variable names.
+*			   1. task function name - void <NAME>(void)
+*			   2. task struct - Task <NAME>Task
 *			   3. task stack size - <NAME>StackSize = SIZE
 *			   4. task stack memory - <NAME>Stack['task stack size']
 * 			   5. task priority - <NAME>Priority
@@ -839,4 +2952,134 @@ uint32_t KrisOS_task_stack_usage(uint32_t* toPrepare, uint32_t size);
 	const uint8_t NAME ## Priority = PRIORITY;	
 	
 	
+	
+#ifdef USE_QUEUE
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_queue_typed_routines
+* Purpose:    	MACRO generating the routines of queues specialised for the item 
+*				type given. The copy routines move the item with a single typed
+*				load/store (LDRB/LDRH/LDR/LDRD), or a struct copy (LDM/STM) for 
+*				larger word-aligned types, and advance the head/tail pointers by
+*				a compile-time constant. The write/read routines call them 
+*				directly and make no SVC call unless they have to block or wake
+*				a task.
+* Arguments:	
+*		NAME - unique name of the item type and prefix to the generated names.
+*			   1. copy routines - <NAME>Enqueue(), <NAME>Dequeue()
+*			   2. copy routine table - const QueueOps <NAME>Ops
+*			   3. blocking write/read - uint32_t <NAME>Write(Queue*, const TYPE*),
+*				  uint32_t <NAME>Read(Queue*, TYPE*)
+*		TYPE - type of items stored
+* Note: 
+*		The write/read routines move the head/tail pointer without a critical 
+*		section (unprivileged tasks can't disable interrupts). A queue written
+*		through <NAME>Write must have no other writer and a queue read through
+*		<NAME>Read no other reader, tasks or ISRs. The generic queue API can 
+*		still be used on the queue otherwise (it copies through <NAME>Ops), 
+*		except for the writes to the front: these move the tail pointer, 
+*		which belongs to the reader, so they are refused on typed queues.
+--------------------------------------------------------------------------------*/
+#define KrisOS_queue_typed_routines(NAME, TYPE) 								\
+	static void NAME ## Enqueue(Queue* queue, const void* item) {			\
+		TYPE* slot = (TYPE*) queue->head;									\
+		*slot++ = *(const TYPE*) item;										\
+		queue->head = (slot == (TYPE*) queue->bufferEnd) ? 					\
+					  queue->buffer : (uint8_t*) slot;						\
+	}																		\
+	static void NAME ## Dequeue(Queue* queue, void* item) {					\
+		TYPE* slot = (TYPE*) queue->tail;									\
+		*(TYPE*) item = *slot++;											\
+		queue->tail = (slot == (TYPE*) queue->bufferEnd) ? 					\
+					  queue->buffer : (uint8_t*) slot;						\
+	}																		\
+	const QueueOps NAME ## Ops = {NAME ## Enqueue, NAME ## Dequeue, sizeof(TYPE)};	\
+	uint32_t NAME ## Write(Queue* queue, const TYPE* item) {				\
+		KrisOS_sem_acquire(&queue->remainingCapacity);						\
+		NAME ## Enqueue(queue, item);										\
+		KrisOS_sem_release(&queue->elementsStored);							\
+		return EXIT_SUCCESS;												\
+	}																		\
+	uint32_t NAME ## Read(Queue* queue, TYPE* item) {						\
+		KrisOS_sem_acquire(&queue->elementsStored);							\
+		NAME ## Dequeue(queue, item);										\
+		KrisOS_sem_release(&queue->remainingCapacity);						\
+		return EXIT_SUCCESS;												\
+	}
+	
+	
+	
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_queue_typed_template
+* Purpose:    	MACRO generating a statically allocated queue specialised for the
+*				item type given, together with its routines (see 
+*				KrisOS_queue_typed_routines).
+* Arguments:	
+*		NAME - unique name of the queue and prefix to the generated names.
+*			   1. queue struct - Queue <NAME>Queue
+*			   2. buffer memory - TYPE <NAME>Buffer[CAPACITY]
+*			   3. queue capacity - <NAME>Capacity = CAPACITY
+*			   4. routines - <NAME>Enqueue(), <NAME>Dequeue(), <NAME>Ops, 
+*				  <NAME>Write(), <NAME>Read()
+*		TYPE - type of items stored
+* 		CAPACITY - number of items the queue can fit
+* Note: 
+*		Initialise the queue with 
+*		KrisOS_queue_init_typed(&<NAME>Queue, <NAME>Buffer, <NAME>Capacity, &<NAME>Ops)
+*		and, if it has a single writer and a single reader, use
+*		<NAME>Write(&<NAME>Queue, &item) and <NAME>Read(&<NAME>Queue, &item)
+--------------------------------------------------------------------------------*/
+#define KrisOS_queue_typed_template(NAME, TYPE, CAPACITY) 					\
+	KrisOS_queue_typed_routines(NAME, TYPE)									\
+	Queue NAME ## Queue;													\
+	const size_t NAME ## Capacity = CAPACITY;								\
+	TYPE NAME ## Buffer[CAPACITY];
+#endif
+
+
+
+#ifdef USE_PQUEUE
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_pqueue_template
+* Purpose:    	MACRO declaring a priority queue together with its memory
+* Arguments:	
+*		NAME - unique name of the queue and prefix to the generated names.
+*			   1. queue struct - PriorityQueue <NAME>PQueue
+*			   2. queue capacity - <NAME>Capacity = CAPACITY
+*			   3. heap and slot memory - <NAME>Memory[]
+*		TYPE - type of messages stored
+* 		CAPACITY - number of messages the queue can fit
+* Note: 
+*		Initialise the queue with 
+*		KrisOS_pqueue_init(&<NAME>PQueue, <NAME>Memory, <NAME>Capacity, sizeof(TYPE))
+--------------------------------------------------------------------------------*/
+#define KrisOS_pqueue_template(NAME, TYPE, CAPACITY) 						\
+	PriorityQueue NAME ## PQueue;											\
+	const size_t NAME ## Capacity = CAPACITY;								\
+	uint32_t NAME ## Memory[(PQUEUE_MEMORY_SIZE(CAPACITY, sizeof(TYPE)) + 3) / 4];
+#endif
+
+
+
+#ifdef USE_TOPIC
+/*-------------------------------------------------------------------------------
+* Macro:    	KrisOS_topic_template
+* Purpose:    	MACRO declaring a topic together with its sample buffer pool
+* Arguments:	
+*		NAME - unique name of the topic and prefix to the generated names.
+*			   1. topic struct - Topic <NAME>Topic
+*			   2. number of pool buffers - <NAME>BufferNo = BUFFER_NO
+*			   3. pool memory - <NAME>Pool[]
+*		TYPE - type of samples published
+* 		BUFFER_NO - number of samples which can be in use at the same time
+* Note: 
+*		Initialise the topic with 
+*		KrisOS_topic_init(&<NAME>Topic, <NAME>Pool, <NAME>BufferNo, sizeof(TYPE))
+--------------------------------------------------------------------------------*/
+#define KrisOS_topic_template(NAME, TYPE, BUFFER_NO) 						\
+	Topic NAME ## Topic;													\
+	const size_t NAME ## BufferNo = BUFFER_NO;								\
+	uint64_t NAME ## Pool[(BUFFER_NO) * TOPIC_SLOT_SIZE(sizeof(TYPE)) / 8];
+#endif
+	
+	
 #endif
@@ -5,7 +5,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	02/03/2016
-* Last mod: 	11/03/2016
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	The following multiline macros are used for input argument checking, especially
@@ -16,6 +16,11 @@
 *	inside an SVC call:
 *		1. NULL pointer as a reference to a data structure
 *		2. Size argument which is not positive
+*		3. Kernel service called from an interrupt handler with the priority
+*		   above MAX_SYSCALL_PRIORITY (not masked by kernel critical sections)
+*		4. Task trying to block while the scheduler is locked
+*		5. Basic task trying to block or delete itself (basic tasks run to 
+*		   completion)
 *
 *	There are a lot more traps for invalid arguments, however they are context
 *	specific so the code for dealing with them is declared directly inside 
@@ -31,6 +36,11 @@
 #define EXIT_HEAP_TOO_SMALL 4
 #define EXIT_UART_INVALID_BAUD_RATE 5
 #define EXIT_INVALID_OS_CLOCK_FREQ 6
+#define EXIT_INVALID_ISR_PRIO 7
+#define EXIT_SCHEDULER_LOCKED 8
+#define EXIT_BASIC_TASK_BLOCKED 9
+#define EXIT_BASIC_STACK_OVERFLOW 10
+// 11 is taken by EXIT_TIMEOUT (KrisOS.h), the status returned by the timed waits
 
 
 
@@ -58,3 +68,46 @@
 #define TEST_INVALID_SIZE(SIZE) 				\
 	if (SIZE == 0) 								\
 		exit(EXIT_INVALID_SIZE); 									
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	TEST_ISR_PRIORITY
+* Purpose:    	Test if the kernel is called from a context it can protect itself 
+*				against, i.e. Thread mode or a handler with the priority equal or
+*				lower than MAX_SYSCALL_PRIORITY.
+* Arguments:	-
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+#define TEST_ISR_PRIORITY 						\
+	if (nvic_get_active_priority() < MAX_SYSCALL_PRIORITY) \
+		exit(EXIT_INVALID_ISR_PRIO);
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	TEST_SCHEDULER_UNLOCKED
+* Purpose:    	Test if the scheduler isn't locked, before the running task blocks.
+* Arguments:	-
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+#define TEST_SCHEDULER_UNLOCKED 				\
+	if (scheduler.lockDepth) 					\
+		exit(EXIT_SCHEDULER_LOCKED);
+
+
+
+/*-------------------------------------------------------------------------------
+* Macro:    	TEST_NOT_BASIC_TASK
+* Purpose:    	Test if the running task isn't a basic one, before it blocks or
+*				is deleted. Basic tasks share one stack, so they can't wait.
+* Arguments:	-
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+#ifdef USE_BASIC_TASK
+	#define TEST_NOT_BASIC_TASK 				\
+		if (scheduler.runPtr->entry != NULL) 	\
+			exit(EXIT_BASIC_TASK_BLOCKED);
+#else
+	#define TEST_NOT_BASIC_TASK
+#endif
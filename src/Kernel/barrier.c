@@ -0,0 +1,260 @@
+/*******************************************************************************
+* File:     	barrier.c
+* Brief:    	Cyclic barrier implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	A barrier synchronises a fixed number of tasks (parties) processing data in 
+*	phases, so that none of them starts phase N+1 before all have finished 
+*	phase N. Each task calls KrisOS_barrier_wait at the end of a phase, which
+*	costs one SVC call per task per phase. The tasks arriving block on the 
+*	waiting queue of the barrier. The last task to arrive is the leader of the 
+*	phase: it doesn't block, but wakes all the others in one kernel operation
+*	with a single scheduling decision. The barrier is then reset for the next 
+*	phase (cyclic barrier).
+*
+*	If a serial step has to be run between the phases (e.g. merging the partial 
+*	results), the barrier is initialised with BARRIER_LEADER_STEP. The leader
+*	(KrisOS_barrier_wait returns BARRIER_LEADER) then runs the step while the
+*	others still wait, and releases them with KrisOS_barrier_release.
+*
+*	The CPU cycles spent in the kernel by all the calls of a phase are reported
+*	by the stats task, per number of tasks synchronised (2, 3-4, 5-8, 9+). 
+*	BARRIERS ARE NOT ALLOWED TO BE USED INSIDE INTERRUPT HANDLERS.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_BARRIER
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_init
+* Purpose:    	Initialise the barrier given
+* Arguments:	
+* 		toInit - barrier to initialise
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t barrier_init(Barrier* toInit, uint32_t parties, uint8_t options) {
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toInit)
+	if (parties == 0)
+		return EXIT_FAILURE;
+	
+	toInit->parties = parties;
+	toInit->arrived = 0;
+	toInit->options = options;
+	toInit->waitingQueue = NULL;
+	
+	// Update the total number of barriers declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		toInit->phaseCycles = 0;
+		KrisOS.totalBarrierNo++;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_create
+* Purpose:    	Create a barrier using dynamic memory allocation
+* Arguments:	
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		pointer to the barrier created
+--------------------------------------------------------------------------------*/
+Barrier* barrier_create(uint32_t parties, uint8_t options) {
+	
+	Barrier* toCreate = malloc(sizeof(Barrier));
+	barrier_init(toCreate, parties, options);
+	return toCreate;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_delete
+* Purpose:    	Delete the barrier given
+* Arguments:	
+* 		toDelete - barrier to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting at the barrier
+--------------------------------------------------------------------------------*/
+uint32_t barrier_delete(Barrier* toDelete) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		// Check if no task is waiting at the barrier
+		if (toDelete->waitingQueue != NULL) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Update the total number of barriers declared
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalBarrierNo--;
+		#endif
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_end_phase
+* Purpose:    	Wake all the tasks waiting at the barrier and start a new phase
+* Arguments:	
+* 		toEnd - barrier to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void barrier_end_phase(Barrier* toEnd) {
+	
+	// Make all the waiters ready and reschedule once
+	while (toEnd->waitingQueue != NULL)
+		task_wake(toEnd->waitingQueue);
+	toEnd->arrived = 0;
+	scheduler_run();
+}
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_record_phase
+* Purpose:    	Record the CPU cycles the kernel has spent in the phase just ended
+* Arguments:	
+* 		toRecord - barrier whose phase has ended
+*		start - cycle count at the start of the last call of the phase
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void barrier_record_phase(Barrier* toRecord, uint32_t start) {
+	
+	// Class of the barrier by the number of tasks synchronised (2, 3-4, 5-8, 9+)
+	uint32_t class;
+	
+	if (toRecord->parties <= 2)
+		class = 0;
+	else if (toRecord->parties <= 4)
+		class = 1;
+	else if (toRecord->parties <= 8)
+		class = 2;
+	else
+		class = 3;
+	
+	// Count the last call together with the ones made earlier in the phase
+	cycle_stat_update(&KrisOS.barrierPhase[class], start - toRecord->phaseCycles);
+	toRecord->phaseCycles = 0;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_wait
+* Purpose:    	Arrive at the barrier and wait until all the tasks have arrived.
+*				The last task to arrive is the leader of the phase and doesn't wait.
+* Arguments:	
+* 		toWait - barrier to wait at
+* Returns: 		
+*		BARRIER_LEADER to the leader, EXIT_SUCCESS to the other tasks
+--------------------------------------------------------------------------------*/
+uint32_t barrier_wait(Barrier* toWait) {
+	
+	// Cycle count at the start of the call (phase cost measurement)
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t start = DWT->CYCCNT;
+	#endif
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toWait)
+	
+	__start_critical();
+	{
+		// The previous phase hasn't been released by its leader yet
+		if (toWait->arrived >= toWait->parties) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Not everybody has arrived yet, wait
+		if (++toWait->arrived < toWait->parties) {
+			task_wait(&toWait->waitingQueue, toWait, BARRIER_WAIT, TIME_INFINITY);
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				toWait->phaseCycles += DWT->CYCCNT - start;
+			#endif
+			__end_critical();
+			return EXIT_SUCCESS;
+		}
+	
+		// The leader releases everybody, unless it has a serial step to run first
+		if (!(toWait->options & BARRIER_LEADER_STEP)) {
+			barrier_end_phase(toWait);
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				barrier_record_phase(toWait, start);
+			#endif
+		}
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			else
+				toWait->phaseCycles += DWT->CYCCNT - start;
+		#endif
+	}
+	__end_critical();
+	return BARRIER_LEADER;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_release
+* Purpose:    	Release the tasks waiting at a BARRIER_LEADER_STEP barrier, once
+*				the leader has finished its serial step
+* Arguments:	
+* 		toRelease - barrier to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if not all the tasks have arrived
+--------------------------------------------------------------------------------*/
+uint32_t barrier_release(Barrier* toRelease) {
+	
+	// Cycle count at the start of the call (phase cost measurement)
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t start = DWT->CYCCNT;
+	#endif
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toRelease)
+	
+	__start_critical();
+	{
+		// The phase isn't over yet
+		if (toRelease->arrived < toRelease->parties) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+		barrier_end_phase(toRelease);
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			barrier_record_phase(toRelease, start);
+		#endif
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+#endif
@@ -0,0 +1,81 @@
+/*******************************************************************************
+* File:     	barrier.h
+* Brief:    	Header file for barrier.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_BARRIER
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_init
+* Purpose:    	Initialise the barrier given
+* Arguments:	
+* 		toInit - barrier to initialise
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t barrier_init(Barrier* toInit, uint32_t parties, uint8_t options);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_create
+* Purpose:    	Create a barrier using dynamic memory allocation
+* Arguments:	
+*		parties - number of tasks synchronised by the barrier
+*		options - BARRIER_NO_OPTIONS/BARRIER_LEADER_STEP
+* Returns: 		
+*		pointer to the barrier created
+--------------------------------------------------------------------------------*/
+Barrier* barrier_create(uint32_t parties, uint8_t options);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_delete
+* Purpose:    	Delete the barrier given
+* Arguments:	
+* 		toDelete - barrier to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting at the barrier
+--------------------------------------------------------------------------------*/
+uint32_t barrier_delete(Barrier* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_wait
+* Purpose:    	Arrive at the barrier and wait until all the tasks have arrived.
+*				The last task to arrive is the leader of the phase and doesn't wait.
+* Arguments:	
+* 		toWait - barrier to wait at
+* Returns: 		
+*		BARRIER_LEADER to the leader, EXIT_SUCCESS to the other tasks
+--------------------------------------------------------------------------------*/
+uint32_t barrier_wait(Barrier* toWait);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	barrier_release
+* Purpose:    	Release the tasks waiting at a BARRIER_LEADER_STEP barrier, once
+*				the leader has finished its serial step
+* Arguments:	
+* 		toRelease - barrier to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if not all the tasks have arrived
+--------------------------------------------------------------------------------*/
+uint32_t barrier_release(Barrier* toRelease);
+
+#endif
@@ -0,0 +1,322 @@
+/*******************************************************************************
+* File:     	basictask.c
+* Brief:    	Run-to-completion basic tasks sharing a single stack
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	Every (extended) KrisOS task has a private stack, sized for the deepest
+*	call chain of the task plus the context saved when it is switched out. Most
+*	of the SRAM ends up reserved in stacks which are rarely all in use. Basic 
+*	tasks (as in OSEK) have no private stack. A basic task is activated (by a 
+*	task or an interrupt handler), runs its code to completion and becomes 
+*	dormant again. It never blocks, so once started it only waits for the 
+*	tasks of higher priority. Hence, all the basic tasks can share one stack,
+*	following the stack resource policy:
+*		1. A basic task is given its frame on top of the shared stack when the
+*		   scheduler picks it to run, not when it is activated.
+*		2. It can only start if its priority is higher than the one of the 
+*		   basic task on top of the shared stack (the one started last). 
+*		   Otherwise, that task is run until it completes.
+*		3. So, the basic tasks on the shared stack are ordered by priority and 
+*		   they complete in the reverse order of starting. A task completing 
+*		   always frees the top of the stack.
+*	The shared stack has to hold one basic task of each priority level at most,
+*	with the context saved when it gets preempted. Basic tasks coexist with the 
+*	extended ones in the ready queue, an extended task preempting a basic task
+*	just leaves its context on the shared stack.
+*
+*	Basic tasks can't sleep, wait on objects or lock mutexes (a blocked basic 
+*	task would pin the shared stack under the tasks above it), which is checked
+*	by the scheduler. They can release semaphores, give notifications, send to 
+*	queues which aren't full etc. Activations made while the task is active 
+*	are queued (up to BASIC_ACTIVATIONS_MAX) and run one after another. 
+*
+*	The stats task shows the peak usage of the shared stack, which all the 
+*	basic tasks report as their stack usage as well. Hence, the RAM saved can 
+*	be read from the stats: the sum of the stack sizes of the extended tasks 
+*	that could become basic ones against the size of the shared stack.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_BASIC_TASK
+/*-------------------------------------------------------------------------------
+* Space left below the process stack pointer of a running basic task, when 
+* another one is started above it before the running one is switched out. It 
+* holds the context the switch saves (with the floating-point context). In Thread
+* mode, the exception stack frame hasn't been stacked yet either.
+*------------------------------------------------------------------------------*/
+#define BASIC_HANDLER_MARGIN ((STACK_FRAME_SIZE - 8 + STACK_FRAME_FP_SIZE) << 2)
+#define BASIC_THREAD_MARGIN (BASIC_HANDLER_MARGIN + ((8 + 18 + 1) << 2))
+
+
+
+/*-------------------------------------------------------------------------------
+* The shared stack (8-byte aligned, as required by the procedure call standard)
+* and the basic task started last (on top of the shared stack)
+--------------------------------------------------------------------------------*/
+static uint8_t basicStack[BASIC_STACK_SIZE] __attribute__((aligned(8)));
+static Task* basicTop;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_complete_handler
+* Purpose:    	Code executed when a basic task returns
+* Arguments: 	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void basic_task_complete_handler(void) {
+	KrisOS_basic_task_terminate();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_service_init
+* Purpose:    	Initialise the stack shared by the basic tasks
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void basic_task_service_init(void) {
+	basicTop = NULL;
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS_task_stack_usage((uint32_t*) &basicStack[0], BASIC_STACK_SIZE);
+	#endif
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_create
+* Purpose:    	Create a dormant basic task
+* Arguments:	
+* 		toCreate - pointer to the task control block of the task to create
+*		startAddr - pointer to the task code (function)
+*		priority - task priority. The higher the number the lower the priority.
+*		isPrivileged - 1 if privileged access level (system task), 0 otherwise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_create(Task* toCreate, void* startAddr, uint8_t priority, 
+						   uint8_t isPrivileged) {
+	
+	// Validate input arguments
+	TEST_NULL_POINTER(toCreate)
+	TEST_NULL_POINTER(startAddr)
+	
+	// The task uses the shared stack. Its frame is placed when it is started.
+	toCreate->stackBottom = (uint32_t*) &basicStack[BASIC_STACK_SIZE];
+	toCreate->sp = ((uint32_t) toCreate->stackBottom) - (STACK_FRAME_SIZE << 2);
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		toCreate->memoryType = STATIC;
+	#endif
+	
+	// Initialise the task control block. The task isn't in any queue until 
+	// activated.
+	task_control_init(toCreate, isPrivileged, priority);
+	toCreate->entry = startAddr;
+	toCreate->status = DORMANT;
+	
+	__start_critical();
+	{
+		// Register the task at the scheduler
+		#ifdef SHOW_DIAGNOSTIC_DATA	
+			scheduler.taskRegistry[scheduler.totalTaskNo++] = toCreate;
+			toCreate->cpuUsage = 0;
+		#endif
+		KrisOS_seqlock_write_begin(&kernelInfo.lock);
+		kernelInfo.taskNo++;
+		KrisOS_seqlock_write_end(&kernelInfo.lock);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_activate
+* Purpose:    	Activate the basic task given, or queue the activation if the
+*				task is already active
+* Arguments:	
+* 		toActivate - basic task to activate
+* Returns: 		
+*		exit status, EXIT_FAILURE if no more activations can be queued
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_activate(Task* toActivate) {
+	
+	uint32_t exitStatus = EXIT_SUCCESS;
+	
+	// Validate input arguments
+	TEST_NULL_POINTER(toActivate)
+	if (toActivate->entry == NULL)
+		return EXIT_FAILURE;
+	
+	__start_critical();
+	{
+		// A dormant task is made ready. It is started when the scheduler picks it.
+		if (toActivate->status == DORMANT) {
+			toActivate->status = READY;
+			task_add(&scheduler.ready, toActivate);
+			if (KrisOS.isRunning)
+				scheduler_run();
+		}
+		else if (toActivate->activations < BASIC_ACTIVATIONS_MAX)
+			toActivate->activations++;
+		else
+			exitStatus = EXIT_FAILURE;
+	}
+	__end_critical();
+	return exitStatus;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_terminate
+* Purpose:    	Terminate the running basic task, freeing its part of the shared
+*				stack, and run it again if it has activations queued
+* Arguments:	-
+* Returns: 		
+*		exit status, EXIT_FAILURE if the running task isn't a basic one
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_terminate(void) {
+	
+	Task* toTerminate = scheduler.runPtr;
+	
+	// Pointer to the stack frame of the next activation
+	uint32_t* taskFramePtr;
+	
+	if (toTerminate->entry == NULL)
+		return EXIT_FAILURE;
+	TEST_SCHEDULER_UNLOCKED
+	
+	__start_critical();
+	{
+		// Free the top of the shared stack (the completing task is always on top)
+		basicTop = toTerminate->basicBelow;
+		toTerminate->isStarted = 0;
+		
+		// Either make the task dormant, or leave it ready to run its next activation
+		if (toTerminate->activations)
+			toTerminate->activations--;
+		else {
+			task_remove(&scheduler.ready, toTerminate);
+			toTerminate->status = DORMANT;
+		}
+		
+		// The state of the ready queue has changed so rescheduling is necessary
+		scheduler_run();
+		
+		// If the task is to run its next activation straight away, there is no 
+		// context switch. The scheduler has given the task a fresh frame at the
+		// freed top of the shared stack, so the SVC call returns into it (as when 
+		// the OS starts) and the frame of the completed activation is dropped.
+		if (scheduler.topPrioTask == toTerminate) {
+			__set_psp(toTerminate->sp + (STACK_FRAME_R0 << 2));
+			taskFramePtr = (uint32_t*) (toTerminate->sp + (STACK_FRAME_CONTROL << 2));
+			__set_control(*taskFramePtr);
+			taskFramePtr = (uint32_t*) toTerminate->sp;
+			scheduler.svcExcReturn = *taskFramePtr;
+			
+			// A pending lazy save of the floating-point context would write it 
+			// to the dropped frame, which now overlaps the fresh one
+			FPU->FPCCR &= ~(1U << LSPACT);
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_dispatch
+* Purpose:    	Prepare the task picked by the scheduler to run. A basic task 
+*				starting is given its frame on top of the shared stack, if its
+*				priority is above the one of the basic task on top. Otherwise, 
+*				the basic task on top is run instead.
+* Arguments:	
+* 		toRun - task picked by the scheduler
+* Returns: 		
+*		task to run
+--------------------------------------------------------------------------------*/
+Task* basic_task_dispatch(Task* toRun) {
+	
+	// Top of the shared stack (the lowest address in use)
+	uint32_t stackTop;
+	
+	// Extended tasks and the basic tasks already started run as usual
+	if (toRun->entry == NULL || toRun->isStarted)
+		return toRun;
+	
+	// A basic task can only start above the basic tasks of lower priority. (It
+	// can be picked over the task on top because of time-sliced preemption or
+	// because it has been activated later with the same priority).
+	if (basicTop != NULL && toRun->priority >= basicTop->priority)
+		return basicTop;
+	
+	// Find the top of the shared stack. The basic task on top has its context
+	// saved, unless it is still running (the context switch is pending).
+	if (basicTop == NULL)
+		stackTop = (uint32_t) &basicStack[BASIC_STACK_SIZE];
+	else if (basicTop == scheduler.runPtr)
+		stackTop = __get_psp() - (__get_ipsr() ? BASIC_HANDLER_MARGIN : BASIC_THREAD_MARGIN);
+	else
+		stackTop = basicTop->sp;
+	stackTop &= ~(STACK_ALIGNMENT - 1);
+	if (stackTop < (uint32_t) &basicStack[0] + (STACK_FRAME_SIZE << 2))
+		exit(EXIT_BASIC_STACK_OVERFLOW);
+	
+	// Place the frame of the task to run there and put the task on top
+	toRun->sp = stackTop - (STACK_FRAME_SIZE << 2);
+	task_frame_init(toRun, toRun->entry, basic_task_complete_handler, toRun->isPrivileged);
+	toRun->isStarted = 1;
+	toRun->basicBelow = basicTop;
+	basicTop = toRun;
+	return toRun;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_basic_task_activate_ISR
+* Purpose:    	Activate the basic task given inside an interrupt service routine
+* Arguments:	
+* 		toActivate - basic task to activate
+* Returns: 		
+*		exit status, EXIT_FAILURE if no more activations can be queued
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_basic_task_activate_ISR(Task* toActivate) {
+	TEST_ISR_PRIORITY
+	return basic_task_activate(toActivate);
+}
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_stack_usage
+* Purpose:    	Estimate the peak usage of the stack shared by the basic tasks
+* Arguments:	-
+* Returns: 		
+*		number of bytes of the shared stack used so far
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_stack_usage(void) {
+	
+	// Iterator through the shared stack, from its end up to the first word used
+	uint32_t* iterator = (uint32_t*) &basicStack[0];
+	
+	while (iterator < (uint32_t*) &basicStack[BASIC_STACK_SIZE] && *iterator == 0xDEADBEEF)
+		iterator++;
+	return (uint32_t) &basicStack[BASIC_STACK_SIZE] - (uint32_t) iterator;
+}
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+/*******************************************************************************
+* File:     	basictask.h
+* Brief:    	Header file for basictask.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_BASIC_TASK
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_service_init
+* Purpose:    	Initialise the stack shared by the basic tasks
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void basic_task_service_init(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_create
+* Purpose:    	Create a dormant basic task
+* Arguments:	
+* 		toCreate - pointer to the task control block of the task to create
+*		startAddr - pointer to the task code (function)
+*		priority - task priority. The higher the number the lower the priority.
+*		isPrivileged - 1 if privileged access level (system task), 0 otherwise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_create(Task* toCreate, void* startAddr, uint8_t priority, 
+						   uint8_t isPrivileged);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_activate
+* Purpose:    	Activate the basic task given, or queue the activation if the
+*				task is already active
+* Arguments:	
+* 		toActivate - basic task to activate
+* Returns: 		
+*		exit status, EXIT_FAILURE if no more activations can be queued
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_activate(Task* toActivate);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_terminate
+* Purpose:    	Terminate the running basic task, freeing its part of the shared
+*				stack, and run it again if it has activations queued
+* Arguments:	-
+* Returns: 		
+*		exit status, EXIT_FAILURE if the running task isn't a basic one
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_terminate(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_dispatch
+* Purpose:    	Prepare the task picked by the scheduler to run. A basic task 
+*				starting is given its frame on top of the shared stack, if its
+*				priority is above the one of the basic task on top. Otherwise, 
+*				the basic task on top is run instead.
+* Arguments:	
+* 		toRun - task picked by the scheduler
+* Returns: 		
+*		task to run
+--------------------------------------------------------------------------------*/
+Task* basic_task_dispatch(Task* toRun);
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	basic_task_stack_usage
+* Purpose:    	Estimate the peak usage of the stack shared by the basic tasks
+* Arguments:	-
+* Returns: 		
+*		number of bytes of the shared stack used so far
+--------------------------------------------------------------------------------*/
+uint32_t basic_task_stack_usage(void);
+#endif
+
+#endif
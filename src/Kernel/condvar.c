@@ -0,0 +1,255 @@
+/*******************************************************************************
+* File:     	condvar.c
+* Brief:    	Condition variable implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	A condition variable lets a task holding a mutex wait until a predicate on
+*	the data protected by the mutex becomes true, instead of polling it. The 
+*	mutex is released and the task blocks inside one SVC call, so a signal sent
+*	in between can't be lost. The mutex the task has to take again is kept as 
+*	the object it waits on (waitingObj).
+*
+*	The waiting queue is arranged in descending priority order. A signal wakes
+*	the top priority waiter and a broadcast wakes all of them, with a single 
+*	scheduling decision. A task woken doesn't compete for the mutex from 
+*	scratch: if the mutex is free it becomes the owner straight away, otherwise
+*	it is moved to the waiting queue of the mutex without running and the mutex
+*	owner inherits its priority, just like a task blocked in mutex_lock. So, the
+*	tasks woken by a broadcast don't all wake up only to block on the mutex 
+*	again. The wait returns with the mutex locked, but the predicate should 
+*	still be checked again in a loop.
+*
+*	Signalling a condition variable nobody waits on doesn't enter the kernel.
+*	CONDITION VARIABLES ARE NOT ALLOWED TO BE USED INSIDE INTERRUPT HANDLERS, 
+*	as mutexes aren't.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_CONDVAR
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_init
+* Purpose:    	Initialise the condition variable given
+* Arguments:	
+* 		toInit - condition variable to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_init(CondVar* toInit) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toInit)
+	
+	toInit->waitingQueue = NULL;
+	
+	// Update the total number of condition variables declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalCondVarNo++;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_create
+* Purpose:    	Create a condition variable using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the condition variable created
+--------------------------------------------------------------------------------*/
+CondVar* condvar_create(void) {
+	
+	CondVar* toCreate = malloc(sizeof(CondVar));
+	condvar_init(toCreate);
+	return toCreate;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_delete
+* Purpose:    	Delete the condition variable given
+* Arguments:	
+* 		toDelete - condition variable to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the condition variable
+--------------------------------------------------------------------------------*/
+uint32_t condvar_delete(CondVar* toDelete) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		// Check if the condition variable isn't currently waited on
+		if (toDelete->waitingQueue != NULL) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Update the total number of condition variables declared
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalCondVarNo--;
+		#endif
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_wait
+* Purpose:    	Release the mutex given and wait for a signal, atomically. The
+*				mutex is locked again before the SVC call returns.
+* Arguments:	
+* 		cond - condition variable to wait on
+*		mtx - mutex held by the calling task, protecting the predicate
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task doesn't own the mutex
+--------------------------------------------------------------------------------*/
+uint32_t condvar_wait(CondVar* cond, Mutex* mtx) {
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(cond)
+	TEST_NULL_POINTER(mtx)
+	
+	__start_critical();
+	{
+		// Only the owner of the mutex can wait
+		if (mtx->owner != scheduler.runPtr) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Release the mutex (hand it over to its top priority waiter and restore
+		// the priority of the calling task) and block. Nothing can signal the 
+		// condition variable in between.
+		mutex_unlock(mtx);
+		task_wait(&cond->waitingQueue, mtx, COND_WAIT, TIME_INFINITY);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_signal
+* Purpose:    	Wake the top priority task waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_signal(CondVar* cond) {
+	
+	Task* toWake;
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(cond)
+	
+	__start_critical();
+	{
+		// The head of the waiting queue takes the mutex, or starts waiting for it
+		if (cond->waitingQueue != NULL) {
+			toWake = cond->waitingQueue;
+			mutex_requeue(toWake->waitingObj, toWake);
+			scheduler_run();
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_broadcast
+* Purpose:    	Wake all the tasks waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_broadcast(CondVar* cond) {
+	
+	Task* toWake;
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(cond)
+	
+	__start_critical();
+	{
+		// Move the waiters in priority order, so that the most urgent one gets 
+		// the mutex if it is free and the others queue up behind it. Reschedule
+		// once all of them have been moved.
+		if (cond->waitingQueue != NULL) {
+			while (cond->waitingQueue != NULL) {
+				toWake = cond->waitingQueue;
+				mutex_requeue(toWake->waitingObj, toWake);
+			}
+			scheduler_run();
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_signal
+* Purpose:    	Wake the top priority task waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_condvar_signal(CondVar* cond) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(cond)
+	
+	// Enter the kernel only if there is a task to wake. A task can only start 
+	// waiting while it holds the mutex, so the check can't race with a waiter
+	// if the signalling task holds the mutex too.
+	if (cond->waitingQueue == NULL)
+		return EXIT_SUCCESS;
+	return KrisOS_condvar_signal_slow(cond);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_broadcast
+* Purpose:    	Wake all the tasks waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_condvar_broadcast(CondVar* cond) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(cond)
+	
+	// Enter the kernel only if there are tasks to wake
+	if (cond->waitingQueue == NULL)
+		return EXIT_SUCCESS;
+	return KrisOS_condvar_broadcast_slow(cond);
+}
+
+
+
+#endif
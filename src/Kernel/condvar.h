@@ -0,0 +1,113 @@
+/*******************************************************************************
+* File:     	condvar.h
+* Brief:    	Header file for condvar.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_CONDVAR
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_init
+* Purpose:    	Initialise the condition variable given
+* Arguments:	
+* 		toInit - condition variable to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_init(CondVar* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_create
+* Purpose:    	Create a condition variable using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the condition variable created
+--------------------------------------------------------------------------------*/
+CondVar* condvar_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_delete
+* Purpose:    	Delete the condition variable given
+* Arguments:	
+* 		toDelete - condition variable to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the condition variable
+--------------------------------------------------------------------------------*/
+uint32_t condvar_delete(CondVar* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_wait
+* Purpose:    	Release the mutex given and wait for a signal, atomically. The
+*				mutex is locked again before the SVC call returns.
+* Arguments:	
+* 		cond - condition variable to wait on
+*		mtx - mutex held by the calling task, protecting the predicate
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task doesn't own the mutex
+--------------------------------------------------------------------------------*/
+uint32_t condvar_wait(CondVar* cond, Mutex* mtx);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_signal
+* Purpose:    	Wake the top priority task waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_signal(CondVar* cond);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	condvar_broadcast
+* Purpose:    	Wake all the tasks waiting on the condition variable given
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t condvar_broadcast(CondVar* cond);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_signal_slow
+* Purpose:    	Wake the top priority waiter inside the kernel. SVC call.
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_CONDVAR_SIGNAL) KrisOS_condvar_signal_slow(CondVar* cond);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_condvar_broadcast_slow
+* Purpose:    	Wake all the waiters inside the kernel. SVC call.
+* Arguments:	
+* 		cond - condition variable to signal
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_CONDVAR_BROADCAST) KrisOS_condvar_broadcast_slow(CondVar* cond);
+
+#endif
@@ -0,0 +1,257 @@
+/*******************************************************************************
+* File:     	coroutine.c
+* Brief:    	Stackless coroutine executor implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	Low-rate state machines (LCD updates, buzzer melodies, LED fades) spend 
+*	almost all their time waiting. As KrisOS tasks, each of them needs a private
+*	stack and a context switch per step. Coroutines (protothreads) are functions
+*	which return at every await and are resumed at the same place by the next 
+*	call, by jumping to the source line they have stored (see KrisOS_co_begin).
+*	A coroutine takes 20 bytes and has no stack of its own, so hundreds of them 
+*	can run inside one kernel task - the coroutine executor. Resuming a coroutine
+*	is a function call and a jump, cheaper than a context switch.
+*
+*	The executor takes one pass over its coroutines at a time, resuming the 
+*	ones whose event has come:
+*		1. CO_READY - coroutine yielded, resumed at the next pass
+*		2. CO_WAIT_POLL - coroutine awaits any condition, resumed to check it 
+*		   again at every pass
+*		3. CO_WAIT_RELEASE - coroutine awaits a semaphore (or a queue, whose 
+*		   items and free slots are semaphores), resumed to try again at every
+*		   pass
+*		4. CO_WAIT_TIME - coroutine sleeps, resumed at its wake-up time
+*		5. CO_WAIT_NOTIFY - coroutine awaits a notification, resumed once 
+*		   notified (by a task or an interrupt handler)
+*	After a pass, the executor waits on its task notification until the earliest
+*	wake-up time, or for COROUTINE_POLL_PERIOD 'ticks' if any coroutine awaits 
+*	a condition. Starting or notifying a coroutine notifies the executor, so it
+*	takes another pass straight away. So does releasing a semaphore awaited by
+*	any coroutine: a coroutine registers with the semaphore before it tries to
+*	acquire it, and the release paths (thread mode, SVC and interrupt) notify 
+*	the executor if the semaphore has coroutines registered. Hence, the awaits
+*	on semaphores and queues are driven by the events, they aren't polled.
+*
+*	The coroutines started are first put on a list of their own, which the 
+*	executor takes over at the beginning of the next pass. This way, only the
+*	executor walks and modifies the list of the coroutines run. A coroutine is
+*	active from its start until the executor takes it off the list once it has
+*	completed, and it can't be started again in the meantime.
+*
+*	The number of coroutines running and the CPU cycles taken by a coroutine 
+*	step (from resuming the coroutine until its next await, including its own 
+*	code) are recorded for the statistics task, to compare with the semaphore
+*	ping-pong between two tasks.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_COROUTINE
+/*-------------------------------------------------------------------------------
+* Coroutines started, not yet taken over by the executor
+--------------------------------------------------------------------------------*/
+static Coroutine* startList;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_service_init
+* Purpose:    	Initialise the coroutine executor
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void coroutine_service_init(void) {
+	startList = NULL;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_start
+* Purpose:    	Start a coroutine, handing it over to the executor task
+* Arguments:	
+* 		toStart - coroutine to start
+*		function - coroutine code
+*		context - user data, available to the code as self->context
+* Returns: 		
+*		exit status, EXIT_FAILURE if the coroutine is still running
+--------------------------------------------------------------------------------*/
+uint32_t coroutine_start(Coroutine* toStart, CoroutineFunction function, void* context) {
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toStart)
+	TEST_NULL_POINTER(function)
+	
+	__start_critical();
+	{
+		// A coroutine on one of the lists can't be linked into a list again
+		if (toStart->waitType != CO_INACTIVE) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+		
+		// Initialise the coroutine to start from the beginning of its code
+		toStart->function = function;
+		toStart->context = context;
+		toStart->resumePoint = 0;
+		toStart->waitType = CO_READY;
+		toStart->notified = 0;
+		toStart->next = startList;
+		startList = toStart;
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalCoroutineNo++;
+		#endif
+	}
+	__end_critical();
+	
+	// Make the executor take the coroutine over 
+	return notify_give(&coroutineExecutorTask, 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_sem_released
+* Purpose:    	Make the executor resume the coroutines awaiting a release, after
+*				a semaphore they are registered with has been released
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void coroutine_sem_released(void) {
+	notify_give(&coroutineExecutorTask, 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_coroutine_notify
+* Purpose:    	Notify the coroutine given, resuming it if it awaits a 
+*				notification
+* Arguments:	
+* 		toNotify - coroutine to notify
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_coroutine_notify(Coroutine* toNotify) {
+	TEST_NULL_POINTER(toNotify)
+	toNotify->notified = 1;
+	return KrisOS_notify(&coroutineExecutorTask, 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_coroutine_notify_ISR
+* Purpose:    	Notify the coroutine given inside an interrupt service routine
+* Arguments:	
+* 		toNotify - coroutine to notify
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_coroutine_notify_ISR(Coroutine* toNotify) {
+	TEST_ISR_PRIORITY
+	TEST_NULL_POINTER(toNotify)
+	toNotify->notified = 1;
+	return notify_give(&coroutineExecutorTask, 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*******************************************************************************
+* Task: 	coroutineExecutor
+* Purpose: 	Coroutine executor task. Resumes the coroutines whose event has come
+*			and sleeps until the next one is due.
+*******************************************************************************/
+void coroutineExecutor(void) {
+	
+	// Coroutines run and the link to the one visited
+	Coroutine* running = NULL;
+	Coroutine** link;
+	Coroutine* iterator;
+	
+	// Time until the executor has to take the next pass (in OS 'ticks') and 
+	// 1 if it has to take it straight away
+	uint32_t timeout;
+	uint8_t isBusy;
+	uint32_t remaining;
+	
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t start;
+	#endif
+	
+	while (1) {
+		
+		// Take over the coroutines started since the last pass
+		__start_critical();
+		while (startList != NULL) {
+			iterator = startList;
+			startList = iterator->next;
+			iterator->next = running;
+			running = iterator;
+		}
+		__end_critical();
+		
+		// Resume the coroutines whose event has come and find the earliest event
+		// still to come
+		timeout = TIME_INFINITY;
+		isBusy = 0;
+		link = &running;
+		while ((iterator = *link) != NULL) {
+			if (iterator->waitType == CO_READY || iterator->waitType == CO_WAIT_POLL ||
+				iterator->waitType == CO_WAIT_RELEASE ||
+				(iterator->waitType == CO_WAIT_TIME && 
+				 !TIME_BEFORE(KrisOS.ticks, iterator->wakeTime)) ||
+				(iterator->waitType == CO_WAIT_NOTIFY && iterator->notified)) {
+				
+				#ifdef SHOW_DIAGNOSTIC_DATA
+					start = DWT->CYCCNT;
+				#endif
+				if (iterator->function(iterator) == CO_ENDED) {
+					*link = iterator->next;
+					iterator->waitType = CO_INACTIVE;
+					#ifdef SHOW_DIAGNOSTIC_DATA
+						KrisOS.totalCoroutineNo--;
+					#endif
+					continue;
+				}
+				#ifdef SHOW_DIAGNOSTIC_DATA
+					cycle_stat_update(&KrisOS.coroutineResume, start);
+				#endif
+				
+				// A sleep is timed from the moment the coroutine suspends
+				if (iterator->waitType == CO_WAIT_DELAY) {
+					iterator->wakeTime += KrisOS.ticks;
+					iterator->waitType = CO_WAIT_TIME;
+				}
+			}
+			
+			// Work out when the coroutine has to be resumed again
+			remaining = TIME_INFINITY;
+			if (iterator->waitType == CO_READY)
+				isBusy = 1;
+			else if (iterator->waitType == CO_WAIT_POLL)
+				remaining = COROUTINE_POLL_PERIOD;
+			else if (iterator->waitType == CO_WAIT_TIME) {
+				if (TIME_BEFORE(KrisOS.ticks, iterator->wakeTime))
+					remaining = iterator->wakeTime - KrisOS.ticks;
+				else
+					isBusy = 1;
+			}
+			if (remaining != TIME_INFINITY && (timeout == TIME_INFINITY || remaining < timeout))
+				timeout = remaining;
+			link = &iterator->next;
+		}
+		
+		// Wait for the next event (a notification restarts the pass earlier)
+		if (!isBusy)
+			KrisOS_notify_wait(NOTIFY_CLEAR, timeout);
+	}
+}
+
+#endif
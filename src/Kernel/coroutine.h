@@ -0,0 +1,56 @@
+/*******************************************************************************
+* File:     	coroutine.h
+* Brief:    	Header file for coroutine.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_COROUTINE
+/*-------------------------------------------------------------------------------
+* Coroutine executor task (declared in scheduler.c)
+--------------------------------------------------------------------------------*/
+extern Task coroutineExecutorTask;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_service_init
+* Purpose:    	Initialise the coroutine executor
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void coroutine_service_init(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_start
+* Purpose:    	Start a coroutine, handing it over to the executor task
+* Arguments:	
+* 		toStart - coroutine to start
+*		function - coroutine code
+*		context - user data, available to the code as self->context
+* Returns: 		
+*		exit status, EXIT_FAILURE if the coroutine is still running
+--------------------------------------------------------------------------------*/
+uint32_t coroutine_start(Coroutine* toStart, CoroutineFunction function, void* context);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	coroutine_sem_released
+* Purpose:    	Make the executor resume the coroutines awaiting a release, after
+*				a semaphore they are registered with has been released
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void coroutine_sem_released(void);
+
+#endif
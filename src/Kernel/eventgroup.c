@@ -0,0 +1,308 @@
+/*******************************************************************************
+* File:     	eventgroup.c
+* Brief:    	Event flag group implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	An event group holds 32 event flags. A task can wait for any or all of a
+*	set of flags (sensor ready AND display idle, any of several buttons), which
+*	would otherwise need a semaphore per condition and a fixed order of blocking
+*	acquires. The flags waited for can be cleared automatically once the wait
+*	is satisfied (EVENT_CLEAR_ON_EXIT). Tasks and interrupt handlers
+*	(KrisOS_event_group_set_ISR) set flags, which never blocks.
+*
+*	Setting flags goes through the waiting queue once. Every waiter whose wait
+*	is satisfied by the new state of the flags is woken up and gets that state
+*	as its return value, then the flags they asked to clear are cleared. The
+*	scheduler is run once at the end. The mask and options each task waits
+*	with are stored in its task control block.
+*
+*	A wait which is satisfied straight away, and clearing the flags, is done 
+*	in thread mode with exclusive load/store (LDREX/STREX), without an SVC call.
+*	The wait returns 0 if the timeout expires first. WAITING IS ONLY ALLOWED
+*	THROUGH THE USER API (KrisOS_event_group_wait).
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_EVENT_GROUP
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_init
+* Purpose:    	Initialise the event flag group given, with all flags cleared
+* Arguments:	
+* 		toInit - event group to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t event_group_init(EventGroup* toInit) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toInit)
+	
+	toInit->flags = 0;
+	toInit->waitingQueue = NULL;
+	
+	// Update the total number of event groups declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalEventGroupNo++;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_create
+* Purpose:    	Create an event flag group using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the event group created
+--------------------------------------------------------------------------------*/
+EventGroup* event_group_create(void) {
+	
+	EventGroup* toCreate = malloc(sizeof(EventGroup));
+	event_group_init(toCreate);
+	return toCreate;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_delete
+* Purpose:    	Delete the event flag group given
+* Arguments:	
+* 		toDelete - event group to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the group
+--------------------------------------------------------------------------------*/
+uint32_t event_group_delete(EventGroup* toDelete) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		// Check if the event group isn't currently waited on
+		if (toDelete->waitingQueue != NULL) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Update the total number of event groups declared
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalEventGroupNo--;
+		#endif
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_is_satisfied
+* Purpose:    	Check if the state of the flags satisfies a wait
+* Arguments:	
+*		state - state of the flags
+* 		flags - flags waited for
+*		options - wait options
+* Returns: 		
+*		1 if the wait is satisfied, 0 otherwise
+--------------------------------------------------------------------------------*/
+static uint8_t event_group_is_satisfied(uint32_t state, uint32_t flags, uint8_t options) {
+	
+	if (options & EVENT_WAIT_ALL)
+		return (state & flags) == flags;
+	return (state & flags) != 0;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_set
+* Purpose:    	Set the flags given and wake all the tasks whose wait is now
+*				satisfied
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to set
+* Returns: 		
+*		state of the flags after the tasks woken have cleared theirs
+--------------------------------------------------------------------------------*/
+uint32_t event_group_set(EventGroup* group, uint32_t flags) {
+	
+	// Task checked and the next one in the waiting queue
+	Task* iterator;
+	Task* next;
+	
+	// State of the flags the waiters are checked against and the flags to clear
+	uint32_t state;
+	uint32_t toClear = 0;
+	
+	TEST_NULL_POINTER(group)
+	
+	__start_critical();
+	{
+		group->flags |= flags;
+		state = group->flags;
+	
+		// Wake every task satisfied by the new state in one pass. All of them see
+		// the same state, the flags are only cleared at the end.
+		if (group->waitingQueue != NULL) {
+			for (iterator = group->waitingQueue; iterator != NULL; iterator = next) {
+				next = iterator->next;
+				if (event_group_is_satisfied(state, iterator->eventMask, iterator->eventOptions)) {
+					if (iterator->eventOptions & EVENT_CLEAR_ON_EXIT)
+						toClear |= iterator->eventMask;
+					task_wake(iterator);
+					task_set_return_value(iterator, state);
+				}
+			}
+			group->flags &= ~toClear;
+			scheduler_run();
+		}
+		state = group->flags;
+	}
+	__end_critical();
+	return state;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_wait
+* Purpose:    	Wait until any or all (EVENT_WAIT_ALL) of the flags given are set
+* Arguments:	
+* 		group - event group to wait on
+*		flags - flags to wait for
+*		options - EVENT_WAIT_ANY/EVENT_WAIT_ALL, optionally with EVENT_CLEAR_ON_EXIT
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		state of the flags which satisfied the wait. If the task has to wait, the
+*		value is returned by the task setting the flags (0 on timeout).
+--------------------------------------------------------------------------------*/
+uint32_t event_group_wait(EventGroup* group, uint32_t flags, uint8_t options, uint32_t timeout) {
+	
+	uint32_t state;
+	TEST_NULL_POINTER(group)
+	
+	__start_critical();
+	{
+		// Return straight away if the wait is already satisfied
+		state = group->flags;
+		if (event_group_is_satisfied(state, flags, options)) {
+			if (options & EVENT_CLEAR_ON_EXIT)
+				group->flags &= ~flags;
+		}
+	
+		// Otherwise record what the task waits for and block it
+		else {
+			scheduler.runPtr->eventMask = flags;
+			scheduler.runPtr->eventOptions = options;
+			task_wait(&group->waitingQueue, group, EVENT_WAIT, timeout);
+			state = 0;
+		}
+	}
+	__end_critical();
+	return state;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_set_ISR
+* Purpose:    	Set the flags given inside an interrupt service routine
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to set
+* Returns: 		
+*		state of the flags after the tasks woken have cleared theirs
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_set_ISR(EventGroup* group, uint32_t flags) {
+	TEST_ISR_PRIORITY
+	return event_group_set(group, flags);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_clear
+* Purpose:    	Clear the flags given. Never blocks, doesn't enter the kernel.
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to clear
+* Returns: 		
+*		state of the flags before they have been cleared
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_clear(EventGroup* group, uint32_t flags) {
+	
+	uint32_t state;
+	TEST_NULL_POINTER(group)
+	
+	// Repeat if an exception (possibly setting flags) has been taken in the meantime
+	do {
+		state = __ldrex(&group->flags);
+	} while (__strex(state & ~flags, &group->flags));
+	return state;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_get
+* Purpose:    	Get the current state of the flags
+* Arguments:	
+* 		group - event group to read
+* Returns: 		
+*		state of the flags
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_get(const EventGroup* group) {
+	
+	TEST_NULL_POINTER(group)
+	return group->flags;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_wait
+* Purpose:    	Wait until any or all (EVENT_WAIT_ALL) of the flags given are set
+* Arguments:	
+* 		group - event group to wait on
+*		flags - flags to wait for
+*		options - EVENT_WAIT_ANY/EVENT_WAIT_ALL, optionally with EVENT_CLEAR_ON_EXIT
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		state of the flags which satisfied the wait (before clearing), 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_event_group_wait(EventGroup* group, uint32_t flags, uint8_t options,
+								 uint32_t timeout) {
+
+	uint32_t state;
+	TEST_NULL_POINTER(group)
+
+	// Check the flags in thread mode. Enter the kernel only if the task has to wait.
+	do {
+		state = __ldrex(&group->flags);
+		if (!event_group_is_satisfied(state, flags, options)) {
+			__clrex();
+			return KrisOS_event_group_wait_slow(group, flags, options, timeout);
+		}
+		if (!(options & EVENT_CLEAR_ON_EXIT)) {
+			__clrex();
+			return state;
+		}
+	} while (__strex(state & ~flags, &group->flags));
+	return state;
+}
+
+
+
+#endif
@@ -0,0 +1,97 @@
+/*******************************************************************************
+* File:     	eventgroup.h
+* Brief:    	Header file for eventgroup.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_EVENT_GROUP
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_init
+* Purpose:    	Initialise the event flag group given, with all flags cleared
+* Arguments:	
+* 		toInit - event group to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t event_group_init(EventGroup* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_create
+* Purpose:    	Create an event flag group using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the event group created
+--------------------------------------------------------------------------------*/
+EventGroup* event_group_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_delete
+* Purpose:    	Delete the event flag group given
+* Arguments:	
+* 		toDelete - event group to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if tasks are waiting on the group
+--------------------------------------------------------------------------------*/
+uint32_t event_group_delete(EventGroup* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_set
+* Purpose:    	Set the flags given and wake all the tasks whose wait is now
+*				satisfied
+* Arguments:	
+* 		group - event group to update
+*		flags - flags to set
+* Returns: 		
+*		state of the flags after the tasks woken have cleared theirs
+--------------------------------------------------------------------------------*/
+uint32_t event_group_set(EventGroup* group, uint32_t flags);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	event_group_wait
+* Purpose:    	Wait until any or all (EVENT_WAIT_ALL) of the flags given are set
+* Arguments:	
+* 		group - event group to wait on
+*		flags - flags to wait for
+*		options - EVENT_WAIT_ANY/EVENT_WAIT_ALL, optionally with EVENT_CLEAR_ON_EXIT
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		state of the flags which satisfied the wait. If the task has to wait, the
+*		value is returned by the task setting the flags (0 on timeout).
+--------------------------------------------------------------------------------*/
+uint32_t event_group_wait(EventGroup* group, uint32_t flags, uint8_t options, uint32_t timeout);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_event_group_wait_slow
+* Purpose:    	Wait for the flags given inside the kernel. SVC call.
+* Arguments:	
+* 		group - event group to wait on
+*		flags - flags to wait for
+*		options - EVENT_WAIT_ANY/EVENT_WAIT_ALL, optionally with EVENT_CLEAR_ON_EXIT
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		state of the flags which satisfied the wait (before clearing), 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_EVENT_GROUP_WAIT) KrisOS_event_group_wait_slow(EventGroup* group, uint32_t flags,
+																   uint8_t options, uint32_t timeout);
+
+#endif
@@ -0,0 +1,472 @@
+/*******************************************************************************
+* File:     	hrtimer.c
+* Brief:    	Microsecond-resolution hardware timer service implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	The finest delay the OS 'ticks' give is one OS clock period. This service
+*	multiplexes one 32/64-bit wide general-purpose timer (WTIMER0, timer A) into 
+*	many one-shot events with microsecond resolution. The timer counts up at the
+*	system clock frequency and is never stopped or reloaded, so it is a 32-bit 
+*	time base which wraps like the OS 'ticks' counter does and is compared with
+*	TIME_BEFORE. The pending events are kept in a binary min-heap of deadlines
+*	(at most HR_TIMER_CAPACITY of them), so starting and cancelling an event take 
+*	O(log n) time and the earliest deadline is always at the root. The match 
+*	register of the timer is set to the earliest deadline only, so there is 
+*	a single interrupt per expiry, however many events are pending.
+*
+*	The callbacks run inside the timer interrupt handler, at MAX_SYSCALL_PRIORITY,
+*	so they can use the KrisOS *_ISR functions. KrisOS_task_sleep_us blocks the 
+*	calling task on an event allocated on the task's own stack, which the callback
+*	wakes up.
+*
+*	Delays too short for an interrupt are spun. The spin loop is calibrated once
+*	against the DWT cycle counter, so that KrisOS_udelay and KrisOS_ndelay don't
+*	access any (privileged) registers and can be used by unprivileged tasks.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_HR_TIMER
+/*-------------------------------------------------------------------------------
+* Interrupt request and priority of the hardware timer used
+--------------------------------------------------------------------------------*/
+#define HR_TIMER_IRQ WTIMER0A_IRQn
+#define HR_TIMER_IRQ_PRIO MAX_SYSCALL_PRIORITY
+
+
+
+/*-------------------------------------------------------------------------------
+* Number of timer counts within which a deadline is treated as already reached
+* when the match register is set (the match would be missed otherwise)
+--------------------------------------------------------------------------------*/
+#define HR_TIMER_MARGIN 32
+
+
+
+/*-------------------------------------------------------------------------------
+* Number of spin loop iterations timed by the calibration
+--------------------------------------------------------------------------------*/
+#define HR_CALIBRATION_LOOPS 1024
+
+
+
+/*-------------------------------------------------------------------------------
+* Deadline min-heap, number of timer counts per microsecond and spin loop 
+* iterations per microsecond (16.16 fixed point)
+--------------------------------------------------------------------------------*/
+static HrTimer* deadlineHeap[HR_TIMER_CAPACITY];
+static uint32_t heapSize;
+static uint32_t countsPerUs;
+static uint32_t spinLoopsPerUs;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_spin
+* Purpose:    	Busy-wait for the number of loop iterations given
+* Arguments:	
+* 		loops - number of loop iterations
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_spin(uint32_t loops) {
+	
+	volatile uint32_t counter = loops;
+	while (counter != 0)
+		counter--;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_heap_place
+* Purpose:    	Put the event given at the heap position given
+* Arguments:	
+* 		toPlace - event to place
+*		index - heap position
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_heap_place(HrTimer* toPlace, uint32_t index) {
+	deadlineHeap[index] = toPlace;
+	toPlace->heapIndex = index;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_heap_sift
+* Purpose:    	Move the event given up or down the heap, starting at the position
+*				given, until the heap order is restored
+* Arguments:	
+* 		toSift - event to move
+*		index - starting heap position (free)
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_heap_sift(HrTimer* toSift, uint32_t index) {
+	
+	uint32_t child;
+	
+	// Move the event towards the root while its deadline is earlier than its 
+	// parent's
+	while (index > 0 && TIME_BEFORE(toSift->deadline, 
+									deadlineHeap[(index - 1) >> 1]->deadline)) {
+		hrtimer_heap_place(deadlineHeap[(index - 1) >> 1], index);
+		index = (index - 1) >> 1;
+	}
+	
+	// Move the event towards the leaves while a child's deadline is earlier 
+	while ((child = (index << 1) + 1) < heapSize) {
+		if (child + 1 < heapSize && 
+			TIME_BEFORE(deadlineHeap[child + 1]->deadline, deadlineHeap[child]->deadline))
+			child++;
+		if (!TIME_BEFORE(deadlineHeap[child]->deadline, toSift->deadline))
+			break;
+		hrtimer_heap_place(deadlineHeap[child], index);
+		index = child;
+	}
+	hrtimer_heap_place(toSift, index);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_heap_remove
+* Purpose:    	Take the event given off the heap
+* Arguments:	
+* 		toRemove - pending event to remove
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_heap_remove(HrTimer* toRemove) {
+	
+	uint32_t index = toRemove->heapIndex;
+	
+	// Fill the gap with the last event of the heap
+	toRemove->heapIndex = HR_TIMER_INACTIVE;
+	if (--heapSize != index)
+		hrtimer_heap_sift(deadlineHeap[heapSize], index);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_arm
+* Purpose:    	Set the timer match to the earliest deadline. If the deadline is 
+*				(almost) reached, the interrupt is requested straight away.
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_arm(void) {
+	
+	if (heapSize == 0)
+		return;
+	WTIMER0->TAMATCHR = deadlineHeap[0]->deadline;
+	if (!TIME_BEFORE(WTIMER0->TAV + HR_TIMER_MARGIN, deadlineHeap[0]->deadline))
+		nvic_set_pending(HR_TIMER_IRQ);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_wake_task
+* Purpose:    	Callback of the events used by KrisOS_task_sleep_us. Wakes the
+*				task stored in the event.
+* Arguments:	
+* 		expired - event which has expired
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void hrtimer_wake_task(HrTimer* expired) {
+	
+	__start_critical();
+	{
+		task_wake((Task*) expired->context);
+		scheduler_run();
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_init
+* Purpose:    	Start the free-running hardware timer used as the high-resolution
+*				time base and calibrate the busy-wait loop against the CPU cycle 
+*				counter
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void hrtimer_init(void) {
+	
+	uint32_t start;
+	uint32_t cycles;
+	
+	heapSize = 0;
+	countsPerUs = SYSTEM_CLOCK_FREQ / 1000000;
+	
+	// Time the spin loop (the interrupts are disabled during the OS setup). The
+	// call overhead is spread over all the loop iterations.
+	start = DWT->CYCCNT;
+	hrtimer_spin(HR_CALIBRATION_LOOPS);
+	cycles = DWT->CYCCNT - start;
+	spinLoopsPerUs = (uint32_t) (((uint64_t) countsPerUs * HR_CALIBRATION_LOOPS << 16) 
+								 / cycles);
+	
+	// Enable the clock of the wide timer 0 and wait until it is ready
+	SYSCTL->RCGCWTIMER |= 1 << RCGC_WTIMER0;
+	while ((SYSCTL->PRWTIMER & (1 << RCGC_WTIMER0)) == 0);
+	
+	// Configure timer A as a 32-bit periodic timer counting up over its full 
+	// range, with the match interrupt enabled. The timer stalls together with
+	// the CPU when debugging.
+	WTIMER0->CTL = 0;
+	WTIMER0->CFG = GPTMCFG_32BIT;
+	WTIMER0->TAMR = (TAMR_PERIODIC << TAMR_TAMR) | (1 << TAMR_TACDIR) | 
+					(1 << TAMR_TAMIE);
+	WTIMER0->TAILR = 0xFFFFFFFF;
+	WTIMER0->TAMATCHR = 0xFFFFFFFF;
+	WTIMER0->ICR = 1 << GPTMINT_TAM;
+	WTIMER0->IMR = 1 << GPTMINT_TAM;
+	WTIMER0->CTL = (1 << GPTMCTL_TAEN) | (1 << GPTMCTL_TASTALL);
+	
+	// The callbacks use the kernel, so the interrupt has the priority of 
+	// the OS timer interrupt
+	nvic_set_priority(HR_TIMER_IRQ, HR_TIMER_IRQ_PRIO);
+	nvic_enable_irq(HR_TIMER_IRQ);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_start
+* Purpose:    	Start the high-resolution timer event given. A pending event is
+*				restarted.
+* Arguments:	
+* 		toStart - event to start
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+*		callback - function run when the event expires
+*		context - user data stored in the event
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_start(HrTimer* toStart, uint32_t delayUs, HrTimerCallback callback, 
+					   void* context) {
+	
+	uint32_t exitStatus = EXIT_SUCCESS;
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toStart)
+	TEST_NULL_POINTER(callback)
+	if (delayUs > HR_TIMER_MAX_DELAY_US)
+		return EXIT_FAILURE;
+	
+	__start_critical();
+	{
+		// Restart the event if it is pending, otherwise check if there is room
+		// for it in the heap
+		if (toStart->heapIndex < heapSize && deadlineHeap[toStart->heapIndex] == toStart)
+			hrtimer_heap_remove(toStart);
+		if (heapSize == HR_TIMER_CAPACITY) {
+			toStart->heapIndex = HR_TIMER_INACTIVE;
+			exitStatus = EXIT_FAILURE;
+		}
+		else {
+			toStart->deadline = WTIMER0->TAV + delayUs * countsPerUs;
+			toStart->callback = callback;
+			toStart->context = context;
+			heapSize++;
+			hrtimer_heap_sift(toStart, heapSize - 1);
+			
+			// Move the match if the event has the earliest deadline now
+			if (deadlineHeap[0] == toStart)
+				hrtimer_arm();
+		}
+	}
+	__end_critical();
+	return exitStatus;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_cancel
+* Purpose:    	Cancel the high-resolution timer event given (if it is pending)
+* Arguments:	
+* 		toCancel - event to cancel
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_cancel(HrTimer* toCancel) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toCancel)
+	
+	// The match isn't moved if the earliest event is cancelled. The interrupt
+	// then finds nothing to expire and sets the match to the next deadline.
+	__start_critical();
+	{
+		if (toCancel->heapIndex < heapSize && deadlineHeap[toCancel->heapIndex] == toCancel)
+			hrtimer_heap_remove(toCancel);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_sleep
+* Purpose:    	Block the calling task until the high-resolution timer event given
+*				expires
+* Arguments:	
+* 		toWait - event used for the wake-up (owned by the calling task)
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_sleep(HrTimer* toWait, uint32_t delayUs) {
+	
+	uint32_t exitStatus;
+	
+	// The event can't expire before the task is blocked, as the timer interrupt
+	// is masked by the critical section
+	__start_critical();
+	{
+		exitStatus = hrtimer_start(toWait, delayUs, hrtimer_wake_task, scheduler.runPtr);
+		if (exitStatus == EXIT_SUCCESS)
+			task_wait(NULL, toWait, SLEEPING, TIME_INFINITY);
+	}
+	__end_critical();
+	return exitStatus;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_start_ISR
+* Purpose:    	Start the high-resolution timer event given inside an interrupt 
+*				service routine
+* Arguments:	
+* 		toStart - event to start
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+*		callback - function run when the event expires
+*		context - user data stored in the event
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_hrtimer_start_ISR(HrTimer* toStart, uint32_t delayUs, 
+								  HrTimerCallback callback, void* context) {
+	TEST_ISR_PRIORITY
+	return hrtimer_start(toStart, delayUs, callback, context);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_cancel_ISR
+* Purpose:    	Cancel the high-resolution timer event given inside an interrupt
+*				service routine
+* Arguments:	
+* 		toCancel - event to cancel
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_hrtimer_cancel_ISR(HrTimer* toCancel) {
+	TEST_ISR_PRIORITY
+	return hrtimer_cancel(toCancel);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_task_sleep_us
+* Purpose:    	Suspend the execution of the calling task for the number of 
+*				microseconds given. Sleeps shorter than HR_SLEEP_SPIN_US are spun.
+* Arguments:	
+* 		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_task_sleep_us(uint32_t delayUs) {
+	
+	// Event on the task's own stack. It stays valid while the task is blocked.
+	HrTimer wakeUp;
+	
+	if (delayUs < HR_SLEEP_SPIN_US) {
+		KrisOS_udelay(delayUs);
+		return EXIT_SUCCESS;
+	}
+	wakeUp.heapIndex = HR_TIMER_INACTIVE;
+	return KrisOS_hrtimer_sleep_slow(&wakeUp, delayUs);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_udelay
+* Purpose:    	Busy-wait for the number of microseconds given. Can be used by
+*				tasks and interrupt handlers. The delay is a lower bound (the 
+*				caller can be preempted).
+* Arguments:	
+* 		delayUs - delay in microseconds
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_udelay(uint32_t delayUs) {
+	hrtimer_spin((uint32_t) (((uint64_t) delayUs * spinLoopsPerUs + 0xFFFF) >> 16));
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_ndelay
+* Purpose:    	Busy-wait for the number of nanoseconds given (rounded up to the 
+*				length of one spin loop iteration)
+* Arguments:	
+* 		delayNs - delay in nanoseconds
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_ndelay(uint32_t delayNs) {
+	hrtimer_spin((uint32_t) (((uint64_t) delayNs * spinLoopsPerUs + (1000 << 16) - 1) 
+							 / (1000 << 16)));
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	WTIMER0A_Handler
+* Purpose:    	High-resolution timer interrupt handler. Runs the callbacks of all
+*				the events whose deadline has been reached and sets the match to
+*				the next deadline.
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void WTIMER0A_Handler(void) {
+	
+	HrTimer* expired;
+	
+	WTIMER0->ICR = 1 << GPTMINT_TAM;
+	
+	// The interrupt may be spurious (e.g. the earliest event has been cancelled),
+	// so the deadlines are checked against the current timer value
+	__start_critical();
+	{
+		while (heapSize > 0 && !TIME_BEFORE(WTIMER0->TAV, deadlineHeap[0]->deadline)) {
+			expired = deadlineHeap[0];
+			hrtimer_heap_remove(expired);
+			
+			// Record how late the event has been handled (in timer counts)
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				if (WTIMER0->TAV - expired->deadline > KrisOS.hrTimerMaxLateness)
+					KrisOS.hrTimerMaxLateness = WTIMER0->TAV - expired->deadline;
+			#endif
+			expired->callback(expired);
+		}
+		hrtimer_arm();
+	}
+	__end_critical();
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* File:     	hrtimer.h
+* Brief:    	Header file for hrtimer.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_HR_TIMER
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_init
+* Purpose:    	Start the free-running hardware timer used as the high-resolution
+*				time base and calibrate the busy-wait loop against the CPU cycle 
+*				counter
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void hrtimer_init(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_start
+* Purpose:    	Start the high-resolution timer event given. A pending event is
+*				restarted.
+* Arguments:	
+* 		toStart - event to start
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+*		callback - function run when the event expires
+*		context - user data stored in the event
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_start(HrTimer* toStart, uint32_t delayUs, HrTimerCallback callback, 
+					   void* context);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_cancel
+* Purpose:    	Cancel the high-resolution timer event given (if it is pending)
+* Arguments:	
+* 		toCancel - event to cancel
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_cancel(HrTimer* toCancel);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	hrtimer_sleep
+* Purpose:    	Block the calling task until the high-resolution timer event given
+*				expires
+* Arguments:	
+* 		toWait - event used for the wake-up (owned by the calling task)
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t hrtimer_sleep(HrTimer* toWait, uint32_t delayUs);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_hrtimer_sleep_slow
+* Purpose:    	Block the calling task on the high-resolution timer event given 
+*				inside the kernel. SVC call.
+* Arguments:	
+* 		toWait - event used for the wake-up (owned by the calling task)
+*		delayUs - delay in microseconds (at most HR_TIMER_MAX_DELAY_US)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_HRTIMER_SLEEP) KrisOS_hrtimer_sleep_slow(HrTimer* toWait, uint32_t delayUs);
+
+#endif
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	29/12/2016
-* Last mod: 	13/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -14,4 +14,17 @@
 #include "os.h"
 #include "semaphore.h"
 #include "queue.h"
+#include "pqueue.h"
+#include "mailbox.h"
+#include "topic.h"
+#include "rwlock.h"
+#include "eventgroup.h"
+#include "notify.h"
+#include "condvar.h"
+#include "barrier.h"
+#include "softtimer.h"
+#include "hrtimer.h"
+#include "workqueue.h"
+#include "basictask.h"
+#include "coroutine.h"
 #include "assertions.h"
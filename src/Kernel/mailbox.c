@@ -0,0 +1,190 @@
+/*******************************************************************************
+* File:     	mailbox.c
+* Brief:    	Latest-value mailbox implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	A mailbox holds a single item - the most recent value written to it. Writing
+*	overwrites the previous value, reading doesn't remove it. This is a better 
+*	fit than a queue for sharing the current state of something (temperature, 
+*	light level...) with several tasks: with a queue the readers would consume 
+*	each other's data, with a mutex the readers and writers would block each 
+*	other.
+*
+*	The item is protected by a sequence lock. Writers (tasks via SVC call or 
+*	interrupt handlers via KrisOS_mailbox_write_ISR) copy the new value inside 
+*	a short critical section and never block. Readers copy the value without
+*	entering the kernel or masking interrupts, retrying if a writer updated 
+*	the mailbox in the middle of the copy. Many readers can sample the mailbox
+*	at the same time.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_MAILBOX
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_init
+* Purpose:    	Initialise the mailbox given
+* Arguments:	
+* 		toInit - mailbox to initialise
+*		bufferMemory - memory area to store the item in
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_init(Mailbox* toInit, void* bufferMemory, size_t itemSize) {
+	
+	// Validate the input parameters
+	TEST_NULL_POINTER(toInit)
+	TEST_NULL_POINTER(bufferMemory)
+	TEST_INVALID_SIZE(itemSize)
+	
+	// The mailbox is empty until the first write (sequence number 0)
+	KrisOS_seqlock_init(&toInit->lock);
+	toInit->buffer = bufferMemory;
+	toInit->itemSize = itemSize;
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		toInit->readRetries = 0;
+	#endif
+	
+	// Update the total number of mailboxes declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalMailboxNo++;
+	#endif	
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_create
+* Purpose:    	Create and initialise a mailbox using dynamic memory allocation
+* Arguments:	
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		pointer to the mailbox created
+--------------------------------------------------------------------------------*/
+Mailbox* mailbox_create(size_t itemSize) {
+	
+	Mailbox* mailboxCreated;
+	
+	// Validate the input parameters
+	TEST_INVALID_SIZE(itemSize)
+	
+	// Allocate memory for both the Mailbox struct and the item
+	mailboxCreated = malloc(sizeof(Mailbox));
+	mailbox_init(mailboxCreated, malloc(itemSize), itemSize);
+	return mailboxCreated;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_delete
+* Purpose:    	Delete the mailbox given
+* Arguments:	
+* 		toDelete - mailbox to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_delete(Mailbox* toDelete) {
+	
+	TEST_NULL_POINTER(toDelete)
+	
+	// Nobody waits on a mailbox so it can always be removed
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalMailboxNo--;
+	#endif
+	free(toDelete->buffer);
+	free(toDelete);
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_write
+* Purpose:    	Overwrite the item stored in the mailbox
+* Arguments:	
+* 		toWrite - mailbox to write to
+*		item - pointer to the new value
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_write(Mailbox* toWrite, const void* item) {
+	
+	TEST_NULL_POINTER(toWrite)
+	TEST_NULL_POINTER(item)
+	
+	// Writers can't interleave, so the update is done inside a critical section.
+	// Readers will notice the sequence number change and retry.
+	__start_critical();
+	{
+		KrisOS_seqlock_write_begin(&toWrite->lock);
+		memcpy(toWrite->buffer, item, toWrite->itemSize);
+		KrisOS_seqlock_write_end(&toWrite->lock);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_write_ISR
+* Purpose:    	Overwrite the item stored in the mailbox from inside an interrupt
+*				service routine
+* Arguments:	
+* 		toWrite - mailbox to write to
+*		item - pointer to the new value
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mailbox_write_ISR(Mailbox* toWrite, const void* item) {
+	TEST_ISR_PRIORITY
+	return mailbox_write(toWrite, item);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mailbox_read
+* Purpose:    	Copy the most recent item from the mailbox. Doesn't block, doesn't
+*				enter the kernel and doesn't mask interrupts.
+* Arguments:	
+* 		toRead - mailbox to read from
+*		item - where to copy the item to
+* Returns: 		
+*		exit status. EXIT_FAILURE if nothing has been written to the mailbox yet
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mailbox_read(Mailbox* toRead, void* item) {
+	
+	uint32_t sequence;
+	
+	TEST_NULL_POINTER(toRead)
+	TEST_NULL_POINTER(item)
+	
+	// Copy the item and repeat if a writer updated it in the meantime
+	while (1) {
+		sequence = KrisOS_seqlock_read_begin(&toRead->lock);
+		if (sequence == 0) 
+			return EXIT_FAILURE;
+		memcpy(item, toRead->buffer, toRead->itemSize);
+		if (!KrisOS_seqlock_read_retry(&toRead->lock, sequence))
+			return EXIT_SUCCESS;
+		
+		// The count is kept in the mailbox, which the reader can write to (unlike
+		// the kernel statistics). Concurrent readers may lose an increment.
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			toRead->readRetries++;
+		#endif
+	}
+}
+#endif
@@ -0,0 +1,67 @@
+/*******************************************************************************
+* File:     	mailbox.h
+* Brief:    	Header file for mailbox.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_MAILBOX
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_init
+* Purpose:    	Initialise the mailbox given
+* Arguments:	
+* 		toInit - mailbox to initialise
+*		bufferMemory - memory area to store the item in
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_init(Mailbox* toInit, void* bufferMemory, size_t itemSize);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_create
+* Purpose:    	Create and initialise a mailbox using dynamic memory allocation
+* Arguments:	
+*		itemSize - size of the item (in bytes)
+* Returns: 		
+*		pointer to the mailbox created
+--------------------------------------------------------------------------------*/
+Mailbox* mailbox_create(size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_delete
+* Purpose:    	Delete the mailbox given
+* Arguments:	
+* 		toDelete - mailbox to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_delete(Mailbox* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mailbox_write
+* Purpose:    	Overwrite the item stored in the mailbox
+* Arguments:	
+* 		toWrite - mailbox to write to
+*		item - pointer to the new value
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mailbox_write(Mailbox* toWrite, const void* item);
+
+#endif
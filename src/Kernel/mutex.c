@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	21/12/2016
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	Mutual exclusion locks are used for preventing simultanous access of more than
@@ -25,8 +25,37 @@
 *
 *	Recursive mutex locking is not supported but if a task requesting a lock, already
 *	owns the mutex specified then, no error condition is trigerred.
-*	The mutex waiting queue is arranged in descending priority order. Deadlocks
-*	are avoided by not allowing the same task to own two or more different mutexes.
+*	The mutex waiting queue is arranged in descending priority order, so its head
+*	is the highest-priority waiter. A task can own several mutexes at once, they
+*	are linked in the task's list of mutexes held. On unlock, the owner's priority
+*	is recomputed as the most urgent of its base priority and the priorities 
+*	required by the mutexes it still holds. The chain of 'waiting-for' 
+*	dependencies walked by the inheritance algorithm is at most 
+*	MTX_INHERIT_MAX_DEPTH tasks long, which bounds the time spent in the critical
+*	section and stops the walk from looping if the tasks have deadlocked. The
+*	deepest chain seen is reported by the stats task. Mutexes which are always
+*	taken in the same order can't deadlock.
+*
+*	Mutexes initialised with a ceiling priority use the immediate priority ceiling
+*	protocol instead. Locking one raises the owner to the ceiling straight away,
+*	so no task which could ask for the same mutex can preempt the owner and the
+*	chain of 'waiting-for' dependencies is never walked. The ceiling has to be 
+*	at least as urgent as the base priority of every task using the mutex, so
+*	a task can own any number of ceiling mutexes without the risk of a deadlock.
+*	Ceiling mutexes stay locked while the owner sleeps (the other mutexes held are
+*	released), but all mutexes are released when the owner is deleted.
+*
+*	The user API (KrisOS_mutex_*) doesn't trap into the kernel if the mutex is 
+*	free on lock, or has never been waited for on unlock. Only the owner field is
+*	then updated in thread mode with exclusive load/store (LDREX/STREX). Any 
+*	exception taken in between clears the exclusive monitor, so the store fails 
+*	if the kernel could have touched the mutex in the meantime and the check is 
+*	repeated. The kernel links a mutex taken this way into the owner's list of 
+*	mutexes held only once another task waits for it, and from then on the 
+*	mutex is unlocked (taken off the list, owner's priority recomputed) by the 
+*	SVC call (KrisOS_mutex_*_slow). So, a task has to unlock the mutexes it 
+*	took without contention before it sleeps or deletes itself, the kernel only
+*	releases the mutexes it knows of.
 *******************************************************************************/
 #include "kernel.h"
 #include "system.h"
@@ -49,16 +78,64 @@ uint32_t mutex_init(Mutex* toInit) {
 	
 	// Set the initial values of member variables of the mutex to initialise
 	toInit->owner = toInit->waitingQueue = NULL;
+	toInit->ceiling = MTX_NO_CEILING;
+	toInit->listed = 0;
+	toInit->nextHeld = NULL;
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		toInit->maxLockTime = 0;
+	#endif
 	
 	// Update the total number of mutexes declared
 	#ifdef SHOW_DIAGNOSTIC_DATA
 		KrisOS.totalMutexNo++;
 	#endif	
+	kernel_info_count(&kernelInfo.mutexNo, 1);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_init_ceiling
+* Purpose:    	Initialise the mutex given to use the priority ceiling protocol
+* Arguments:	
+* 		toInit - mutex to initialise
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mutex_init_ceiling(Mutex* toInit, uint8_t ceiling) {
+	
+	// Initialise the mutex as usual and then set its ceiling
+	if (mutex_init(toInit) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+	toInit->ceiling = ceiling;
 	return EXIT_SUCCESS;
 }
 
 
 
+#ifdef SHOW_DIAGNOSTIC_DATA
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_collect_lock_time
+* Purpose:    	Fold the longest lock time recorded by the mutex given into the 
+*				maximum mutex lock-time statistic. The thread-mode unlock only 
+*				updates the mutex, the kernel statistic is updated here whenever
+*				the mutex goes through the kernel.
+* Arguments:	
+*		toCollect - mutex whose lock time to collect
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void mutex_collect_lock_time(Mutex* toCollect) {
+	
+	if (toCollect->maxLockTime > KrisOS.maxMtxCriticalSection)
+		KrisOS.maxMtxCriticalSection = toCollect->maxLockTime;
+	toCollect->maxLockTime = 0;
+}
+#endif
+
+
+
 #ifdef USE_HEAP
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_create
@@ -77,6 +154,24 @@ Mutex* mutex_create(void) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_create_ceiling
+* Purpose:    	Create a priority ceiling mutex using dynamic memory allocation.
+* Arguments:	
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		Pointer to the mutex created
+--------------------------------------------------------------------------------*/
+Mutex* mutex_create_ceiling(uint8_t ceiling) {
+	
+	// Allocate memory for a new mutex and initialise it
+	Mutex* toCreate = malloc(sizeof(Mutex));
+	mutex_init_ceiling(toCreate, ceiling);	
+	return toCreate;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_delete
 * Purpose:    	Delete the mutex specified 
@@ -98,10 +193,13 @@ uint32_t mutex_delete(Mutex* toDelete) {
 			return EXIT_FAILURE;
 		}
 		
-		// Update the total number of mutexes declared		
+		// Update the total number of mutexes declared and keep the lock time 
+		// recorded by the mutex
 		#ifdef SHOW_DIAGNOSTIC_DATA
 			KrisOS.totalMutexNo--;	
+			mutex_collect_lock_time(toDelete);
 		#endif		
+		kernel_info_count(&kernelInfo.mutexNo, -1);
 		
 		// Release the heap memory this mutex occupies (if allocated dynamically)
 		#ifdef USE_HEAP
@@ -115,6 +213,130 @@ uint32_t mutex_delete(Mutex* toDelete) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_required_prio
+* Purpose:    	Get the priority the owner of the mutex given has to run at, for
+*				the sake of this mutex only
+* Arguments:	
+*		held - mutex to check
+* Returns: 		
+*		the ceiling of a priority ceiling mutex, the priority of the highest-
+*		priority waiter of an inheritance mutex, MTX_NO_CEILING if there is none
+--------------------------------------------------------------------------------*/
+static uint8_t mutex_required_prio(Mutex* held) {
+	
+	if (held->ceiling != MTX_NO_CEILING)
+		return held->ceiling;
+	return held->waitingQueue != NULL ? held->waitingQueue->priority : MTX_NO_CEILING;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_owner_prio
+* Purpose:    	Compute the priority the task given should run at, given the 
+*				mutexes it holds
+* Arguments:	
+*		owner - task to compute the priority for
+* Returns: 		
+*		the most urgent of the task's base priority and the priorities required
+*		by the mutexes it holds
+--------------------------------------------------------------------------------*/
+static uint8_t mutex_owner_prio(Task* owner) {
+	
+	uint8_t priority = owner->basePrio;
+	Mutex* iterator;
+	
+	for (iterator = owner->mutexHeld; iterator != NULL; iterator = iterator->nextHeld) {
+		if (mutex_required_prio(iterator) < priority)
+			priority = mutex_required_prio(iterator);
+	}
+	return priority;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_hold
+* Purpose:    	Add the mutex given to the list of mutexes held by the task given.
+*				Nothing happens if the mutex is already on the list.
+* Arguments:	
+*		owner - new owner of the mutex
+*		held - mutex taken
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void mutex_hold(Task* owner, Mutex* held) {
+	
+	if (held->listed)
+		return;
+	
+	// The mutex is linked before it becomes the list head, so that the list is
+	// consistent at any time for the kernel code which could preempt the owner
+	held->nextHeld = owner->mutexHeld;
+	owner->mutexHeld = held;
+	held->listed = 1;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_drop
+* Purpose:    	Remove the mutex given from the list of mutexes held by the task
+*				given. Nothing happens if the mutex isn't on the list.
+* Arguments:	
+*		owner - owner of the mutex
+*		released - mutex to remove
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void mutex_drop(Task* owner, Mutex* released) {
+	
+	Mutex** iterator = &owner->mutexHeld;
+	
+	while (*iterator != NULL && *iterator != released)
+		iterator = &(*iterator)->nextHeld;
+	if (*iterator != NULL)
+		*iterator = released->nextHeld;
+	released->listed = 0;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_inherit
+* Purpose:    	Priority inheritance algorithm. Boost the owner of the mutex given
+*				and the chain of tasks it depends on to the priority given.
+* Arguments:	
+*		waitedOn - mutex a task of the priority given waits for
+*		priority - priority of the waiting task
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void mutex_inherit(Mutex* waitedOn, uint8_t priority) {
+	
+	// Iterator through the chain of 'waiting-for' dependencies and the number 
+	// of tasks boosted so far
+	Task* iterator = waitedOn->owner;
+	uint32_t depth = 0;
+	
+	// Iterate until the last task in the chain of dependencies is found, which needs
+	// to have its priority temporarily boosted in order to avoid priority inversion.
+	// Each task boosted is re-inserted into the queue it is in (ready queue or
+	// the waiting queue of the semaphore/mutex). If it waits for another mutex, 
+	// the owner of that mutex is boosted next.
+	while (iterator != NULL && iterator->priority > priority && depth < MTX_INHERIT_MAX_DEPTH) {
+		task_set_priority(iterator, priority);
+		depth++;
+		iterator = iterator->status == MTX_WAIT ? ((Mutex*) iterator->waitingObj)->owner : NULL;
+	}
+	
+	// Record the longest chain of dependencies walked
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		if (depth > KrisOS.maxInheritDepth)
+			KrisOS.maxInheritDepth = depth;
+	#endif
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_try_lock
 * Purpose:    	Attempt to lock the mutex specified. Don't wait if the mutex is 
@@ -131,13 +353,19 @@ uint32_t mutex_try_lock(Mutex* toLock) {
 	// Validate the input argument
 	TEST_NULL_POINTER(toLock)
 	
+	// Tasks more urgent than the ceiling aren't allowed to use the mutex
+	if (toLock->ceiling != MTX_NO_CEILING && scheduler.runPtr->basePrio < toLock->ceiling)
+		return EXIT_FAILURE;
+	
 	__start_critical();
 	{
 		// The mutex specified is free to be locked. Link the task and the mutex
-		// together
-		if (toLock->owner == NULL && scheduler.runPtr->mutexHeld == NULL) {
+		// together. A ceiling mutex also raises the task to the ceiling priority.
+		if (toLock->owner == NULL) {
 			toLock->owner = scheduler.runPtr;
-			scheduler.runPtr->mutexHeld = toLock;
+			mutex_hold(scheduler.runPtr, toLock);
+			if (toLock->ceiling < scheduler.runPtr->priority)
+				task_set_priority(scheduler.runPtr, toLock->ceiling);
 			exitStatus = EXIT_SUCCESS;
 			
 			// Record the time the mutex has been taken. Later, the mutex release
@@ -168,69 +396,64 @@ uint32_t mutex_try_lock(Mutex* toLock) {
 *		exit status
 --------------------------------------------------------------------------------*/
 uint32_t mutex_lock(Mutex* toLock) {
+	return mutex_lock_timed(toLock, TIME_INFINITY);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_lock_timed
+* Purpose:    	Take the mutex given. Wait if the mutex is already taken, but for
+*				no longer than the timeout specified.
+* Arguments:	
+*		toLock - mutex to lock
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status. If the timeout expires first, the SVC call returns EXIT_TIMEOUT
+--------------------------------------------------------------------------------*/
+uint32_t mutex_lock_timed(Mutex* toLock, uint32_t timeout) {
 	
-	// Iterator through the chain of 'waiting-for' dependencies inside the priority
-	// inheritance algorithm
-	Task* iterator;
+	// Result of the attempt to lock the mutex without waiting
+	uint32_t lockStatus;
 	
-	// Objects for which the iterator task can be waiting, a semaphore or a mutex
-	Mutex* mutexWaiting;
-	#ifdef USE_SEMAPHORE
-		Semaphore* semWaiting;
+	// Cycle count at the start of the call (lock latency measurement)
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t lockStart = DWT->CYCCNT;
 	#endif
 	
 	// Check if the argument is valid
 	TEST_NULL_POINTER(toLock)
+	
+	// Tasks more urgent than the ceiling aren't allowed to use the mutex
+	if (toLock->ceiling != MTX_NO_CEILING && scheduler.runPtr->basePrio < toLock->ceiling)
+		return EXIT_FAILURE;
 
 	__start_critical();
 	{
-		// If the lock can't be obtained immediately...
-		if (mutex_try_lock(toLock) == EXIT_FAILURE) {
-			
-			// Priority inheritance algorithm:
-			// Iterate until the last task in the chain of dependencies is found, which needs
-			// to have its priority temporarily boosted in order to avoid priority inversion.
-			iterator = toLock->owner;
-			while (iterator->priority > scheduler.runPtr->priority) {
-				iterator->priority = scheduler.runPtr->priority;
-				
-				switch(iterator->status) {
-					
-					// The task owning mutex given is waiting for its turn in the 
-					// ready queue. So re-insert it into ready queue with priority increased
-					case READY: 	
-						task_remove(&scheduler.ready, iterator);
-						task_add(&scheduler.ready, iterator);
-						break;
-					
-					// The task owning mutex is waiting for another mutex
-					case MTX_WAIT:
-						mutexWaiting = iterator->waitingObj;
-						task_remove(&mutexWaiting->waitingQueue, iterator);
-						task_add(&mutexWaiting->waitingQueue, iterator);
-						iterator = mutexWaiting->owner;
-						break;
-					
-					// The task owning mutex is waiting on a semaphore
-					#ifdef USE_SEMAPHORE
-					case SEM_WAIT:
-						semWaiting = iterator->waitingObj;
-						task_remove(&semWaiting->waitingQueue, iterator);
-						task_add(&semWaiting->waitingQueue, iterator);
-						break;
-					#endif
-					
-					default: break;
-				}
-			}
-			// Insert the task into the waiting list for the mutex in descending priority
-			// order
-			task_remove(&scheduler.ready, scheduler.runPtr);
-			scheduler_run();
-			task_add(&toLock->waitingQueue, scheduler.runPtr);
-			scheduler.runPtr->waitingObj = toLock;
-			scheduler.runPtr->status = MTX_WAIT;
+		// If the lock can't be obtained immediately, make sure the mutex is on 
+		// the owner's list (it isn't if taken in thread mode) and, if the mutex 
+		// uses priority inheritance, boost the owner (and the tasks it waits for)
+		lockStatus = mutex_try_lock(toLock);
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			mutex_collect_lock_time(toLock);
+		#endif
+		if (lockStatus == EXIT_FAILURE) {
+			mutex_hold(toLock->owner, toLock);
+			if (toLock->ceiling == MTX_NO_CEILING)
+				mutex_inherit(toLock, scheduler.runPtr->priority);
 		}
+		
+		// Record the time spent in the kernel before the task either owns the mutex 
+		// or blocks. A ceiling mutex never walks the chain of dependencies.
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			cycle_stat_update(toLock->ceiling == MTX_NO_CEILING ? &KrisOS.mutexInheritLock :
+							  &KrisOS.mutexCeilingLock, lockStart);
+		#endif
+		
+		// Insert the task into the waiting list for the mutex in descending priority
+		// order
+		if (lockStatus == EXIT_FAILURE)
+			task_wait(&toLock->waitingQueue, toLock, MTX_WAIT, timeout);
 	}
 	__end_critical();
 	return EXIT_SUCCESS;
@@ -248,39 +471,49 @@ uint32_t mutex_lock(Mutex* toLock) {
 --------------------------------------------------------------------------------*/
 uint32_t mutex_unlock(Mutex* toUnlock) {
 	
+	// Priority the calling task should run at after the unlock
+	uint8_t priority;
+	
 	// Test if the calling task actually owns the mutex 
 	if (toUnlock == NULL || toUnlock->owner != scheduler.runPtr)
 		return EXIT_FAILURE;
 	
 	__start_critical();
 	{
+		// Restoring the priority and handing the mutex over result in one 
+		// scheduling decision
+		scheduler_lock();
+		
 		// Now the calling task no longer owns the mutex
-		scheduler.runPtr->mutexHeld = NULL;
+		mutex_drop(scheduler.runPtr, toUnlock);
 		
 		// Check if the time elapsed from the moment the mutex was locked to the moment
-		// it is released exceeds the current maximum mutex-protected critical 
-		// section length. If so, update the maximum mutex lock-time statistic
+		// it is released exceeds the longest lock time recorded by the mutex and
+		// pass the result on to the maximum mutex lock-time statistic
 		#ifdef SHOW_DIAGNOSTIC_DATA
-			if (KrisOS.ticks - toUnlock->timeTaken > KrisOS.maxMtxCriticalSection)
-				KrisOS.maxMtxCriticalSection = KrisOS.ticks - toUnlock->timeTaken;
+			if (KrisOS.ticks - toUnlock->timeTaken > toUnlock->maxLockTime)
+				toUnlock->maxLockTime = KrisOS.ticks - toUnlock->timeTaken;
+			mutex_collect_lock_time(toUnlock);
 		#endif		
 		
-		// If the running task had it's priority boosted (priority inheritance) then 
-		// re-insert it into the ready queue with its original priority
-		if (scheduler.runPtr->priority != scheduler.runPtr->basePrio) {
-			task_remove(&scheduler.ready, scheduler.runPtr);
-			scheduler.runPtr->priority = scheduler.runPtr->basePrio;
-			task_add(&scheduler.ready, scheduler.runPtr);
+		// If the running task had it's priority boosted (priority inheritance or 
+		// ceiling) then re-insert it into the ready queue with the priority of 
+		// the mutexes it still holds
+		priority = mutex_owner_prio(scheduler.runPtr);
+		if (scheduler.runPtr->priority != priority) {
+			task_set_priority(scheduler.runPtr, priority);
 			scheduler_run();
 		}
 		
-		// If there are tasks waiting on this lock, wake the top priority task 
+		// If there are tasks waiting on this lock, wake the top priority task. It
+		// inherits the priority of the tasks still waiting (or the ceiling).
 		if (toUnlock->waitingQueue != NULL) {
 			toUnlock->owner = toUnlock->waitingQueue;
-			toUnlock->waitingQueue = toUnlock->waitingQueue->next;
-			toUnlock->owner->status = READY;
-			toUnlock->owner->mutexHeld = toUnlock;
-			task_add(&scheduler.ready, toUnlock->owner);
+			task_wake(toUnlock->owner);
+			mutex_hold(toUnlock->owner, toUnlock);
+			priority = mutex_owner_prio(toUnlock->owner);
+			if (toUnlock->owner->priority != priority)
+				task_set_priority(toUnlock->owner, priority);
 			
 			// Record the time the mutex has been taken
 			#ifdef SHOW_DIAGNOSTIC_DATA
@@ -291,8 +524,231 @@ uint32_t mutex_unlock(Mutex* toUnlock) {
 		else {
 			toUnlock->owner = NULL;
 		}
+		scheduler_unlock();
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_requeue
+* Purpose:    	Make the task given, blocked on another object (a condition 
+*				variable), wait for the mutex given instead, or give it the mutex
+*				straight away if it is free. The scheduler has to be run by the caller.
+* Arguments:	
+*		toLock - mutex for the task to take
+*		waiter - blocked task to move
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void mutex_requeue(Mutex* toLock, Task* waiter) {
+	
+	// Priority the task should run at once it owns the mutex
+	uint8_t priority;
+	
+	__start_critical();
+	{
+		// The mutex is free, wake the task up as its new owner
+		if (toLock->owner == NULL) {
+			toLock->owner = waiter;
+			task_wake(waiter);
+			mutex_hold(waiter, toLock);
+			priority = mutex_owner_prio(waiter);
+			if (waiter->priority != priority)
+				task_set_priority(waiter, priority);
+			
+			// Record the time the mutex has been taken
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				toLock->timeTaken = KrisOS.ticks;
+			#endif
+		}
+		
+		// Otherwise move the task to the waiting queue of the mutex without waking 
+		// it up and let the owner inherit its priority, as if the task has called
+		// mutex_lock. The owner wakes it on unlock.
+		else {
+			task_remove(waiter->waitQueue, waiter);
+			waiter->status = MTX_WAIT;
+			waiter->waitingObj = toLock;
+			waiter->waitQueue = &toLock->waitingQueue;
+			task_add(&toLock->waitingQueue, waiter);
+			mutex_hold(toLock->owner, toLock);
+			if (toLock->ceiling == MTX_NO_CEILING)
+				mutex_inherit(toLock, waiter->priority);
+		}
 	}
 	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_update_owner_prio
+* Purpose:    	Recompute the inherited priority of the mutex owner after a task 
+*				has stopped waiting for the mutex (timeout) 
+* Arguments:	
+*		toUpdate - mutex whose owner should have its priority updated
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void mutex_update_owner_prio(Mutex* toUpdate) {
+	
+	// The priority the owner should run at
+	uint8_t priority;
+	
+	__start_critical();
+	{
+		// The owner runs at the priority of the most urgent task still waiting, 
+		// but never below its base priority or the ceilings of the mutexes held
+		priority = mutex_owner_prio(toUpdate->owner);
+		if (priority != toUpdate->owner->priority)
+			task_set_priority(toUpdate->owner, priority);
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_fast_lock
+* Purpose:    	Lock the mutex in thread mode if it's free, without an SVC call
+* Arguments:	
+*		toLock - mutex to lock
+* Returns: 		
+*		exit status. EXIT_FAILURE if the kernel has to be entered
+--------------------------------------------------------------------------------*/
+static uint32_t mutex_fast_lock(Mutex* toLock) {
+	
+	// The calling task
+	Task* self = scheduler.runPtr;
+	
+	// Locking a mutex already owned is not an error
+	if (toLock->owner == self)
+		return EXIT_SUCCESS;
+	
+	// Raising the task to the ceiling priority needs the kernel
+	if (toLock->ceiling != MTX_NO_CEILING)
+		return EXIT_FAILURE;
+	
+	// Claim the mutex only if it is free. Repeat if an exception has been taken
+	// in the meantime.
+	do {
+		if (__ldrex((volatile uint32_t*) &toLock->owner) != (uint32_t) NULL) {
+			__clrex();
+			return EXIT_FAILURE;
+		}
+	} while (__strex((uint32_t) self, (volatile uint32_t*) &toLock->owner));
+	
+	// Record the time the mutex has been taken
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		toLock->timeTaken = KrisOS.ticks;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_try_lock
+* Purpose:    	Attempt to lock the mutex specified. Don't wait if the mutex is 
+*				already owned by some other task. 
+* Arguments:	
+*		toLock - mutex to lock
+* Returns: 		
+*		exit status. EXIT_FAILURE if the mutex can't be locked immediately
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mutex_try_lock(Mutex* toLock) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toLock)
+	
+	// A ceiling mutex can only be taken inside the kernel
+	if (toLock->ceiling != MTX_NO_CEILING)
+		return KrisOS_mutex_try_lock_slow(toLock);
+	return mutex_fast_lock(toLock);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_lock
+* Purpose:    	Take the mutex given. Wait if the mutex is already taken.
+* Arguments:	
+*		toLock - mutex to lock
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mutex_lock(Mutex* toLock) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toLock)
+	
+	// Enter the kernel only if the calling task has to wait
+	if (mutex_fast_lock(toLock) == EXIT_SUCCESS)
+		return EXIT_SUCCESS;
+	return KrisOS_mutex_lock_slow(toLock);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_lock_timed
+* Purpose:    	Take the mutex given. Wait if the mutex is already taken, but for
+*				no longer than the timeout specified.
+* Arguments:	
+*		toLock - mutex to lock
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the mutex hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mutex_lock_timed(Mutex* toLock, uint32_t timeout) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toLock)
+	
+	// Enter the kernel only if the calling task has to wait
+	if (mutex_fast_lock(toLock) == EXIT_SUCCESS)
+		return EXIT_SUCCESS;
+	return KrisOS_mutex_lock_timed_slow(toLock, timeout);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_unlock
+* Purpose:    	Unlock the mutex specified
+* Arguments:	
+*		toUnlock - mutex to unlock
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task doesn't own the mutex specified 
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_mutex_unlock(Mutex* toUnlock) {
+	
+	// The calling task
+	Task* self = scheduler.runPtr;
+	
+	// Test if the calling task actually owns the mutex 
+	if (toUnlock == NULL || toUnlock->owner != self)
+		return EXIT_FAILURE;
+	
+	// Update the longest lock time recorded by the mutex while the calling task
+	// still owns it. The kernel collects it into the statistic later.
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		if (KrisOS.ticks - toUnlock->timeTaken > toUnlock->maxLockTime)
+			toUnlock->maxLockTime = KrisOS.ticks - toUnlock->timeTaken;
+	#endif
+	
+	// Release the mutex in thread mode only if the kernel doesn't know of it.
+	// A mutex on the list of mutexes held (it has been waited for, or is a 
+	// ceiling mutex) is unlocked inside the kernel, which takes it off the list
+	// and restores the priority of the calling task in one go.
+	do {
+		__ldrex((volatile uint32_t*) &toUnlock->owner);
+		if (toUnlock->listed) {
+			__clrex();
+			return KrisOS_mutex_unlock_slow(toUnlock);
+		}
+	} while (__strex((uint32_t) NULL, (volatile uint32_t*) &toUnlock->owner));
 	return EXIT_SUCCESS;
 }
 
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	21/12/2016
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -25,6 +25,19 @@ uint32_t mutex_init(Mutex* toInit);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_init_ceiling
+* Purpose:    	Initialise the mutex given to use the priority ceiling protocol
+* Arguments:	
+* 		toInit - mutex to initialise
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t mutex_init_ceiling(Mutex* toInit, uint8_t ceiling);
+
+
+
 #ifdef USE_HEAP
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_create
@@ -37,6 +50,18 @@ Mutex* mutex_create(void);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_create_ceiling
+* Purpose:    	Create a priority ceiling mutex using dynamic memory allocation.
+* Arguments:	
+*		ceiling - base priority of the most urgent task using the mutex
+* Returns: 		
+*		Pointer to the mutex created
+--------------------------------------------------------------------------------*/
+Mutex* mutex_create_ceiling(uint8_t ceiling);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_delete
 * Purpose:    	Delete the mutex specified 
@@ -75,6 +100,20 @@ uint32_t mutex_lock(Mutex* toLock);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_lock_timed
+* Purpose:    	Take the mutex given. Wait if the mutex is already taken, but for
+*				no longer than the timeout specified.
+* Arguments:	
+*		toLock - mutex to lock
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status. If the timeout expires first, the SVC call returns EXIT_TIMEOUT
+--------------------------------------------------------------------------------*/
+uint32_t mutex_lock_timed(Mutex* toLock, uint32_t timeout);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	mutex_unlock
 * Purpose:    	Unlock the mutex specified
@@ -85,4 +124,83 @@ uint32_t mutex_lock(Mutex* toLock);
 --------------------------------------------------------------------------------*/
 uint32_t mutex_unlock(Mutex* toUnlock);
 
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_requeue
+* Purpose:    	Make the task given, blocked on another object (a condition 
+*				variable), wait for the mutex given instead, or give it the mutex
+*				straight away if it is free. The scheduler has to be run by the caller.
+* Arguments:	
+*		toLock - mutex for the task to take
+*		waiter - blocked task to move
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void mutex_requeue(Mutex* toLock, Task* waiter);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	mutex_update_owner_prio
+* Purpose:    	Recompute the inherited priority of the mutex owner after a task 
+*				has stopped waiting for the mutex (timeout) 
+* Arguments:	
+*		toUpdate - mutex whose owner should have its priority updated
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void mutex_update_owner_prio(Mutex* toUpdate);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_try_lock_slow
+* Purpose:    	Attempt to lock the mutex specified inside the kernel. Don't wait 
+*				if the mutex is already owned by some other task. SVC call.
+* Arguments:	
+*		toLock - mutex to lock
+* Returns: 		
+*		exit status. EXIT_FAILURE if the mutex can't be locked immediately
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MTX_TRY_LOCK) KrisOS_mutex_try_lock_slow(Mutex* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_lock_slow
+* Purpose:    	Take the mutex given inside the kernel. Wait if the mutex is already
+*				taken. SVC call.
+* Arguments:	
+*		toLock - mutex to lock
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MTX_LOCK) KrisOS_mutex_lock_slow(Mutex* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_lock_timed_slow
+* Purpose:    	Take the mutex given inside the kernel. Wait if the mutex is already
+*				taken, but for no longer than the timeout specified. SVC call.
+* Arguments:	
+*		toLock - mutex to lock
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the mutex hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MTX_LOCK_TIMED) KrisOS_mutex_lock_timed_slow(Mutex* toLock, uint32_t timeout);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_mutex_unlock_slow
+* Purpose:    	Unlock the mutex specified inside the kernel, waking the next 
+*				waiter and restoring the inherited priority. SVC call.
+* Arguments:	
+*		toUnlock - mutex to unlock
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task doesn't own the mutex specified 
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_MTX_UNLOCK) KrisOS_mutex_unlock_slow(Mutex* toUnlock);
+
 #endif
@@ -0,0 +1,212 @@
+/*******************************************************************************
+* File:     	notify.c
+* Brief:    	Direct-to-task notification implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	Every task has a 32-bit notification word in its task control block, so an
+*	interrupt handler (or another task) can signal it without a separate
+*	semaphore. The notifier increments the word (counting semaphore), ORs bits
+*	into it (event flags) or overwrites it (single value mailbox). A non-zero 
+*	word means a notification is pending. KrisOS_notify_wait takes it, either
+*	decrementing the word or clearing it, and returns the word as it was. The 
+*	wait returns 0 if the timeout expires first.
+*
+*	Only the task itself waits on its word, so there is no waiting queue. The 
+*	waiting task isn't put on any queue apart from the blocked (timer) one, and
+*	the notifier wakes it directly, without searching for it. Giving to a task 
+*	which isn't waiting, and taking a pending notification, are done in thread 
+*	mode with exclusive load/store (LDREX/STREX), without an SVC call. The SVC 
+*	taken by a task to start waiting clears the exclusive monitor, so a thread 
+*	mode notifier can't miss it. WAITING IS ONLY ALLOWED THROUGH THE USER API 
+*	(KrisOS_notify_wait).
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_NOTIFY
+/*-------------------------------------------------------------------------------
+* Function:    	notify_apply
+* Purpose:    	Compute the new value of a notification word
+* Arguments:	
+*		word - current value of the notification word
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		new value of the notification word
+--------------------------------------------------------------------------------*/
+static uint32_t notify_apply(uint32_t word, uint32_t value, NotifyAction action) {
+	
+	switch (action) {
+		case NOTIFY_INCREMENT: return word + 1;
+		case NOTIFY_SET_BITS: return word | value;
+		default: return value;
+	}
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	notify_give
+* Purpose:    	Update the notification word of the task given and wake it up if
+*				it is waiting for a notification
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t notify_give(Task* toNotify, uint32_t value, NotifyAction action) {
+	
+	// Notification word taken by the task woken
+	uint32_t word;
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toNotify)
+	if (action > NOTIFY_OVERWRITE)
+		return EXIT_FAILURE;
+	
+	__start_critical();
+	{
+		word = notify_apply(toNotify->notifyValue, value, action);
+		toNotify->notifyValue = word;
+	
+		// Hand the notification straight to the task, if it is waiting for it
+		if (toNotify->status == NOTIFY_WAIT && word != 0) {
+			toNotify->notifyValue = (toNotify->notifyOptions & NOTIFY_CLEAR) ? 0 : word - 1;
+			task_wake(toNotify);
+			task_set_return_value(toNotify, word);
+			scheduler_run();
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	notify_wait
+* Purpose:    	Wait until the notification word of the calling task is non-zero
+*				and take the notification
+* Arguments:	
+*		options - NOTIFY_DECREMENT/NOTIFY_CLEAR
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		notification word before it has been taken. If the task has to wait, the
+*		value is returned by the notifying task (0 on timeout).
+--------------------------------------------------------------------------------*/
+uint32_t notify_wait(uint8_t options, uint32_t timeout) {
+	
+	Task* self;
+	uint32_t word;
+	
+	__start_critical();
+	{
+		self = scheduler.runPtr;
+		word = self->notifyValue;
+	
+		// Take the pending notification
+		if (word != 0)
+			self->notifyValue = (options & NOTIFY_CLEAR) ? 0 : word - 1;
+	
+		// Otherwise wait. There is no waiting queue, the notifier wakes the task
+		// directly. The SVC call returns 0 unless a notification comes on time.
+		else {
+			self->notifyOptions = options;
+			task_wait(NULL, NULL, NOTIFY_WAIT, timeout);
+		}
+	}
+	__end_critical();
+	return word;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_ISR
+* Purpose:    	Notify the task given inside an interrupt service routine
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify_ISR(Task* toNotify, uint32_t value, NotifyAction action) {
+	TEST_ISR_PRIORITY
+	return notify_give(toNotify, value, action);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify
+* Purpose:    	Update the notification word of the task given and wake it up if
+*				it is waiting for a notification
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify(Task* toNotify, uint32_t value, NotifyAction action) {
+	
+	uint32_t word;
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toNotify)
+	if (action > NOTIFY_OVERWRITE)
+		return EXIT_FAILURE;
+	
+	// Update the word in thread mode. Enter the kernel only if the task has
+	// to be woken up.
+	do {
+		word = __ldrex(&toNotify->notifyValue);
+		if (toNotify->status == NOTIFY_WAIT) {
+			__clrex();
+			return KrisOS_notify_slow(toNotify, value, action);
+		}
+	} while (__strex(notify_apply(word, value, action), &toNotify->notifyValue));
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_wait
+* Purpose:    	Wait until the notification word of the calling task is non-zero
+*				and take the notification
+* Arguments:	
+*		options - NOTIFY_DECREMENT/NOTIFY_CLEAR
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		notification word before it has been taken, 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_notify_wait(uint8_t options, uint32_t timeout) {
+	
+	Task* self = scheduler.runPtr;
+	uint32_t word;
+	
+	// Take a pending notification in thread mode. Enter the kernel only if the
+	// task has to wait.
+	do {
+		word = __ldrex(&self->notifyValue);
+		if (word == 0) {
+			__clrex();
+			return KrisOS_notify_wait_slow(options, timeout);
+		}
+	} while (__strex((options & NOTIFY_CLEAR) ? 0 : word - 1, &self->notifyValue));
+	return word;
+}
+
+
+
+#endif
@@ -0,0 +1,71 @@
+/*******************************************************************************
+* File:     	notify.h
+* Brief:    	Header file for notify.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_NOTIFY
+/*-------------------------------------------------------------------------------
+* Function:    	notify_give
+* Purpose:    	Update the notification word of the task given and wake it up if
+*				it is waiting for a notification
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t notify_give(Task* toNotify, uint32_t value, NotifyAction action);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	notify_wait
+* Purpose:    	Wait until the notification word of the calling task is non-zero
+*				and take the notification
+* Arguments:	
+*		options - NOTIFY_DECREMENT/NOTIFY_CLEAR
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		notification word before it has been taken. If the task has to wait, the
+*		value is returned by the notifying task (0 on timeout).
+--------------------------------------------------------------------------------*/
+uint32_t notify_wait(uint8_t options, uint32_t timeout);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_slow
+* Purpose:    	Notify the task given inside the kernel. SVC call.
+* Arguments:	
+* 		toNotify - task to notify
+*		value - value used by the action (ignored by NOTIFY_INCREMENT)
+*		action - NOTIFY_INCREMENT/NOTIFY_SET_BITS/NOTIFY_OVERWRITE
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_NOTIFY) KrisOS_notify_slow(Task* toNotify, uint32_t value, NotifyAction action);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_notify_wait_slow
+* Purpose:    	Wait for a notification inside the kernel. SVC call.
+* Arguments:	
+*		options - NOTIFY_DECREMENT/NOTIFY_CLEAR
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		notification word before it has been taken, 0 on timeout
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_NOTIFY_WAIT) KrisOS_notify_wait_slow(uint8_t options, uint32_t timeout);
+
+#endif
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	16/10/2016
-* Last mod: 	13/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 	
 *	os.c and scheduler.c form the basis of KrisOS kernel code with other source
@@ -13,6 +13,7 @@
 *	In addition to this the methods for initialising tha starting the OS are 
 *	defined here.
 *******************************************************************************/
+#include <stddef.h>
 #include "kernel.h"
 #include "system.h"
 #include "KrisOS.h"
@@ -35,6 +36,35 @@ Kernel KrisOS;
 
 
 
+/*-------------------------------------------------------------------------------
+* Kernel information page - static memory allocation. Aligned to its size and 
+* kept in its own section, so that the linker can place it in a memory region
+* the MPU leaves readable to unprivileged tasks.
+--------------------------------------------------------------------------------*/
+KernelInfo kernelInfo __attribute__((section("kernel_info"), aligned(64)));
+
+
+
+/*-------------------------------------------------------------------------------
+* Compile-time checks. The PendSV handler (startup.s) counts the context switches
+* on the kernel information page at hard-coded offsets of the sequence lock and
+* of 'contextSwitches'. A negative array size stops the build if they move.
+--------------------------------------------------------------------------------*/
+typedef struct {
+	char LOCK_OFFSET_CHECK[(offsetof(KernelInfo, lock) == 0) ? 1 : -1];
+	char CONTEXT_SWITCHES_OFFSET_CHECK[(offsetof(KernelInfo, contextSwitches) == 20) ? 1 : -1];
+} KernelInfoCheck;
+
+
+
+/*-------------------------------------------------------------------------------
+* BASEPRI value used by the kernel critical sections (see special_reg_access.s).
+* Masks all the interrupts allowed to call the kernel.
+--------------------------------------------------------------------------------*/
+const uint32_t syscallMaskLevel = MAX_SYSCALL_PRIORITY << 5;
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	os_init
 * Purpose:    	Initialise the operating system
@@ -43,11 +73,12 @@ Kernel KrisOS;
 * 		exit status		
 --------------------------------------------------------------------------------*/
 uint32_t os_init(void) {
-
+	
 	__disable_irqs();	
 	{
 		// Set the initial OS state and enable the Floating-Point Unit
 		KrisOS.isRunning = 0;
+		KrisOS.sliceTicks = TIME_SLICE;
 		__enable_fpu();
 		
 		// Set up the system clock
@@ -66,6 +97,54 @@ uint32_t os_init(void) {
 				KrisOS.totalQueueNo = 0;
 		#endif
 		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_MAILBOX
+				KrisOS.totalMailboxNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_TOPIC
+				KrisOS.totalTopicNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_RWLOCK
+				KrisOS.totalRwLockNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_EVENT_GROUP
+				KrisOS.totalEventGroupNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_CONDVAR
+				KrisOS.totalCondVarNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_BARRIER
+				KrisOS.totalBarrierNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_SOFT_TIMER
+				KrisOS.totalTimerNo = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_HR_TIMER
+				KrisOS.hrTimerMaxLateness = 0;
+		#endif
+		
+		#if defined SHOW_DIAGNOSTIC_DATA && defined USE_COROUTINE
+				KrisOS.totalCoroutineNo = 0;
+		#endif
+		
+		// Start the CPU cycle counter used for fine-grained performance figures
+		// and the high-resolution timestamps
+		cycle_counter_init();
+		
+		// Clear the kernel information page
+		KrisOS_seqlock_init(&kernelInfo.lock);
+		kernelInfo.runningTask = NULL;
+		kernelInfo.ticks = 0;
+		kernelInfo.tickTimestamp = 0;
+		kernelInfo.contextSwitches = kernelInfo.taskNo = 0;
+		kernelInfo.mutexNo = kernelInfo.semNo = kernelInfo.queueNo = 0;
+		
 		// Initialse the scheduler
 		scheduler_init();
 			
@@ -74,6 +153,31 @@ uint32_t os_init(void) {
 			heap_init();
 		#endif			
 			
+		// Initialise the software timer wheel
+		#ifdef USE_SOFT_TIMER
+			soft_timer_service_init();
+		#endif
+			
+		// Start the high-resolution time base and calibrate the busy-wait loop
+		#ifdef USE_HR_TIMER
+			hrtimer_init();
+		#endif
+			
+		// Create the worker tasks of the deferred interrupt work queues
+		#ifdef USE_WORKQUEUE
+			workqueue_service_init();
+		#endif
+			
+		// Prepare the stack shared by the basic tasks
+		#ifdef USE_BASIC_TASK
+			basic_task_service_init();
+		#endif
+			
+		// Prepare the coroutine executor
+		#ifdef USE_COROUTINE
+			coroutine_service_init();
+		#endif
+			
 		// Initialise the uart serial interface
 		#ifdef USE_UART		
 			uart_init(); 
@@ -103,7 +207,7 @@ uint32_t os_start(void) {
 	// Helper pointer for navigating around the private stack memory of the first
 	// task to run
 	uint32_t* taskFramePtr; 	
-
+	
 	// Find the first task to run
 	scheduler_run();
 	scheduler.runPtr = scheduler.topPrioTask;
@@ -140,8 +244,26 @@ uint32_t os_start(void) {
 --------------------------------------------------------------------------------*/
 void SysTick_Handler(void) {
 	
-	// Increment the OS ticks counter
-	KrisOS.ticks++;
+	// Measure the interrupt latency. The SysTick counter has been counting down
+	// from the reload value since the interrupt request was raised.
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t start = DWT->CYCCNT;
+		cycle_stat_update(&KrisOS.tickLatency, 
+						  start - (SYSTICK->RELOAD - SYSTICK->CURRENT));
+	#endif
+	
+	// Increment the OS ticks counter (and the upper half of the uptime when it
+	// wraps) and publish the 64-bit uptime with the time of the 'tick'. 
+	// Interrupts which can run the scheduler are masked so that the writes to 
+	// the kernel information page don't interleave.
+	if (++KrisOS.ticks == 0)
+		KrisOS.ticksHigh++;
+	__start_critical();
+	KrisOS_seqlock_write_begin(&kernelInfo.lock);
+	kernelInfo.ticks = ((uint64_t) KrisOS.ticksHigh << 32) | KrisOS.ticks;
+	kernelInfo.tickTimestamp = DWT->CYCCNT;
+	KrisOS_seqlock_write_end(&kernelInfo.lock);
+	__end_critical();
 	
 	// On each OS timer interrupt increment a counter of the currently running task
 	// so that the CPU usage can be computed later by the KrisOS usage statistics 
@@ -150,21 +272,452 @@ void SysTick_Handler(void) {
 		scheduler.runPtr->cpuUsage++;
 	#endif
 	
+	// Waking tasks up and time-slicing are resolved with a single scheduling decision
+	scheduler_lock();
+	
 	// If there is curently at least one suspended task in the scheduler, check if it
 	// is now ready, if so, wake all the tasks that reached their wait timout value
-	if (scheduler.blocked != NULL && scheduler.blocked->waitCounter <= KrisOS.ticks)
+	if (scheduler.blocked != NULL && !TIME_BEFORE(KrisOS.ticks, scheduler.blocked->waitCounter))
 		scheduler_wake_tasks();
+	
+	// Wake the timer service task if software timers might expire now
+	#ifdef USE_SOFT_TIMER
+		soft_timer_tick();
+	#endif
 		
 	// If the currently running task has used up its entire time slice, then
 	// it should be preempted. Otherwise, mark it as a future candidate for
 	// preemption (if it doesn't get disturbed for the whole duration of a 
-	// time slice.
-	if (KrisOS.ticks % TIME_SLICE == 0) {
+	// time slice. The slice length is counted down, so no division is needed.
+	if (--KrisOS.sliceTicks == 0) {
+		KrisOS.sliceTicks = TIME_SLICE;
 		if (scheduler.preemptFlag)
 			scheduler_run();
 		else
 			scheduler.preemptFlag = 1;
 	}
+	scheduler_unlock();
+	
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		cycle_stat_update(&KrisOS.tickHandler, start);
+	#endif
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	kernel_info_count
+* Purpose:    	Update an object counter of the kernel information page
+* Arguments:	
+*		counter - counter of the page to update
+*		change - number of objects added (negative if removed)
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void kernel_info_count(uint32_t* counter, int32_t change) {
+	__start_critical();
+	KrisOS_seqlock_write_begin(&kernelInfo.lock);
+	*counter += change;
+	KrisOS_seqlock_write_end(&kernelInfo.lock);
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_kernel_info
+* Purpose:    	Take a consistent snapshot of the kernel information page (time,
+*				running task and counters). No SVC call is made and interrupts 
+*				aren't masked, so it can be called from any task and from the 
+*				interrupts allowed to call the kernel.
+* Arguments:	
+* 		snapshot - where to copy the kernel information to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_kernel_info(KernelInfo* snapshot) {
+	
+	uint32_t sequence;
+	TEST_NULL_POINTER(snapshot)
+	
+	// Copy the page until no update has happened in the meantime
+	do {
+		sequence = KrisOS_seqlock_read_begin(&kernelInfo.lock);
+		*snapshot = kernelInfo;
+	} while (KrisOS_seqlock_read_retry(&kernelInfo.lock, sequence));
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* SVC dispatch table entry. Every kernel function called through an SVC takes at
+* most four 32-bit arguments (R0-R3 of the caller's exception stack frame) and
+* returns a 32-bit value. The function is stored through a pointer type without
+* a prototype and called through the pointer type with its own number of 
+* arguments (checked at compile time against the function's prototype, see 
+* SVC_ARITY_CHECK). The return value of calls with the SVC_ATOMIC_RETURN flag 
+* set is stored inside a kernel critical section (see SVC_Handler_C).
+--------------------------------------------------------------------------------*/
+typedef uint32_t (*SvcFunction)();
+typedef uint32_t (*SvcFunction0)(void);
+typedef uint32_t (*SvcFunction1)(uint32_t arg0);
+typedef uint32_t (*SvcFunction2)(uint32_t arg0, uint32_t arg1);
+typedef uint32_t (*SvcFunction3)(uint32_t arg0, uint32_t arg1, uint32_t arg2);
+typedef uint32_t (*SvcFunction4)(uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+typedef struct {
+	SvcFunction function; 				// Kernel function to call (NULL if not compiled in)
+	uint8_t arity; 						// Number of arguments the function takes (0-4)
+	uint8_t flags; 						// SVC_ATOMIC_RETURN or 0
+} SvcEntry;
+
+#define SVC_ATOMIC_RETURN 1
+
+#define SVC_NOT_COMPILED ((SvcFunction) 0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Feature selectors of the SVC table. The calls of the features which aren't 
+* compiled in get a NULL entry (a null SvcFunction, which the arity check can
+* call with any number of arguments).
+--------------------------------------------------------------------------------*/
+#ifdef USE_HEAP
+	#define HEAP_CALL(function) function
+#else
+	#define HEAP_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_MUTEX
+	#define MUTEX_CALL(function) function
+#else
+	#define MUTEX_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_SEMAPHORE
+	#define SEM_CALL(function) function
+#else
+	#define SEM_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_QUEUE
+	#define QUEUE_CALL(function) function
+#else
+	#define QUEUE_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_PQUEUE
+	#define PQUEUE_CALL(function) function
+#else
+	#define PQUEUE_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_MAILBOX
+	#define MAILBOX_CALL(function) function
+#else
+	#define MAILBOX_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_TOPIC
+	#define TOPIC_CALL(function) function
+#else
+	#define TOPIC_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_RWLOCK
+	#define RWLOCK_CALL(function) function
+#else
+	#define RWLOCK_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_EVENT_GROUP
+	#define EVENT_GROUP_CALL(function) function
+#else
+	#define EVENT_GROUP_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_NOTIFY
+	#define NOTIFY_CALL(function) function
+#else
+	#define NOTIFY_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_CONDVAR
+	#define CONDVAR_CALL(function) function
+#else
+	#define CONDVAR_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_BARRIER
+	#define BARRIER_CALL(function) function
+#else
+	#define BARRIER_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_SOFT_TIMER
+	#define TIMER_CALL(function) function
+#else
+	#define TIMER_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_HR_TIMER
+	#define HR_TIMER_CALL(function) function
+#else
+	#define HR_TIMER_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_WORKQUEUE
+	#define WORK_CALL(function) function
+#else
+	#define WORK_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_BASIC_TASK
+	#define BASIC_CALL(function) function
+#else
+	#define BASIC_CALL(function) SVC_NOT_COMPILED
+#endif
+#ifdef USE_COROUTINE
+	#define COROUTINE_CALL(function) function
+#else
+	#define COROUTINE_CALL(function) SVC_NOT_COMPILED
+#endif
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	svc_task_create
+* Purpose:    	SVC_TASK_NEW adapter. Create an unprivileged task using heap.
+* Arguments:	
+*		startAddr - pointer to the task code (function)
+*		stackSize - size of the task's private stack (in bytes)
+*		priority - task priority
+* Returns: 		
+*		pointer to the task created
+--------------------------------------------------------------------------------*/
+static uint32_t svc_task_create(uint32_t startAddr, uint32_t stackSize, uint32_t priority) {
+	return (uint32_t) task_create_dynamic((void*) startAddr, stackSize, priority, 0);
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	svc_task_create_static
+* Purpose:    	SVC_TASK_NEW_S adapter. Create an unprivileged task using static 
+*				memory.
+* Arguments:	
+* 		toDeclare - pointer to the task control block
+*		startAddr - pointer to the task code (function)
+*		stackBottom - pointer to the task's private stack area
+*		priority - task priority
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+static uint32_t svc_task_create_static(uint32_t toDeclare, uint32_t startAddr, 
+									   uint32_t stackBottom, uint32_t priority) {
+	return task_create_static((Task*) toDeclare, (void*) startAddr, (void*) stackBottom, 
+							  priority, 0);
+}
+
+
+
+#ifdef USE_BASIC_TASK
+/*-------------------------------------------------------------------------------
+* Function:    	svc_basic_task_create
+* Purpose:    	SVC_BASIC_TASK_NEW adapter. Create an unprivileged basic task.
+* Arguments:	
+* 		toCreate - pointer to the task control block
+*		startAddr - pointer to the task code (function)
+*		priority - task priority
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+static uint32_t svc_basic_task_create(uint32_t toCreate, uint32_t startAddr, uint32_t priority) {
+	return basic_task_create((Task*) toCreate, (void*) startAddr, priority, 0);
+}
+#endif
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	svc_heap_free
+* Purpose:    	SVC_HEAP_FREE adapter. Free the block of heap memory given.
+* Arguments:	
+*		toFree - block of heap memory to free
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+static uint32_t svc_heap_free(uint32_t toFree) {
+	free((void*) toFree);
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* SVC call list - SVC number, kernel function, number of arguments and flags of
+* every call, in the SVC number order. It generates the dispatch table and the 
+* compile-time checks that the position of each entry matches its SVC number 
+* from KrisOS.h and that the function takes the number of arguments given.
+--------------------------------------------------------------------------------*/
+#define SVC_CALL_LIST(X) \
+	X(SVC_OS_INIT, os_init, 0, 0) \
+	X(SVC_OS_START, os_start, 0, 0) \
+	X(SVC_IRQ_EN, nvic_enable_irq, 1, 0) \
+	X(SVC_IRQ_DIS, nvic_disable_irq, 1, 0) \
+	X(SVC_IRQ_SET_PEND, nvic_set_pending, 1, 0) \
+	X(SVC_IRQ_CLEAR_PEND, nvic_clear_pending, 1, 0) \
+	X(SVC_IRQ_READ_ACTIVE, nvic_read_active, 1, 0) \
+	X(SVC_IRQ_SET_PRIO, nvic_set_priority, 2, 0) \
+	X(SVC_IRQ_GET_PRIO, nvic_get_priority, 1, 0) \
+	X(SVC_TASK_NEW, HEAP_CALL(svc_task_create), 3, 0) \
+	X(SVC_TASK_NEW_S, svc_task_create_static, 4, 0) \
+	X(SVC_TASK_SLEEP, task_sleep, 1, 0) \
+	X(SVC_TASK_YIELD, scheduler_run, 0, 0) \
+	X(SVC_TASK_DELETE, task_delete, 0, 0) \
+	X(SVC_HEAP_ALLOC, HEAP_CALL(malloc), 1, 0) \
+	X(SVC_HEAP_FREE, HEAP_CALL(svc_heap_free), 1, 0) \
+	X(SVC_MTX_INIT, MUTEX_CALL(mutex_init), 1, 0) \
+	X(SVC_MTX_CREATE, MUTEX_CALL(HEAP_CALL(mutex_create)), 0, 0) \
+	X(SVC_MTX_TRY_LOCK, MUTEX_CALL(mutex_try_lock), 1, 0) \
+	X(SVC_MTX_LOCK, MUTEX_CALL(mutex_lock), 1, 0) \
+	X(SVC_MTX_UNLOCK, MUTEX_CALL(mutex_unlock), 1, 0) \
+	X(SVC_MTX_DELETE, MUTEX_CALL(HEAP_CALL(mutex_delete)), 1, 0) \
+	X(SVC_SEM_INIT, SEM_CALL(sem_init), 2, 0) \
+	X(SVC_SEM_CREATE, SEM_CALL(HEAP_CALL(sem_create)), 1, 0) \
+	X(SVC_SEM_DELETE, SEM_CALL(HEAP_CALL(sem_delete)), 1, 0) \
+	X(SVC_SEM_TRY_ACQUIRE, SEM_CALL(sem_try_acquire), 1, 0) \
+	X(SVC_SEM_ACQUIRE, SEM_CALL(sem_acquire), 1, 0) \
+	X(SVC_SEM_RELEASE, SEM_CALL(sem_release), 1, 0) \
+	X(SVC_QUEUE_INIT, QUEUE_CALL(queue_init), 4, 0) \
+	X(SVC_QUEUE_CREATE, QUEUE_CALL(HEAP_CALL(queue_create)), 2, 0) \
+	X(SVC_QUEUE_DELETE, QUEUE_CALL(HEAP_CALL(queue_delete)), 1, 0) \
+	X(SVC_QUEUE_TRY_WRITE, QUEUE_CALL(queue_try_write), 2, 0) \
+	X(SVC_QUEUE_TRY_READ, QUEUE_CALL(queue_try_read), 2, 0) \
+	X(SVC_QUEUE_ENQUEUE, QUEUE_CALL(queue_enqueue), 2, 0) \
+	X(SVC_QUEUE_DEQUEUE, QUEUE_CALL(queue_dequeue), 2, 0) \
+	X(SVC_QUEUE_INIT_TYPED, QUEUE_CALL(queue_init_typed), 4, 0) \
+	X(SVC_MAILBOX_INIT, MAILBOX_CALL(mailbox_init), 3, 0) \
+	X(SVC_MAILBOX_CREATE, MAILBOX_CALL(HEAP_CALL(mailbox_create)), 1, 0) \
+	X(SVC_MAILBOX_DELETE, MAILBOX_CALL(HEAP_CALL(mailbox_delete)), 1, 0) \
+	X(SVC_MAILBOX_WRITE, MAILBOX_CALL(mailbox_write), 2, 0) \
+	X(SVC_TOPIC_INIT, TOPIC_CALL(topic_init), 4, 0) \
+	X(SVC_TOPIC_SUBSCRIBE, TOPIC_CALL(topic_subscribe), 3, 0) \
+	X(SVC_TOPIC_TAKE_BUFFER, TOPIC_CALL(topic_take_buffer), 1, 0) \
+	X(SVC_TOPIC_DELIVER, TOPIC_CALL(topic_deliver), 2, 0) \
+	X(SVC_TOPIC_TAKE_SAMPLE, TOPIC_CALL(topic_take_sample), 1, 0) \
+	X(SVC_TOPIC_RELEASE, TOPIC_CALL(topic_release), 2, 0) \
+	X(SVC_QUEUE_TRY_WRITE_FRONT, QUEUE_CALL(queue_try_write_front), 2, 0) \
+	X(SVC_QUEUE_ENQUEUE_FRONT, QUEUE_CALL(queue_enqueue_front), 2, 0) \
+	X(SVC_PQUEUE_INIT, PQUEUE_CALL(pqueue_init), 4, 0) \
+	X(SVC_PQUEUE_CREATE, PQUEUE_CALL(HEAP_CALL(pqueue_create)), 2, 0) \
+	X(SVC_PQUEUE_DELETE, PQUEUE_CALL(HEAP_CALL(pqueue_delete)), 1, 0) \
+	X(SVC_PQUEUE_TRY_WRITE, PQUEUE_CALL(pqueue_try_write), 3, 0) \
+	X(SVC_PQUEUE_TRY_READ, PQUEUE_CALL(pqueue_try_read), 2, 0) \
+	X(SVC_PQUEUE_PUSH, PQUEUE_CALL(pqueue_push), 3, 0) \
+	X(SVC_PQUEUE_POP, PQUEUE_CALL(pqueue_pop), 2, 0) \
+	X(SVC_SEM_ACQUIRE_TIMED, SEM_CALL(sem_acquire_timed), 2, SVC_ATOMIC_RETURN) \
+	X(SVC_MTX_LOCK_TIMED, MUTEX_CALL(mutex_lock_timed), 2, SVC_ATOMIC_RETURN) \
+	X(SVC_SCHED_LOCK, scheduler_lock, 0, 0) \
+	X(SVC_SCHED_UNLOCK, scheduler_unlock, 0, 0) \
+	X(SVC_MTX_INIT_CEILING, MUTEX_CALL(mutex_init_ceiling), 2, 0) \
+	X(SVC_MTX_CREATE_CEILING, MUTEX_CALL(HEAP_CALL(mutex_create_ceiling)), 1, 0) \
+	X(SVC_RWLOCK_INIT, RWLOCK_CALL(rwlock_init), 1, 0) \
+	X(SVC_RWLOCK_CREATE, RWLOCK_CALL(HEAP_CALL(rwlock_create)), 0, 0) \
+	X(SVC_RWLOCK_DELETE, RWLOCK_CALL(HEAP_CALL(rwlock_delete)), 1, 0) \
+	X(SVC_RWLOCK_READ_LOCK, RWLOCK_CALL(rwlock_read_lock), 1, 0) \
+	X(SVC_RWLOCK_READ_UNLOCK, RWLOCK_CALL(rwlock_read_unlock), 1, 0) \
+	X(SVC_RWLOCK_WRITE_LOCK, RWLOCK_CALL(rwlock_write_lock), 1, 0) \
+	X(SVC_RWLOCK_WRITE_UNLOCK, RWLOCK_CALL(rwlock_write_unlock), 1, 0) \
+	X(SVC_EVENT_GROUP_INIT, EVENT_GROUP_CALL(event_group_init), 1, 0) \
+	X(SVC_EVENT_GROUP_CREATE, EVENT_GROUP_CALL(HEAP_CALL(event_group_create)), 0, 0) \
+	X(SVC_EVENT_GROUP_DELETE, EVENT_GROUP_CALL(HEAP_CALL(event_group_delete)), 1, 0) \
+	X(SVC_EVENT_GROUP_SET, EVENT_GROUP_CALL(event_group_set), 2, 0) \
+	X(SVC_EVENT_GROUP_WAIT, EVENT_GROUP_CALL(event_group_wait), 4, SVC_ATOMIC_RETURN) \
+	X(SVC_NOTIFY, NOTIFY_CALL(notify_give), 3, 0) \
+	X(SVC_NOTIFY_WAIT, NOTIFY_CALL(notify_wait), 2, SVC_ATOMIC_RETURN) \
+	X(SVC_CONDVAR_INIT, CONDVAR_CALL(condvar_init), 1, 0) \
+	X(SVC_CONDVAR_CREATE, CONDVAR_CALL(HEAP_CALL(condvar_create)), 0, 0) \
+	X(SVC_CONDVAR_DELETE, CONDVAR_CALL(HEAP_CALL(condvar_delete)), 1, 0) \
+	X(SVC_CONDVAR_WAIT, CONDVAR_CALL(condvar_wait), 2, 0) \
+	X(SVC_CONDVAR_SIGNAL, CONDVAR_CALL(condvar_signal), 1, 0) \
+	X(SVC_CONDVAR_BROADCAST, CONDVAR_CALL(condvar_broadcast), 1, 0) \
+	X(SVC_BARRIER_INIT, BARRIER_CALL(barrier_init), 3, 0) \
+	X(SVC_BARRIER_CREATE, BARRIER_CALL(HEAP_CALL(barrier_create)), 2, 0) \
+	X(SVC_BARRIER_DELETE, BARRIER_CALL(HEAP_CALL(barrier_delete)), 1, 0) \
+	X(SVC_BARRIER_WAIT, BARRIER_CALL(barrier_wait), 1, 0) \
+	X(SVC_BARRIER_RELEASE, BARRIER_CALL(barrier_release), 1, 0) \
+	X(SVC_TIMER_INIT, TIMER_CALL(soft_timer_init), 4, 0) \
+	X(SVC_TIMER_CREATE, TIMER_CALL(HEAP_CALL(soft_timer_create)), 3, 0) \
+	X(SVC_TIMER_DELETE, TIMER_CALL(HEAP_CALL(soft_timer_delete)), 1, 0) \
+	X(SVC_TIMER_START, TIMER_CALL(soft_timer_start), 1, 0) \
+	X(SVC_TIMER_STOP, TIMER_CALL(soft_timer_stop), 1, 0) \
+	X(SVC_TIMER_RESET, TIMER_CALL(soft_timer_reset), 1, 0) \
+	X(SVC_HRTIMER_START, HR_TIMER_CALL(hrtimer_start), 4, 0) \
+	X(SVC_HRTIMER_CANCEL, HR_TIMER_CALL(hrtimer_cancel), 1, 0) \
+	X(SVC_HRTIMER_SLEEP, HR_TIMER_CALL(hrtimer_sleep), 2, 0) \
+	X(SVC_TASK_SLEEP_SLACK, task_sleep_slack, 2, 0) \
+	X(SVC_WORK_SUBMIT, WORK_CALL(work_submit), 3, 0) \
+	X(SVC_BASIC_TASK_NEW, BASIC_CALL(svc_basic_task_create), 3, 0) \
+	X(SVC_BASIC_TASK_ACTIVATE, BASIC_CALL(basic_task_activate), 1, 0) \
+	X(SVC_BASIC_TASK_TERMINATE, BASIC_CALL(basic_task_terminate), 0, 0) \
+	X(SVC_COROUTINE_START, COROUTINE_CALL(coroutine_start), 3, 0) \
+	X(SVC_TASK_SET_SLACK, task_set_slack, 1, 0)
+
+
+
+/*-------------------------------------------------------------------------------
+* Compile-time checks. The list position of each call has to be equal to its
+* SVC number and the list has to cover all SVC_COUNT calls, otherwise a negative
+* array size stops the build. The function of each call is also called (inside 
+* sizeof, so not evaluated) with as many arguments as the list gives, which 
+* doesn't compile unless its prototype takes exactly that many.
+--------------------------------------------------------------------------------*/
+#define SVC_ARGS_0
+#define SVC_ARGS_1 0
+#define SVC_ARGS_2 0, 0
+#define SVC_ARGS_3 0, 0, 0
+#define SVC_ARGS_4 0, 0, 0, 0
+
+#define SVC_LIST_POSITION(number, function, arity, flags) number##_POSITION,
+#define SVC_NUMBER_CHECK(number, function, arity, flags) \
+	char number##_CHECK[(number##_POSITION == (number)) ? 1 : -1];
+#define SVC_ARITY_CHECK(number, function, arity, flags) \
+	char number##_ARITY[sizeof(((function)(SVC_ARGS_##arity), 1))];
+
+enum { SVC_CALL_LIST(SVC_LIST_POSITION) SVC_LIST_LENGTH };
+
+typedef struct { 
+	SVC_CALL_LIST(SVC_NUMBER_CHECK) 
+	SVC_CALL_LIST(SVC_ARITY_CHECK) 
+	char SVC_COUNT_CHECK[(SVC_LIST_LENGTH == SVC_COUNT) ? 1 : -1];
+} SvcTableCheck;
+
+
+
+/*-------------------------------------------------------------------------------
+* SVC dispatch table, indexed by the SVC number. Initialised data, so it is 
+* copied to SRAM at start-up and the dispatch doesn't wait for the flash. Kept 
+* in its own section, so that the linker can place it in a memory region the 
+* MPU leaves writable only to privileged code.
+--------------------------------------------------------------------------------*/
+#define SVC_TABLE_ENTRY(number, function, arity, flags) \
+	{(SvcFunction) (function), (arity), (flags)},
+
+static SvcEntry svcTable[SVC_COUNT] __attribute__((section("svc_table"))) = { 
+	SVC_CALL_LIST(SVC_TABLE_ENTRY) 
+};
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	svc_call
+* Purpose:    	Call the kernel function of an SVC table entry with as many of the
+*				caller's R0-R3 as it takes
+* Arguments:	
+*		call - SVC table entry
+*		svcArgs - exception stack frame of the calling task
+* Returns: 		
+*		value returned by the kernel function
+--------------------------------------------------------------------------------*/
+static uint32_t svc_call(const SvcEntry* call, uint32_t* svcArgs) {
+	switch (call->arity) {
+		case 0: return ((SvcFunction0) call->function)();
+		case 1: return ((SvcFunction1) call->function)(svcArgs[0]);
+		case 2: return ((SvcFunction2) call->function)(svcArgs[0], svcArgs[1]);
+		case 3: return ((SvcFunction3) call->function)(svcArgs[0], svcArgs[1], svcArgs[2]);
+		default: return ((SvcFunction4) call->function)(svcArgs[0], svcArgs[1], svcArgs[2], 
+														 svcArgs[3]);
+	}
 }
 
 
@@ -173,90 +726,46 @@ void SysTick_Handler(void) {
 * Function:    	SVC_Handler_C
 * Purpose:    	The 'C' part of the SVC call handler - the mechanism for requesting
 *				KrisOS servises by the user code.
-* Arguments:	-
-* Returns: 		-
+* Arguments:	
+*		svcArgs - exception stack frame of the calling task
+* Returns: 		
+*		1 if the context switch requested by the call should be made at the SVC
+*		exit (see startup.s), 0 otherwise
 --------------------------------------------------------------------------------*/
-void SVC_Handler_C(uint32_t* svcArgs) {
+uint32_t SVC_Handler_C(uint32_t* svcArgs) {
 	
-	// Extract the SVC number and use it to run the right subroutine 
+	// Extract the SVC number from the SVC instruction and call the kernel function
+	// with the caller's R0-R3. The number is read from the instruction because 
+	// the calls are __svc functions, which the compiler expands to an inline
+	// SVC instruction with no stub to load a register from. The calls that can
+	// block the caller store their return value before a wake-up or a timeout 
+	// can overwrite it (the SysTick handler or an ISR set the return value of 
+	// the tasks they wake).
 	uint8_t svcNumber = ((uint8_t*) svcArgs[6])[-2];
-	switch(svcNumber) {
-// ---- OS initialisation and launch SVC calls  ---------------------------------
-		case SVC_OS_INIT: svcArgs[0] = os_init(); break;
-		case SVC_OS_START: svcArgs[0] = os_start(); break;	
-		
-// ---- NVIC Interrupt control SVC calls ----------------------------------------
-		case SVC_IRQ_EN: svcArgs[0] = nvic_enable_irq((IRQn_Type) svcArgs[0]); break;
-		case SVC_IRQ_DIS: svcArgs[0] = nvic_disable_irq((IRQn_Type) svcArgs[0]); break;
-		case SVC_IRQ_SET_PEND: svcArgs[0] = nvic_set_pending((IRQn_Type) svcArgs[0]); break;
-		case SVC_IRQ_CLEAR_PEND: svcArgs[0] = nvic_clear_pending((IRQn_Type) svcArgs[0]); break;
-		case SVC_IRQ_READ_ACTIVE: svcArgs[0] = nvic_read_active((IRQn_Type) svcArgs[0]); break;
-		case SVC_IRQ_SET_PRIO: svcArgs[0] = nvic_set_priority((IRQn_Type) svcArgs[0], svcArgs[1]); break;
-		case SVC_IRQ_GET_PRIO: svcArgs[0] = nvic_get_priority((IRQn_Type) svcArgs[0]); break;		
-			
-// ---- Task scheduling SVC calls -----------------------------------------------
-		#ifdef USE_HEAP
-		case SVC_TASK_NEW: svcArgs[0] = (uint32_t) task_create_dynamic((void*) svcArgs[0], 
-			svcArgs[1], svcArgs[2], 0); break;
-		#endif
-		case SVC_TASK_NEW_S: svcArgs[0] = task_create_static((void*) svcArgs[0], 
-			(void*) svcArgs[1], (void*) svcArgs[2], svcArgs[3], 0); break;
-		case SVC_TASK_SLEEP: svcArgs[0] = task_sleep(svcArgs[0]);  break;
-		case SVC_TASK_YIELD: svcArgs[0] = scheduler_run(); break;
-		case SVC_TASK_DELETE: svcArgs[0] = task_delete(); break;
-		
-// ---- Heap management SVC calls -----------------------------------------------
-		#ifdef USE_HEAP	
-		case SVC_HEAP_ALLOC: svcArgs[0] = (uint32_t) malloc(svcArgs[0]); break;
-		case SVC_HEAP_FREE: free((void*) svcArgs[0]); break;
-		#endif
-		
-// ---- Mutual exclusion lock management SVC calls ------------------------------
-		#ifdef USE_MUTEX
-		case SVC_MTX_INIT: svcArgs[0] = mutex_init((void*) svcArgs[0]); break;
-		#ifdef USE_HEAP
-			case SVC_MTX_CREATE: svcArgs[0] = (uint32_t) mutex_create(); break;
-			case SVC_MTX_DELETE: svcArgs[0] = mutex_delete((void*) svcArgs[0]); break;
-		#endif
-		case SVC_MTX_TRY_LOCK: svcArgs[0] = mutex_try_lock((void*) svcArgs[0]); break;
-		case SVC_MTX_LOCK: svcArgs[0] = (uint32_t) mutex_lock((void*) svcArgs[0]); break;
-		case SVC_MTX_UNLOCK: svcArgs[0] = mutex_unlock((void*) svcArgs[0]); break;
-		#endif
-		
-// ---- Semaphore management SVC calls -------------------------------------------
-		#ifdef USE_SEMAPHORE
-		case SVC_SEM_INIT: svcArgs[0] = sem_init((void*) svcArgs[0], svcArgs[1]); break;
-		#ifdef USE_HEAP
-			case SVC_SEM_CREATE: svcArgs[0] = (uint32_t) sem_create(svcArgs[0]); break;
-			case SVC_SEM_DELETE: svcArgs[0] = sem_delete((void*) svcArgs[0]); break;
-		#endif
-		case SVC_SEM_TRY_ACQUIRE: svcArgs[0] = (uint32_t) sem_try_acquire((void*) svcArgs[0]); break;
-		case SVC_SEM_ACQUIRE: svcArgs[0] = sem_acquire((void*) svcArgs[0]); break;
-		case SVC_SEM_RELEASE: svcArgs[0] = (uint32_t) sem_release((void*) svcArgs[0]); break;
-		#endif 
-		
-// ---- Inter-task queue management SVC calls -------------------------------------------
-		#ifdef USE_QUEUE
-		case SVC_QUEUE_INIT: svcArgs[0] = queue_init((void*) svcArgs[0], (void*) svcArgs[1],
-			svcArgs[2], svcArgs[3]); break;
-		#ifdef USE_HEAP
-			case SVC_QUEUE_CREATE: svcArgs[0] = (uint32_t) queue_create(svcArgs[0], 
-				svcArgs[1]); break;
-			case SVC_QUEUE_DELETE: svcArgs[0] = queue_delete((void*) svcArgs[0]); break;
-		#endif
-		case SVC_QUEUE_TRY_WRITE: svcArgs[0] = queue_try_write((void*) svcArgs[0], 
-			(const void*) svcArgs[1]); break;	
-		case SVC_QUEUE_TRY_READ: svcArgs[0] = queue_try_read((void*) svcArgs[0], 
-			(void*) svcArgs[1]); break;
-		case SVC_QUEUE_ENQUEUE: svcArgs[0] = queue_enqueue((void*) svcArgs[0], 
-			(const void*) svcArgs[1]); break;	
-		case SVC_QUEUE_DEQUEUE: svcArgs[0] = queue_dequeue((void*) svcArgs[0], 
-			(void*) svcArgs[1]); break;	
-		#endif 		
-		
-		default: break;
+	const SvcEntry* call;
+	
+	if (svcNumber < SVC_COUNT && svcTable[svcNumber].function != NULL) {
+		call = &svcTable[svcNumber];
+		if (call->flags & SVC_ATOMIC_RETURN) {
+			__start_critical();
+			svcArgs[0] = svc_call(call, svcArgs);
+			__end_critical();
+		}
+		else 
+			svcArgs[0] = svc_call(call, svcArgs);
 	}
-	return;
+	
+	// If the call has requested a context switch, make it at the SVC exit instead
+	// of in the PendSV exception, which would reload the frame just stacked. A
+	// switch requested in the meantime by an interrupt is taken over as well, 
+	// as the SVC exit switches to whichever task is the top priority one then.
+	#ifdef SVC_DIRECT_SWITCH
+		if ((SCB->ICSR & (1 << PENDSV)) && scheduler.topPrioTask != scheduler.runPtr) {
+			SCB->ICSR = 1 << UNPENDSV;
+			return 1;
+		}
+	#endif
+	return 0;
 }
 
 
@@ -288,6 +797,18 @@ void _sys_exit(int return_code) {
 			case EXIT_INVALID_SIZE:
 				fprintf(&uart, "\nInvalid size argument specified! Should be greated than 0...");
 				break;
+			case EXIT_INVALID_ISR_PRIO:
+				fprintf(&uart, "\nKrisOS service called from an interrupt above MAX_SYSCALL_PRIORITY...");
+				break;
+			case EXIT_SCHEDULER_LOCKED:
+				fprintf(&uart, "\nTask blocked while holding the scheduler lock...");
+				break;
+			case EXIT_BASIC_TASK_BLOCKED:
+				fprintf(&uart, "\nBasic task tried to block or delete itself! Basic tasks run to completion...");
+				break;
+			case EXIT_BASIC_STACK_OVERFLOW:
+				fprintf(&uart, "\nBasic task stack overflow! Increase BASIC_STACK_SIZE...");
+				break;
 			case EXIT_INVALID_OS_CLOCK_FREQ:
 				fprintf(&uart, "\nInvalid OS clock frequency specified! Try a different value such as 100Hz or 100000Hz...");
 				break;
@@ -297,7 +818,7 @@ void _sys_exit(int return_code) {
 				while(1);
 			default: break;
 		}
-
+	
 		fprintf(&uart, "\nTerminating...");
 	#endif
 	
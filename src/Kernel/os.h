@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	30/09/2016
-* Last mod: 	13/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -21,28 +21,142 @@ typedef struct {
 	// Flag indicating if the OS is running
 	uint8_t isRunning; 					
 	// OS ticks, counter incremented on each OS timer interrupt. Used for 
-	// time-keeping by KrisOS
-	uint64_t ticks; 				
+	// time-keeping by KrisOS. It is 32-bit and wraps, the kernel compares times 
+	// with TIME_BEFORE. The upper half of the 64-bit uptime is counted separately.
+	uint32_t ticks; 				
+	uint32_t ticksHigh;
+	// OS ticks left until the end of the current time slice
+	uint32_t sliceTicks;
+	// Number of CPU cycles from the OS timer interrupt request to its handler 
+	// (interrupt latency caused by kernel critical sections), the time spent in
+	// the handler and the cost of a pair of SVC calls doing almost no work (SVC
+	// entry, dispatch and exit)
+#ifdef SHOW_DIAGNOSTIC_DATA
+	CycleStat tickLatency;
+	CycleStat tickHandler;
+	CycleStat svcRoundTrip;
+#endif
 	// The time length of the longest mutex lock time recorded (useful performance
-	// figure) and the total number of mutexes in use
+	// figure), the total number of mutexes in use, the cost (in CPU cycles) of
+	// a lock/unlock pair made through the thread-mode fast path and the SVC path
+	// and the time spent in the kernel locking inheritance and ceiling mutexes. 
+	// Also, the longest chain of tasks boosted by priority inheritance and the
+	// cost of a lock blocked until the owner hands the mutex over
 #if defined SHOW_DIAGNOSTIC_DATA && defined USE_MUTEX
 	uint32_t maxMtxCriticalSection; 	
 	uint32_t totalMutexNo; 				
+	uint32_t maxInheritDepth;
+	CycleStat mutexFastPath;
+	CycleStat mutexSlowPath;
+	CycleStat mutexInheritLock;
+	CycleStat mutexCeilingLock;
+	#if defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+		CycleStat mutexContended;
+	#endif
 #endif
-	// Total number of semaphores in use
+	// Total number of semaphores in use, the cost (in CPU cycles) of a 
+	// release/acquire pair made through the fast path and the SVC path and of
+	// a ping-pong round trip between two tasks (two blocking context switches)
 #if defined SHOW_DIAGNOSTIC_DATA && defined USE_SEMAPHORE
 	uint32_t totalSemNo; 				
+	CycleStat semFastPath;
+	CycleStat semSlowPath;
+	#ifdef SYNC_BENCHMARK
+		CycleStat semPingPong;
+	#endif
 #endif
-	// Total number of queues in use
+	// Total number of queues in use, the cost (in CPU cycles) of copying
+	// a single item in/out of generic (memcpy) and typed queues inside the 
+	// kernel and of a write/read pair made through the generic API and through
+	// the routines generated for a typed queue
 #if defined SHOW_DIAGNOSTIC_DATA && defined USE_QUEUE
 	uint32_t totalQueueNo;				
+	CycleStat queueCopyGeneric;
+	CycleStat queueCopyTyped;
+	CycleStat queueGenericPath;
+	CycleStat queueTypedPath;
 #endif	
+	// Time (in CPU cycles) messages spent in priority queues, per priority class
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_PQUEUE
+	CycleStat pqueueLatency[PQUEUE_LATENCY_CLASSES];
+#endif
+	// Total number of mailboxes in use (the readers count their retries in the
+	// mailboxes themselves)
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_MAILBOX
+	uint32_t totalMailboxNo;
+#endif
+	// Total number of topics in use and the number of samples dropped for the
+	// subscribers that fell behind
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_TOPIC
+	uint32_t totalTopicNo;
+	uint32_t topicDrops;
+#endif
+	// Total number of reader-writer locks in use and the cost (in CPU cycles) 
+	// of an uncontended read lock/unlock pair. Also, the cost of letting the
+	// reader benchmark tasks through a reader-writer lock and through a mutex
+	// held by the stats task
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_RWLOCK
+	uint32_t totalRwLockNo;
+	CycleStat rwlockReadPath;
+	#if defined SYNC_BENCHMARK && defined USE_MUTEX && defined USE_SEMAPHORE
+		CycleStat rwlockReaders;
+		CycleStat mutexReaders;
+	#endif
+#endif
+	// Total number of event flag groups in use
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_EVENT_GROUP
+	uint32_t totalEventGroupNo;
+#endif
+	// Cost (in CPU cycles) of a task notification give/take pair made through
+	// the fast path and the SVC path (to compare with the semaphore)
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_NOTIFY
+	CycleStat notifyFastPath;
+	CycleStat notifySlowPath;
+#endif
+	// Total number of condition variables in use
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_CONDVAR
+	uint32_t totalCondVarNo;
+#endif
+	// Total number of barriers in use and the CPU cycles spent in the kernel by
+	// all the calls of a barrier phase, per number of tasks synchronised
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_BARRIER
+	uint32_t totalBarrierNo;
+	CycleStat barrierPhase[BARRIER_PHASE_CLASSES];
+#endif
+	// Total number of software timers in use
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_SOFT_TIMER
+	uint32_t totalTimerNo;
+#endif
+	// Latest a high-resolution timer event has been handled (in CPU cycles)
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_HR_TIMER
+	uint32_t hrTimerMaxLateness;
+#endif
+	// Number of coroutines running and the CPU cycles taken by a coroutine step
+#if defined SHOW_DIAGNOSTIC_DATA && defined USE_COROUTINE
+	uint32_t totalCoroutineNo;
+	CycleStat coroutineResume;
+#endif
 } Kernel; 
 
 extern Kernel KrisOS;
 
 
 
+/*-------------------------------------------------------------------------------
+* Kernel information page (see KrisOS.h), written by the kernel inside critical
+* sections using its sequence lock
+--------------------------------------------------------------------------------*/
+extern KernelInfo kernelInfo;
+
+
+
+/*-------------------------------------------------------------------------------
+* BASEPRI value used by the kernel critical sections
+--------------------------------------------------------------------------------*/
+extern const uint32_t syscallMaskLevel;
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	os_init
 * Purpose:    	Initialise the operating system
@@ -64,3 +178,15 @@ uint32_t os_init(void);
 --------------------------------------------------------------------------------*/
 uint32_t os_start(void);
 
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	kernel_info_count
+* Purpose:    	Update an object counter of the kernel information page
+* Arguments:	
+*		counter - counter of the page to update
+*		change - number of objects added (negative if removed)
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void kernel_info_count(uint32_t* counter, int32_t change);
+
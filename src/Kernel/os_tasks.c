@@ -4,10 +4,10 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	07/02/2017
-* Last mod: 	14/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
-*	There are two OS (system) tasks registered by the KrisOS at the scheduler
+*	The OS (system) tasks registered by the KrisOS at the scheduler are:
 *		1. The idle task - crucial to the KrisOS scheduler implementation and
 *		   it is run whenever there is no other processing to do (no other
 *		   task is ready).
@@ -16,6 +16,15 @@
 *		   development/debug stage as it provides a number of useful figures 
 *		   describing the behaviour of each task as well as other KrisOS 
 *		   functionality.
+*		3. The pong task - created together with the stats task if semaphores
+*		   and SYNC_BENCHMARK are enabled. It only answers the semaphore 
+*		   ping-pong of the stats task.
+*		4. The barrier benchmark tasks - created together with the stats task 
+*		   if barriers and SYNC_BENCHMARK are enabled. They only synchronise
+*		   with the stats task at the benchmark barriers.
+*		5. The mutex benchmark task - created together with the stats task if
+*		   mutexes, semaphores and SYNC_BENCHMARK are enabled. It times a lock
+*		   of a mutex held by the stats task, i.e. a lock that really blocks.
 *
 *	A list of statistic and performance data mainained by KrisOS 'stats' task
 *		1. Total time KrisOS has been running for
@@ -25,7 +34,8 @@
 *		4. OS clock frequency - KrisOS time resolution, the frequency of the 
 *		   OS timer which is the main source of OS timekeeping
 *		5. Context switches - number of context switches which occurred during
-*		   the measurement period
+*		   the measurement period and the number of redundant scheduling requests
+*		   merged into one decision by the scheduler lock
 *		6. Total number of tasks registered at the scheduler (both user and system)
 *		7. Total number of Semaphores, Mutexes and Queues initialised. These
 *		   figures are displayed per data structure type, provided that a given
@@ -33,7 +43,8 @@
 *		8. Maximum Mutex lock time - if mutexes are enabled, the length (in OS 'ticks')
 *		   of each critical section guarded by a mutual exclusion lock is compared
 *		   with the current maximum lock time and if necessary the maximum figure
-*		   is updated.
+*		   is updated. A mutex unlocked in thread mode keeps its own maximum, 
+*		   which is added to the figure the next time the mutex enters the kernel.
 *		9. Heap usage (if heap manager is enabled) 
 *		10.Per task data:
 *			A. Task ID
@@ -46,9 +57,308 @@
 *			   running, or maybe waiting blocked by a syncronisation structure.
 *			F. Type of memory allocation - has the task been created dynamically
 *			or statically (memory allocated at compile time)
+*		11.Cycle counts - average and maximum number of CPU cycles (measured 
+*		   with the DWT cycle counter) spent in selected kernel code paths, such
+*		   as copying an item in/out of generic and typed queues (when written
+*		   or read through the generic API), or all the barrier calls of a 
+*		   phase (for 2, 3-4, 5-8 and 9+ tasks synchronised).
+*		   With SYNC_BENCHMARK enabled, the stats task and the barrier 
+*		   benchmark tasks synchronise at barriers of 2, 4 and 8 parties once 
+*		   per sync measurement run, so the first three classes are filled 
+*		   even if the application uses no barriers.
+*		12.Synchronisation cost - cycles taken by an uncontended mutex lock/unlock
+*		   and semaphore release/acquire pair, both through the thread-mode fast 
+*		   path and through the SVC path (the one taken on contention, though 
+*		   here without blocking), and by a reader-writer lock read lock/unlock
+*		   pair, to compare with the mutex. With SYNC_BENCHMARK enabled, also 
+*		   the time taken by READER_BENCH_TASKS readers to get through a 
+*		   reader-writer lock and through a mutex the stats task holds (shared
+*		   with them for the former). Also, a task notification give/take
+*		   pair through both paths, to compare with the semaphore. These are 
+*		   measured by the stats task itself on private objects (its own 
+*		   notification word). With SYNC_BENCHMARK enabled, also the contended
+*		   cases: a mutex lock that blocks until the stats task hands the mutex
+*		   over (timed by the mutex benchmark task) and the round trip of a 
+*		   semaphore ping-pong with the pong task. Both take two context 
+*		   switches made by SVC calls (compare with SVC_DIRECT_SWITCH disabled).
+*		   Also, a queue write/read pair of a word through the generic API and
+*		   through the routines generated for a typed queue.
+*		13.Mutex lock latency - cycles spent inside the kernel by a mutex lock
+*		   call (up to blocking), for the priority inheritance mutexes, which
+*		   walk the chain of blocked owners, and the priority ceiling ones. The 
+*		   longest chain walked is shown next to the limit on its length.
+*		14.OS timer interrupt latency - cycles from the SysTick request to its
+*		   handler, i.e. the delay caused by kernel critical sections to the
+*		   interrupts allowed to call the kernel.
+*		15.Work queues - for each queue, the most work items waiting at the 
+*		   same time and the cycles from the submission of an item until its
+*		   worker task starts running it.
+*		16.Basic task stack - peak usage of the stack shared by the basic tasks.
+*		17.Coroutine step - cycles from resuming a coroutine until its next 
+*		   await (compare with the semaphore ping-pong).
 *******************************************************************************/
 #include "common.h"
 #include "kernel.h"
+#include "system.h"
+
+
+
+#ifdef SHOW_DIAGNOSTIC_DATA
+#if defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+/*-------------------------------------------------------------------------------
+* Semaphores the stats task and the pong task ping-pong with. They aren't 
+* initialised through the API so that they don't show up in the semaphore count
+*------------------------------------------------------------------------------*/
+static Semaphore pingSem;
+static Semaphore pongSem;
+#endif
+
+
+
+#ifdef USE_QUEUE
+/*-------------------------------------------------------------------------------
+* Queues of a single word the stats task writes/reads through the generic API
+* and through the routines generated for a typed queue. They aren't initialised
+* through the API so that they don't show up in the queue count
+*------------------------------------------------------------------------------*/
+KrisOS_queue_typed_routines(benchWord, uint32_t)
+static uint32_t benchGenericBuffer[1];
+static uint32_t benchTypedBuffer[1];
+static Queue benchGenericQueue = {
+	(uint8_t*) benchGenericBuffer, (uint8_t*) &benchGenericBuffer[1], sizeof(uint32_t),
+	(uint8_t*) benchGenericBuffer, (uint8_t*) benchGenericBuffer, NULL, {0}, {1}
+};
+static Queue benchTypedQueue = {
+	(uint8_t*) benchTypedBuffer, (uint8_t*) &benchTypedBuffer[1], sizeof(uint32_t),
+	(uint8_t*) benchTypedBuffer, (uint8_t*) benchTypedBuffer, &benchWordOps, {0}, {1}
+};
+#endif
+
+
+
+#if defined SYNC_BENCHMARK && defined USE_MUTEX && defined USE_SEMAPHORE
+/*-------------------------------------------------------------------------------
+* Mutex the stats task holds while the mutex benchmark task tries to lock it and
+* the semaphore the stats task starts each try with. They aren't initialised 
+* through the API so that they don't show up in the mutex/semaphore counts
+*------------------------------------------------------------------------------*/
+static Mutex contendedMtx = {NULL, NULL, MTX_NO_CEILING};
+static Semaphore mutexBenchSem;
+#endif
+
+
+
+#if defined SYNC_BENCHMARK && defined USE_RWLOCK && defined USE_MUTEX && \
+	defined USE_SEMAPHORE
+/*-------------------------------------------------------------------------------
+* Locks the stats task and the reader benchmark tasks read through, the 
+* semaphores the stats task starts the readers with and the readers report back
+* with, and the lock the readers take (1 - the mutex, 0 - the reader-writer lock).
+* They aren't initialised through the API so that they don't show up in the 
+* counts
+*------------------------------------------------------------------------------*/
+static RwLock readerRwLock;
+static Mutex readerMtx = {NULL, NULL, MTX_NO_CEILING};
+static Semaphore readerStartSem;
+static Semaphore readerDoneSem;
+static uint8_t readersUseMutex;
+#endif
+
+
+
+#if defined SYNC_BENCHMARK && defined USE_BARRIER
+/*-------------------------------------------------------------------------------
+* Barriers the stats task and the barrier benchmark tasks synchronise at, with 
+* 2, 4 and 8 parties. They aren't initialised through the API so that they don't
+* show up in the barrier count
+*------------------------------------------------------------------------------*/
+#define BARRIER_BENCH_NO 3
+static Barrier benchBarriers[BARRIER_BENCH_NO] = {
+	{2, 0, BARRIER_NO_OPTIONS, NULL, 0},
+	{4, 0, BARRIER_NO_OPTIONS, NULL, 0},
+	{BARRIER_BENCH_TASKS + 1, 0, BARRIER_NO_OPTIONS, NULL, 0}
+};
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	print_cycle_stat
+* Purpose:    	Display a cycle count statistic and reset it for the next 
+*				measurement period
+* Arguments: 	
+*		name - label to display
+*		stat - statistic to display
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void print_cycle_stat(const char* name, CycleStat* stat) {
+	if (stat->count == 0)
+		fprintf(&uart, "%s\tN/A\n", name);
+	else
+		fprintf(&uart, "%s\t%d cycles avg, %d max (%d samples)\n", name, 
+				stat->total / stat->count, stat->max, stat->count);
+	cycle_stat_reset(stat);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Number of lock/unlock pairs timed by measure_sync_paths per measurement period
+*------------------------------------------------------------------------------*/
+#define SYNC_BENCH_RUNS 16
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	measure_sync_paths
+* Purpose:    	Time the SVC dispatch and the mutex, semaphore, reader-writer lock
+*				and task notification user API calls on uncontended objects 
+*				through the fast path and through the SVC path. With 
+*				SYNC_BENCHMARK enabled, also drive the contended cases run 
+*				with the benchmark tasks.
+* Arguments: 	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void measure_sync_paths(void) {
+	
+	// Private objects to measure on. The mutex and the reader-writer lock are free
+	// and the semaphore counter is zero. They aren't initialised through the API 
+	// so that they don't show up in the mutex/semaphore/reader-writer lock counts
+	#ifdef USE_MUTEX
+		static Mutex benchMtx = {NULL, NULL, MTX_NO_CEILING};
+	#endif
+	#ifdef USE_SEMAPHORE
+		static Semaphore benchSem;
+	#endif
+	#ifdef USE_RWLOCK
+		static RwLock benchRwLock;
+	#endif
+	uint32_t start, run;
+	#ifdef USE_QUEUE
+		uint32_t item;
+	#endif
+	#if defined SYNC_BENCHMARK && defined USE_BARRIER
+		uint32_t barrier;
+	#endif
+	#if defined SYNC_BENCHMARK && defined USE_RWLOCK && defined USE_MUTEX && \
+		defined USE_SEMAPHORE
+		uint32_t reader;
+	#endif
+	
+	for (run = 0; run < SYNC_BENCH_RUNS; run++) {
+		
+		// A scheduler lock/unlock pair doesn't reschedule, so it measures the cost
+		// of the SVC dispatch itself
+		start = DWT->CYCCNT;
+		KrisOS_sched_lock();
+		KrisOS_sched_unlock();
+		cycle_stat_update(&KrisOS.svcRoundTrip, start);
+		
+		#ifdef USE_MUTEX
+			start = DWT->CYCCNT;
+			KrisOS_mutex_lock(&benchMtx);
+			KrisOS_mutex_unlock(&benchMtx);
+			cycle_stat_update(&KrisOS.mutexFastPath, start);
+		
+			start = DWT->CYCCNT;
+			KrisOS_mutex_lock_slow(&benchMtx);
+			KrisOS_mutex_unlock_slow(&benchMtx);
+			cycle_stat_update(&KrisOS.mutexSlowPath, start);
+		
+			// The mutex benchmark task (more urgent) runs as soon as it is 
+			// released, starts its timer and blocks on the mutex held here. 
+			// The unlock hands the mutex over and the task stops its timer.
+			#if defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+				KrisOS_mutex_lock(&contendedMtx);
+				KrisOS_sem_release(&mutexBenchSem);
+				KrisOS_mutex_unlock(&contendedMtx);
+			#endif
+		#endif
+		#ifdef USE_SEMAPHORE
+			start = DWT->CYCCNT;
+			KrisOS_sem_release(&benchSem);
+			KrisOS_sem_acquire(&benchSem);
+			cycle_stat_update(&KrisOS.semFastPath, start);
+		
+			start = DWT->CYCCNT;
+			KrisOS_sem_release_slow(&benchSem);
+			KrisOS_sem_acquire_slow(&benchSem);
+			cycle_stat_update(&KrisOS.semSlowPath, start);
+		
+			// The pong task (more urgent) runs as soon as it is released and 
+			// blocks again once it has answered
+			#ifdef SYNC_BENCHMARK
+				start = DWT->CYCCNT;
+				KrisOS_sem_release(&pingSem);
+				KrisOS_sem_acquire(&pongSem);
+				cycle_stat_update(&KrisOS.semPingPong, start);
+			#endif
+		#endif
+		#if defined SYNC_BENCHMARK && defined USE_BARRIER
+			
+			// The benchmark tasks (more urgent) are already waiting, so the stats
+			// task is the leader of every phase. The phase cost is recorded by
+			// the barriers themselves.
+			for (barrier = 0; barrier < BARRIER_BENCH_NO; barrier++)
+				KrisOS_barrier_wait(&benchBarriers[barrier]);
+		#endif
+		#ifdef USE_QUEUE
+			start = DWT->CYCCNT;
+			KrisOS_queue_write(&benchGenericQueue, &run);
+			KrisOS_queue_read(&benchGenericQueue, &item);
+			cycle_stat_update(&KrisOS.queueGenericPath, start);
+		
+			start = DWT->CYCCNT;
+			benchWordWrite(&benchTypedQueue, &run);
+			benchWordRead(&benchTypedQueue, &item);
+			cycle_stat_update(&KrisOS.queueTypedPath, start);
+		#endif
+		#ifdef USE_RWLOCK
+			start = DWT->CYCCNT;
+			KrisOS_rwlock_read_lock(&benchRwLock);
+			KrisOS_rwlock_read_unlock(&benchRwLock);
+			cycle_stat_update(&KrisOS.rwlockReadPath, start);
+		
+			// The reader tasks (more urgent) run as soon as they are released. 
+			// They take the read lock the stats task holds straight away, but
+			// queue up on the mutex and are handed it one by one after the
+			// stats task unlocks it. Both passes end once all of them are done.
+			#if defined SYNC_BENCHMARK && defined USE_MUTEX && defined USE_SEMAPHORE
+				readersUseMutex = 0;
+				start = DWT->CYCCNT;
+				KrisOS_rwlock_read_lock(&readerRwLock);
+				for (reader = 0; reader < READER_BENCH_TASKS; reader++)
+					KrisOS_sem_release(&readerStartSem);
+				KrisOS_rwlock_read_unlock(&readerRwLock);
+				for (reader = 0; reader < READER_BENCH_TASKS; reader++)
+					KrisOS_sem_acquire(&readerDoneSem);
+				cycle_stat_update(&KrisOS.rwlockReaders, start);
+				
+				readersUseMutex = 1;
+				start = DWT->CYCCNT;
+				KrisOS_mutex_lock(&readerMtx);
+				for (reader = 0; reader < READER_BENCH_TASKS; reader++)
+					KrisOS_sem_release(&readerStartSem);
+				KrisOS_mutex_unlock(&readerMtx);
+				for (reader = 0; reader < READER_BENCH_TASKS; reader++)
+					KrisOS_sem_acquire(&readerDoneSem);
+				cycle_stat_update(&KrisOS.mutexReaders, start);
+			#endif
+		#endif
+		#ifdef USE_NOTIFY
+			start = DWT->CYCCNT;
+			KrisOS_notify(scheduler.runPtr, 0, NOTIFY_INCREMENT);
+			KrisOS_notify_wait(NOTIFY_DECREMENT, TIME_INFINITY);
+			cycle_stat_update(&KrisOS.notifyFastPath, start);
+		
+			start = DWT->CYCCNT;
+			KrisOS_notify_slow(scheduler.runPtr, 0, NOTIFY_INCREMENT);
+			KrisOS_notify_wait_slow(NOTIFY_DECREMENT, TIME_INFINITY);
+			cycle_stat_update(&KrisOS.notifySlowPath, start);
+		#endif
+	}
+}
+#endif
 
 
 
@@ -63,6 +373,100 @@ void idle(void) {
 
 
 
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+/*******************************************************************************
+* Task: 	pong
+* Purpose: 	Answers every ping of the stats task, so that the semaphore 
+*			ping-pong round trip can be measured.
+*******************************************************************************/
+void pong(void) {
+	while(1) {
+		KrisOS_sem_acquire(&pingSem);
+		KrisOS_sem_release(&pongSem);
+	}
+}
+#endif
+
+
+
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_MUTEX && \
+	defined USE_SEMAPHORE
+/*******************************************************************************
+* Task: 	mutexBench
+* Purpose: 	Mutex benchmark task. Every time the stats task releases it, times
+*			a lock of the mutex the stats task holds, from the call until the
+*			mutex is handed over.
+*******************************************************************************/
+void mutexBench(void) {
+	
+	uint32_t start;
+	
+	while(1) {
+		KrisOS_sem_acquire(&mutexBenchSem);
+		start = DWT->CYCCNT;
+		KrisOS_mutex_lock(&contendedMtx);
+		cycle_stat_update(&KrisOS.mutexContended, start);
+		KrisOS_mutex_unlock(&contendedMtx);
+	}
+}
+#endif
+
+
+
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_BARRIER
+/*******************************************************************************
+* Task: 	barrierBench
+* Purpose: 	Barrier benchmark task. Each of the BARRIER_BENCH_TASKS instances 
+*			takes an index when started and synchronises with the stats task
+*			at all the benchmark barriers with more parties than its index + 1.
+*******************************************************************************/
+void barrierBench(void) {
+	
+	// Number of the benchmark tasks started and the index of this one
+	static uint32_t tasksStarted = 0;
+	uint32_t index, barrier;
+	
+	__start_critical();
+	index = tasksStarted++;
+	__end_critical();
+	
+	while(1) {
+		for (barrier = 0; barrier < BARRIER_BENCH_NO; barrier++) {
+			if (benchBarriers[barrier].parties > index + 1)
+				KrisOS_barrier_wait(&benchBarriers[barrier]);
+		}
+	}
+}
+#endif
+
+
+
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_RWLOCK && \
+	defined USE_MUTEX && defined USE_SEMAPHORE
+/*******************************************************************************
+* Task: 	readerBench
+* Purpose: 	Reader benchmark task. Each of the READER_BENCH_TASKS instances 
+*			reads through the lock the stats task has chosen every time the
+*			stats task releases it, and reports back.
+*******************************************************************************/
+void readerBench(void) {
+	while(1) {
+		KrisOS_sem_acquire(&readerStartSem);
+		if (readersUseMutex) {
+			KrisOS_mutex_lock(&readerMtx);
+			KrisOS_mutex_unlock(&readerMtx);
+		}
+		else {
+			KrisOS_rwlock_read_lock(&readerRwLock);
+			KrisOS_rwlock_read_unlock(&readerRwLock);
+		}
+		KrisOS_sem_release(&readerDoneSem);
+	}
+}
+#endif
+
+
+
 #ifdef SHOW_DIAGNOSTIC_DATA
 /*******************************************************************************
 * Task: 	stats
@@ -81,9 +485,11 @@ void stats(void) {
 	uint32_t cpuUsageFrac;
 	float32_t cpuUsage;
 	
-	// The last time the statistics task was run and the current OS timer value
+	// The last time the statistics task was run and the current OS timer value,
+	// read from the kernel information page (the 64-bit reads can't tear)
 	uint64_t lastRun;
 	uint64_t currentTime;
+	KernelInfo info;
 	
 	// Helper variables for iterating through the task registry
 	int32_t index;
@@ -99,18 +505,28 @@ void stats(void) {
 	
 	while(1) {
 		// Reset the usage data
-		scheduler.idleTime = scheduler.contextSwitchNo = 0;
+		scheduler.idleTime = scheduler.contextSwitchNo = scheduler.coalescedRuns = 0;
+		scheduler.wakeEvents = scheduler.mergedWakeups = 0;
 		#ifdef USE_MUTEX
 			KrisOS.maxMtxCriticalSection = 0;
 		#endif
+		#ifdef USE_TOPIC
+			KrisOS.topicDrops = 0;
+		#endif
 		
 		// Take note of the time the task was last run and put it to sleep in order
 		// to take time to gather usage data
-		lastRun = KrisOS.ticks;
+		KrisOS_kernel_info(&info);
+		lastRun = info.ticks;
 		task_sleep(DIAG_DATA_RATE);
 		
 		// Update the current time 
-		currentTime = KrisOS.ticks;
+		KrisOS_kernel_info(&info);
+		currentTime = info.ticks;
+		
+		// Time the synchronisation primitives before the UART mutex is taken, so 
+		// that the priority of the task doesn't affect the results
+		measure_sync_paths();
 		
 		#ifdef USE_MUTEX
 			mutex_lock(&uartMtx);
@@ -131,7 +547,14 @@ void stats(void) {
 			fprintf(&uart, "Measurement period:\t%d ms\n", (uint32_t) (currentTime - lastRun) * 1000 / OS_CLOCK_FREQ);
 			fprintf(&uart, "MCU clock frequency:\t%d Hz\n", SYSTEM_CLOCK_FREQ);
 			fprintf(&uart, "KrisOS clock frequency:\t%d Hz\n", OS_CLOCK_FREQ);
-			fprintf(&uart, "Context switches:\t%d\n", scheduler.contextSwitchNo);
+			fprintf(&uart, "Context switches:\t%d (%d reschedules coalesced)\n", 
+					scheduler.contextSwitchNo, scheduler.coalescedRuns);
+			fprintf(&uart, "Wake-up events:\t\t%d (%d sleeps merged)\n", 
+					scheduler.wakeEvents, scheduler.mergedWakeups);
+			print_cycle_stat("OS timer IRQ latency:", &KrisOS.tickLatency);
+			print_cycle_stat("OS timer IRQ handler:", &KrisOS.tickHandler);
+			fprintf(&uart, "Task control block:\t%d B\n", (uint32_t) sizeof(Task));
+			print_cycle_stat("SVC lock/unlock pair:", &KrisOS.svcRoundTrip);
 			fprintf(&uart, "Tasks:\t\t\t%d\n", scheduler.totalTaskNo);
 			
 			#ifdef USE_MUTEX
@@ -143,14 +566,104 @@ void stats(void) {
 			#ifdef USE_QUEUE
 				fprintf(&uart, "Queues:\t\t\t%d\n", KrisOS.totalQueueNo);
 			#endif
+			#ifdef USE_MAILBOX
+				fprintf(&uart, "Mailboxes:\t\t%d\n", KrisOS.totalMailboxNo);
+			#endif
+			#ifdef USE_TOPIC
+				fprintf(&uart, "Topics:\t\t\t%d (%d samples dropped)\n", KrisOS.totalTopicNo,
+						KrisOS.topicDrops);
+			#endif
+			#ifdef USE_RWLOCK
+				fprintf(&uart, "RW-locks:\t\t%d\n", KrisOS.totalRwLockNo);
+			#endif
+			#ifdef USE_EVENT_GROUP
+				fprintf(&uart, "Event groups:\t\t%d\n", KrisOS.totalEventGroupNo);
+			#endif
+			#ifdef USE_CONDVAR
+				fprintf(&uart, "Condition variables:\t%d\n", KrisOS.totalCondVarNo);
+			#endif
+			#ifdef USE_BARRIER
+				fprintf(&uart, "Barriers:\t\t%d\n", KrisOS.totalBarrierNo);
+			#endif
+			#ifdef USE_SOFT_TIMER
+				fprintf(&uart, "Soft timers:\t\t%d\n", KrisOS.totalTimerNo);
+			#endif
+			#ifdef USE_COROUTINE
+				fprintf(&uart, "Coroutines:\t\t%d\n", KrisOS.totalCoroutineNo);
+			#endif
 			#ifdef USE_HEAP
 				fprintf(&uart, "Heap usage:\t\t%dB/%dB = %d%%\n", heap.heapBytesUsed, HEAP_SIZE, 
 					    heap.heapBytesUsed * 100 / HEAP_SIZE);
 			#endif
 			#ifdef USE_MUTEX
 				fprintf(&uart, "Max mutex lock time:\t%d 'ticks'\n", KrisOS.maxMtxCriticalSection);
+				print_cycle_stat("Mutex (fast path):", &KrisOS.mutexFastPath);
+				print_cycle_stat("Mutex (SVC path):", &KrisOS.mutexSlowPath);
+				#if defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+					print_cycle_stat("Mutex (contended):", &KrisOS.mutexContended);
+				#endif
+				print_cycle_stat("Mutex lock (inherit.):", &KrisOS.mutexInheritLock);
+				print_cycle_stat("Mutex lock (ceiling):", &KrisOS.mutexCeilingLock);
+				fprintf(&uart, "Max inheritance chain:\t%d/%d tasks\n", KrisOS.maxInheritDepth,
+						MTX_INHERIT_MAX_DEPTH);
 			#endif
-
+			#ifdef USE_SEMAPHORE
+				print_cycle_stat("Semaphore (fast path):", &KrisOS.semFastPath);
+				print_cycle_stat("Semaphore (SVC path):", &KrisOS.semSlowPath);
+				#ifdef SYNC_BENCHMARK
+					print_cycle_stat("Semaphore ping-pong:", &KrisOS.semPingPong);
+				#endif
+			#endif
+			#ifdef USE_NOTIFY
+				print_cycle_stat("Notification (fast path):", &KrisOS.notifyFastPath);
+				print_cycle_stat("Notification (SVC path):", &KrisOS.notifySlowPath);
+			#endif
+			#ifdef USE_RWLOCK
+				print_cycle_stat("RW-lock read (fast path):", &KrisOS.rwlockReadPath);
+				#if defined SYNC_BENCHMARK && defined USE_MUTEX && defined USE_SEMAPHORE
+					fprintf(&uart, "RW-lock (%d readers):", READER_BENCH_TASKS + 1);
+					print_cycle_stat("", &KrisOS.rwlockReaders);
+					fprintf(&uart, "Mutex (%d readers):", READER_BENCH_TASKS + 1);
+					print_cycle_stat("", &KrisOS.mutexReaders);
+				#endif
+			#endif
+			#ifdef USE_QUEUE
+				print_cycle_stat("Queue copy (generic):", &KrisOS.queueCopyGeneric);
+				print_cycle_stat("Queue copy (typed):", &KrisOS.queueCopyTyped);
+				print_cycle_stat("Queue write/read (generic):", &KrisOS.queueGenericPath);
+				print_cycle_stat("Queue write/read (typed):", &KrisOS.queueTypedPath);
+			#endif
+			#ifdef USE_PQUEUE
+				for (index = 0; index < PQUEUE_LATENCY_CLASSES; index++) {
+					fprintf(&uart, "PQueue prio %d-%d:", index * (256 / PQUEUE_LATENCY_CLASSES),
+							(index + 1) * (256 / PQUEUE_LATENCY_CLASSES) - 1);
+					print_cycle_stat("", &KrisOS.pqueueLatency[index]);
+				}
+			#endif
+			#ifdef USE_BARRIER
+				print_cycle_stat("Barrier phase (2):", &KrisOS.barrierPhase[0]);
+				print_cycle_stat("Barrier phase (3-4):", &KrisOS.barrierPhase[1]);
+				print_cycle_stat("Barrier phase (5-8):", &KrisOS.barrierPhase[2]);
+				print_cycle_stat("Barrier phase (9+):", &KrisOS.barrierPhase[3]);
+			#endif
+			#ifdef USE_HR_TIMER
+				fprintf(&uart, "HR timer max lateness:\t%d cycles\n", KrisOS.hrTimerMaxLateness);
+			#endif
+			#ifdef USE_WORKQUEUE
+				for (index = 0; index < WORKQUEUE_NO; index++) {
+					fprintf(&uart, "Work queue %d (peak %d):", index, workQueues[index].peakPending);
+					print_cycle_stat("", &workQueues[index].latency);
+					workQueues[index].peakPending = 0;
+				}
+			#endif
+			#ifdef USE_BASIC_TASK
+				fprintf(&uart, "Basic task stack:\t%dB of %dB\n", basic_task_stack_usage(), 
+						BASIC_STACK_SIZE);
+			#endif
+			#ifdef USE_COROUTINE
+				print_cycle_stat("Coroutine step:", &KrisOS.coroutineResume);
+			#endif
+	
 			// Display the task manager (per-task statistics) using the task registry.
 			// Here the purpose os task registry is revealed. It keeps track of all active
 			// tasks regardless of their current state and the queue they are in.
@@ -202,10 +715,16 @@ void stats(void) {
 					case SLEEPING: fprintf(&uart, "SLEEPING\t"); break;
 					case MTX_WAIT: fprintf(&uart, "MUTEX WAIT\t"); break;
 					case SEM_WAIT: fprintf(&uart, "SEM WAIT\t"); break;
+					case RW_WAIT: fprintf(&uart, "RWLOCK WAIT\t"); break;
+					case EVENT_WAIT: fprintf(&uart, "EVENT WAIT\t"); break;
+					case NOTIFY_WAIT: fprintf(&uart, "NOTIFY WAIT\t"); break;
+					case COND_WAIT: fprintf(&uart, "CONDVAR WAIT\t"); break;
+					case BARRIER_WAIT: fprintf(&uart, "BARRIER WAIT\t"); break;
+					case DORMANT: fprintf(&uart, "DORMANT\t\t"); break;
 					case REMOVED: fprintf(&uart, "REMOVED\t"); break;
 					default: break;
 				}
-
+	
 				// Display the type of memory allocation used for the task and its
 				// stack (static/dynamic)
 				switch(iterator->memoryType) {
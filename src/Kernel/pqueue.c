@@ -0,0 +1,383 @@
+/*******************************************************************************
+* File:     	pqueue.c
+* Brief:    	Priority message queue implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 	
+*	A priority queue hands out the most urgent message first. Each message is 
+*	written together with a priority, 0 being the most urgent (just like task 
+*	priorities). Messages of the same priority are read in FIFO order.
+*
+*	The messages are copied by value into fixed-size slots. The order is kept 
+*	by a binary min-heap of small entries (priority, sequence number, slot index),
+*	so writing and reading takes O(log n) entry swaps and the message itself is
+*	copied only once in each direction. The heap array doubles as the free slot
+*	list: the entries past the last one in use hold the indices of the free
+*	slots.
+*
+*	Blocking behaviour is implemented the same way as in queue.c - two semaphores
+*	count the messages stored and the remaining capacity, the blocking calls
+*	are user-level functions made of several SVC calls.
+*
+*	With SHOW_DIAGNOSTIC_DATA enabled the time each message spent in the queue 
+*	(in CPU cycles) is recorded separately for PQUEUE_LATENCY_CLASSES ranges
+*	of priorities.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_PQUEUE
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_is_before
+* Purpose:    	Compare two heap entries
+* Arguments:	
+* 		first, second - entries to compare
+* Returns: 		
+*		1 if 'first' should be read before 'second', 0 otherwise
+--------------------------------------------------------------------------------*/
+static uint32_t pqueue_is_before(const PQueueEntry* first, const PQueueEntry* second) {
+	
+	// Compare the sequence numbers using signed difference so that counter 
+	// wrap-around doesn't break the FIFO order
+	if (first->priority != second->priority)
+		return first->priority < second->priority;
+	return (int32_t) (first->sequence - second->sequence) < 0;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_init
+* Purpose:    	Initialise the priority queue given
+* Arguments:	
+* 		toInit - priority queue to initialise
+*		memory - memory area of PQUEUE_MEMORY_SIZE(capacity, itemSize) bytes
+*				 for the heap and the message slots (word-aligned)
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_init(PriorityQueue* toInit, void* memory, size_t capacity, size_t itemSize) {
+	
+	uint32_t index;
+	
+	// Validate the input parameters
+	TEST_NULL_POINTER(toInit)
+	TEST_NULL_POINTER(memory)
+	TEST_INVALID_SIZE(capacity)
+	TEST_INVALID_SIZE(itemSize)
+	
+	// The heap entries go first, followed by the message slots
+	toInit->heap = memory;
+	toInit->buffer = (uint8_t*) (toInit->heap + capacity);
+	toInit->capacity = capacity;
+	toInit->itemSize = itemSize;
+	toInit->count = 0;
+	toInit->sequence = 0;
+	
+	// All the slots are free
+	for (index = 0; index < capacity; index++)
+		toInit->heap[index].slot = index;
+	
+	sem_init(&toInit->elementsStored, 0);
+	sem_init(&toInit->remainingCapacity, capacity);
+	
+	// Priority queues are counted together with the FIFO ones
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalQueueNo++;
+	#endif
+	kernel_info_count(&kernelInfo.queueNo, 1);
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_create
+* Purpose:    	Create and initialise a priority queue using dynamic memory
+* Arguments:	
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		pointer to the priority queue created
+--------------------------------------------------------------------------------*/
+PriorityQueue* pqueue_create(size_t capacity, size_t itemSize) {
+	
+	PriorityQueue* queueCreated;
+	
+	// Validate the input parameters
+	TEST_INVALID_SIZE(capacity)
+	TEST_INVALID_SIZE(itemSize)
+	
+	queueCreated = malloc(sizeof(PriorityQueue));
+	pqueue_init(queueCreated, malloc(PQUEUE_MEMORY_SIZE(capacity, itemSize)), capacity, 
+				itemSize);
+	return queueCreated;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_delete
+* Purpose:    	Remove the priority queue given
+* Arguments:	
+* 		toDelete - priority queue to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_delete(PriorityQueue* toDelete) {
+	
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		// Check if there are tasks waiting to read/write 
+		if (toDelete->elementsStored.waitingQueue != NULL || 
+			toDelete->remainingCapacity.waitingQueue != NULL) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+		
+		// Update the queue and semaphore counts of the kernel information page
+		kernel_info_count(&kernelInfo.queueNo, -1);
+		kernel_info_count(&kernelInfo.semNo, -2);
+		
+		// The heap and the slots are a single memory block
+		free(toDelete->heap);
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_push
+* Purpose:    	Place the message given in the priority queue. The caller must
+*				have acquired the 'remainingCapacity' semaphore first.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_push(PriorityQueue* queue, const void* item, uint8_t priority) {
+	
+	PQueueEntry entry;
+	uint32_t position;
+	uint32_t parent;
+	
+	__start_critical();
+	{
+		// The entry just past the heap holds a free slot
+		position = queue->count++;
+		entry.slot = queue->heap[position].slot;
+		entry.priority = priority;
+		entry.sequence = queue->sequence++;
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			entry.timeQueued = DWT->CYCCNT;
+		#endif
+		memcpy(queue->buffer + entry.slot * queue->itemSize, item, queue->itemSize);
+		
+		// Sift the new entry up the heap
+		while (position > 0) {
+			parent = (position - 1) >> 1;
+			if (!pqueue_is_before(&entry, &queue->heap[parent]))
+				break;
+			queue->heap[position] = queue->heap[parent];
+			position = parent;
+		}
+		queue->heap[position] = entry;
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_pop
+* Purpose:    	Remove the most urgent message from the priority queue. The caller
+*				must have acquired the 'elementsStored' semaphore first.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_pop(PriorityQueue* queue, void* item) {
+	
+	PQueueEntry last;
+	uint16_t freedSlot;
+	uint32_t position;
+	uint32_t child;
+	
+	__start_critical();
+	{
+		// Copy the most urgent message out
+		freedSlot = queue->heap[0].slot;
+		memcpy(item, queue->buffer + freedSlot * queue->itemSize, queue->itemSize);
+		
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			cycle_stat_update(&KrisOS.pqueueLatency[queue->heap[0].priority / 
+							  (256 / PQUEUE_LATENCY_CLASSES)], queue->heap[0].timeQueued);
+		#endif
+		
+		// Move the last entry to the root and sift it down. Its old position 
+		// becomes the first unused one, so it keeps the freed slot
+		last = queue->heap[--queue->count];
+		queue->heap[queue->count].slot = freedSlot;
+		position = 0;
+		while ((child = (position << 1) + 1) < queue->count) {
+			if (child + 1 < queue->count && 
+				pqueue_is_before(&queue->heap[child + 1], &queue->heap[child]))
+				child++;
+			if (!pqueue_is_before(&queue->heap[child], &last))
+				break;
+			queue->heap[position] = queue->heap[child];
+			position = child;
+		}
+		if (queue->count > 0)
+			queue->heap[position] = last;
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_try_write
+* Purpose:    	Put the message given in the priority queue. Don't wait if the 
+*				queue is full.
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_try_write(PriorityQueue* toWrite, const void* item, uint8_t priority) {
+	
+	TEST_NULL_POINTER(toWrite)
+	
+	if (sem_try_acquire(&toWrite->remainingCapacity) == EXIT_FAILURE) 
+		return EXIT_FAILURE;
+	pqueue_push(toWrite, item, priority);
+	sem_release(&toWrite->elementsStored);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_try_read
+* Purpose:    	Read the most urgent message from the priority queue. Don't wait 
+*				if the queue is empty.
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_try_read(PriorityQueue* toRead, void* item) {
+	
+	TEST_NULL_POINTER(toRead)
+	
+	if (sem_try_acquire(&toRead->elementsStored) == EXIT_FAILURE)
+		return EXIT_FAILURE;
+	pqueue_pop(toRead, item);
+	sem_release(&toRead->remainingCapacity);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_write
+* Purpose:    	Put the message given in the priority queue. Wait if the queue
+*				is full.
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_write(PriorityQueue* toWrite, const void* item, uint8_t priority) {
+	
+	TEST_NULL_POINTER(toWrite)
+	
+	KrisOS_sem_acquire(&toWrite->remainingCapacity);
+	KrisOS_pqueue_push(toWrite, item, priority);
+	KrisOS_sem_release(&toWrite->elementsStored);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_read
+* Purpose:    	Read the most urgent message from the priority queue. Wait if the
+*				queue is empty.
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_read(PriorityQueue* toRead, void* item) {
+	
+	TEST_NULL_POINTER(toRead)
+	
+	KrisOS_sem_acquire(&toRead->elementsStored);
+	KrisOS_pqueue_pop(toRead, item);
+	KrisOS_sem_release(&toRead->remainingCapacity);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_write_ISR
+* Purpose:    	Put the message given in the priority queue while inside ISR 
+*				(don't wait)
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_write_ISR(PriorityQueue* toWrite, const void* item, uint8_t priority) {
+	TEST_ISR_PRIORITY
+	return pqueue_try_write(toWrite, item, priority);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_read_ISR
+* Purpose:    	Read the most urgent message from the priority queue while inside
+*				ISR (don't wait)
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_pqueue_read_ISR(PriorityQueue* toRead, void* item) {
+	TEST_ISR_PRIORITY
+	return pqueue_try_read(toRead, item);
+}
+#endif
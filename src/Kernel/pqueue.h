@@ -0,0 +1,143 @@
+/*******************************************************************************
+* File:     	pqueue.h
+* Brief:    	Header file for pqueue.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_PQUEUE
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_init
+* Purpose:    	Initialise the priority queue given
+* Arguments:	
+* 		toInit - priority queue to initialise
+*		memory - memory area of PQUEUE_MEMORY_SIZE(capacity, itemSize) bytes
+*				 for the heap and the message slots (word-aligned)
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_init(PriorityQueue* toInit, void* memory, size_t capacity, size_t itemSize);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_create
+* Purpose:    	Create and initialise a priority queue using dynamic memory
+* Arguments:	
+*		capacity - number of messages the queue can fit
+*		itemSize - size of a single message
+* Returns: 		
+*		pointer to the priority queue created
+--------------------------------------------------------------------------------*/
+PriorityQueue* pqueue_create(size_t capacity, size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_delete
+* Purpose:    	Remove the priority queue given
+* Arguments:	
+* 		toDelete - priority queue to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_delete(PriorityQueue* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_push
+* Purpose:    	Place the message given in the priority queue. The caller must
+*				have acquired the 'remainingCapacity' semaphore first.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_push(PriorityQueue* queue, const void* item, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_push
+* Purpose:    	Place the message given in the priority queue. SVC call.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_PUSH) KrisOS_pqueue_push(PriorityQueue* queue, const void* item, 
+												   uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_pop
+* Purpose:    	Remove the most urgent message from the priority queue. The caller
+*				must have acquired the 'elementsStored' semaphore first.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_pop(PriorityQueue* queue, void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_pqueue_pop
+* Purpose:    	Remove the most urgent message from the priority queue. SVC call.
+* Arguments:	
+* 		queue - priority queue to update
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_PQUEUE_POP) KrisOS_pqueue_pop(PriorityQueue* queue, void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_try_write
+* Purpose:    	Put the message given in the priority queue. Don't wait if the 
+*				queue is full.
+* Arguments:	
+* 		toWrite - priority queue to write to
+*		item - message to write
+*		priority - message priority, 0 is the most urgent
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_try_write(PriorityQueue* toWrite, const void* item, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	pqueue_try_read
+* Purpose:    	Read the most urgent message from the priority queue. Don't wait 
+*				if the queue is empty.
+* Arguments:	
+* 		toRead - priority queue to read from
+*		item - where to copy the message to
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t pqueue_try_read(PriorityQueue* toRead, void* item);
+
+#endif
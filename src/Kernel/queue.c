@@ -5,7 +5,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	02/03/2017
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 	
 *	KrisOS queue implementation used for communication between tasks and task-
@@ -26,6 +26,20 @@
 *	calls are made so that not all of the queue kernel code runs in Handler mode
 *	and there are windows when the PendSV interrupt can be handled (causing the
 *	context switch of the task which can't write/read to the queue at the moment.
+*
+*	Queues initialised with queue_init_typed carry a table of copy routines 
+*	generated by the KrisOS_queue_typed_template macro. Each routine is compiled
+*	for a single item type, so the item is moved with a direct load/store (or
+*	LDM/STM for larger structs) and the head/tail pointers are advanced by a 
+*	constant instead of calling memcpy with the run-time item size. The macro
+*	also generates write/read routines which call the copy routines directly in
+*	thread mode, so a queue with a single writer and a single reader makes no 
+*	SVC call unless one of them has to block or wake the other. Writing to the
+*	front of a typed queue moves the tail pointer the generated read routine 
+*	moves without a critical section, so it is refused (EXIT_FAILURE). With 
+*	SHOW_DIAGNOSTIC_DATA enabled the cost of both copy paths (in CPU cycles) is
+*	recorded and reported by the stats task, next to a write/read pair through
+*	the generic API and through the generated routines.
 *******************************************************************************/
 #include "kernel.h"
 #include "system.h"
@@ -55,9 +69,10 @@ uint32_t queue_init(Queue* toInit, void* bufferMemory, size_t capacity,
 				
 	// Set the initial values of member variables of the queue to initialise
 	toInit->buffer = bufferMemory;
-	toInit->bufferSize = capacity * itemSize;
+	toInit->bufferEnd = toInit->buffer + capacity * itemSize;
 	toInit->itemSize = itemSize;
 	toInit->head = toInit->tail = toInit->buffer;
+	toInit->ops = NULL;
 	sem_init(&toInit->elementsStored, 0);
 	sem_init(&toInit->remainingCapacity, capacity);
 						
@@ -65,6 +80,31 @@ uint32_t queue_init(Queue* toInit, void* bufferMemory, size_t capacity,
 	#ifdef SHOW_DIAGNOSTIC_DATA
 		KrisOS.totalQueueNo++;
 	#endif	
+	kernel_info_count(&kernelInfo.queueNo, 1);
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	queue_init_typed
+* Purpose:    	Initialise the queue given to use the type-specific copy routines
+* Arguments:	
+* 		toInit - queue to initialise
+*		bufferMemory - pointer to the memory area to be used as data buffer
+*		capacity - buffer memory size (in number of items it can fit)
+*		ops - typed copy routines (defines the item size too)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t queue_init_typed(Queue* toInit, void* bufferMemory, size_t capacity,
+						  const QueueOps* ops) {
+	
+	// Validate the copy routines, the rest is checked by queue_init
+	TEST_NULL_POINTER(ops)
+	
+	queue_init(toInit, bufferMemory, capacity, ops->itemSize);
+	toInit->ops = ops;
 	return EXIT_SUCCESS;
 }
 					
@@ -122,6 +162,10 @@ uint32_t queue_delete(Queue* toDelete) {
 			__end_critical();
 			return EXIT_FAILURE;
 		}
+		
+		// Update the queue and semaphore counts of the kernel information page
+		kernel_info_count(&kernelInfo.queueNo, -1);
+		kernel_info_count(&kernelInfo.semNo, -2);
 			
 		// Free the heap memory occupied by the queue and its buffer (if allocated 
 		// on heap) 
@@ -198,6 +242,37 @@ uint32_t queue_try_read(Queue* toRead, void* item) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	queue_try_write_front
+* Purpose:    	Put the item given at the front of the queue specified, so that it
+*				is read next. Don't wait if the queue is full.
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status, EXIT_FAILURE for a typed queue
+--------------------------------------------------------------------------------*/
+uint32_t queue_try_write_front(Queue* toWrite, const void* item) {
+	
+	// Check if the queue pointer is valid
+	TEST_NULL_POINTER(toWrite)
+	
+	// The tail pointer of a typed queue belongs to its reader
+	if (toWrite->ops != NULL)
+		return EXIT_FAILURE;
+	
+	// Test if the queue is full and the write operation can't be completed
+	if (sem_try_acquire(&toWrite->remainingCapacity) == EXIT_FAILURE) 
+		return EXIT_FAILURE;
+	
+	// Write to the front of the queue and notify the readers
+	queue_enqueue_front(toWrite, item);
+	sem_release(&toWrite->elementsStored);
+	return EXIT_SUCCESS;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	KrisOS_queue_write
 * Purpose:    	Put the item given in the queue specified. Wait if the queue
@@ -209,12 +284,46 @@ uint32_t queue_try_read(Queue* toRead, void* item) {
 *		exit status
 --------------------------------------------------------------------------------*/
 uint32_t KrisOS_queue_write(Queue* toWrite, const void* item) {
+	return KrisOS_queue_write_timed(toWrite, item, TIME_INFINITY);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_read
+* Purpose:    	Read the next item from the queue specified. Wait if the
+*				queue is empty.
+* Arguments:	
+* 		toRead - queue to read from
+*		item - item read from the queue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_read(Queue* toRead, void* item) {
+	return KrisOS_queue_read_timed(toRead, item, TIME_INFINITY);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_write_timed
+* Purpose:    	Put the item given in the queue specified. Wait if the queue
+*				is full, but for no longer than the timeout specified.
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if no space has been freed on time
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_timed(Queue* toWrite, const void* item, uint32_t timeout) {
 	
 	// Check if the queue pointer is valid
 	TEST_NULL_POINTER(toWrite)
 	
-	// Wait to write if necessary
-	KrisOS_sem_acquire(&toWrite->remainingCapacity);
+	// Wait to write if necessary. Give up if the timeout has expired
+	if (KrisOS_sem_acquire_timed(&toWrite->remainingCapacity, timeout) == EXIT_TIMEOUT)
+		return EXIT_TIMEOUT;
 	
 	// Write to the queue
 	KrisOS_queue_enqueue(toWrite, item);
@@ -228,22 +337,24 @@ uint32_t KrisOS_queue_write(Queue* toWrite, const void* item) {
 
 
 /*-------------------------------------------------------------------------------
-* Function:    	KrisOS_queue_read
-* Purpose:    	Read the next item from the queue specified. Wait if the
-*				queue is empty.
+* Function:    	KrisOS_queue_read_timed
+* Purpose:    	Read the next item from the queue specified. Wait if the queue
+*				is empty, but for no longer than the timeout specified.
 * Arguments:	
 * 		toRead - queue to read from
 *		item - item read from the queue
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
 * Returns: 		
-*		exit status
+*		exit status, EXIT_TIMEOUT if no item has arrived on time
 --------------------------------------------------------------------------------*/
-uint32_t KrisOS_queue_read(Queue* toRead, void* item) {
+uint32_t KrisOS_queue_read_timed(Queue* toRead, void* item, uint32_t timeout) {
 	
 	// Check if the queue pointer is valid
 	TEST_NULL_POINTER(toRead)
 	
-	// Wait to read if necessary
-	KrisOS_sem_acquire(&toRead->elementsStored);
+	// Wait to read if necessary. Give up if the timeout has expired
+	if (KrisOS_sem_acquire_timed(&toRead->elementsStored, timeout) == EXIT_TIMEOUT)
+		return EXIT_TIMEOUT;
 	
 	// Read from the queue
 	KrisOS_queue_dequeue(toRead, item);
@@ -256,6 +367,35 @@ uint32_t KrisOS_queue_read(Queue* toRead, void* item) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_write_front
+* Purpose:    	Put the item given at the front of the queue specified, so that it
+*				is read next. Wait if the queue is full.
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status, EXIT_FAILURE for a typed queue
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_front(Queue* toWrite, const void* item) {
+	
+	// Check if the queue pointer is valid
+	TEST_NULL_POINTER(toWrite)
+	
+	// The tail pointer of a typed queue belongs to its reader
+	if (toWrite->ops != NULL)
+		return EXIT_FAILURE;
+	
+	// Wait to write if necessary, then write to the front of the queue and 
+	// notify the readers
+	KrisOS_sem_acquire(&toWrite->remainingCapacity);
+	KrisOS_queue_enqueue_front(toWrite, item);
+	KrisOS_sem_release(&toWrite->elementsStored);
+	return EXIT_SUCCESS;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	queue_enqueue
 * Purpose:    	Place the item given in the queue specified
@@ -267,13 +407,31 @@ uint32_t KrisOS_queue_read(Queue* toRead, void* item) {
 --------------------------------------------------------------------------------*/
 uint32_t queue_enqueue(Queue* queue, const void* item) {
 
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t copyStart;
+	#endif
+	
 	__start_critical();
 	{
-		// Copy-by-value the item to enqueue and update the head pointer
-		memcpy(queue->head, item, queue->itemSize);
-		queue->head += queue->itemSize;
-		if (queue->head == queue->buffer + queue->bufferSize)
-			queue->head = queue->buffer;
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			copyStart = DWT->CYCCNT;
+		#endif
+		
+		// Copy-by-value the item to enqueue and update the head pointer. Typed
+		// queues know the item size at compile time.
+		if (queue->ops != NULL) 
+			queue->ops->enqueue(queue, item);
+		else {
+			memcpy(queue->head, item, queue->itemSize);
+			queue->head += queue->itemSize;
+			if (queue->head == queue->bufferEnd)
+				queue->head = queue->buffer;
+		}
+		
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			cycle_stat_update(queue->ops != NULL ? &KrisOS.queueCopyTyped : 
+							  &KrisOS.queueCopyGeneric, copyStart);
+		#endif
 	}
 	__end_critical();
 	return EXIT_SUCCESS;
@@ -292,13 +450,57 @@ uint32_t queue_enqueue(Queue* queue, const void* item) {
 --------------------------------------------------------------------------------*/
 uint32_t queue_dequeue(Queue* queue, void* item) {
 
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		uint32_t copyStart;
+	#endif
+	
 	__start_critical();
 	{		
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			copyStart = DWT->CYCCNT;
+		#endif
+		
 		// Read the item from the queue and update the tail pointer 
-		memcpy(item, queue->tail, queue->itemSize);
-		queue->tail += queue->itemSize;
-		if (queue->tail == queue->buffer + queue->bufferSize)
-			queue->tail = queue->buffer;
+		if (queue->ops != NULL) 
+			queue->ops->dequeue(queue, item);
+		else {
+			memcpy(item, queue->tail, queue->itemSize);
+			queue->tail += queue->itemSize;
+			if (queue->tail == queue->bufferEnd)
+				queue->tail = queue->buffer;
+		}
+		
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			cycle_stat_update(queue->ops != NULL ? &KrisOS.queueCopyTyped : 
+							  &KrisOS.queueCopyGeneric, copyStart);
+		#endif
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	queue_enqueue_front
+* Purpose:    	Place the item given at the front of the queue specified (in front
+*				of the tail pointer), so that it is read next.
+* Arguments:	
+* 		queue - queue to update
+*		item - item to enqueue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t queue_enqueue_front(Queue* queue, const void* item) {
+
+	__start_critical();
+	{
+		// Step the tail pointer back by one item (with wrap-around) and copy the
+		// item there. Only generic queues can be written to the front.
+		if (queue->tail == queue->buffer)
+			queue->tail = queue->bufferEnd;
+		queue->tail -= queue->itemSize;
+		memcpy(queue->tail, item, queue->itemSize);
 	}
 	__end_critical();
 	return EXIT_SUCCESS;
@@ -316,6 +518,7 @@ uint32_t queue_dequeue(Queue* queue, void* item) {
 *		exit status
 --------------------------------------------------------------------------------*/
 uint32_t KrisOS_queue_write_ISR(Queue* toWrite, const void* item) {
+	TEST_ISR_PRIORITY
 	return queue_try_write(toWrite, item);
 }
 
@@ -331,8 +534,41 @@ uint32_t KrisOS_queue_write_ISR(Queue* toWrite, const void* item) {
 *		exit status
 --------------------------------------------------------------------------------*/
 uint32_t KrisOS_queue_read_ISR(Queue* toRead, void* item) {
+	TEST_ISR_PRIORITY
 	return queue_try_read(toRead, item);
 }
 
 
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_write_front_ISR
+* Purpose:    	Put the item given at the front of the queue specified while inside
+*				ISR (don't wait)
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status, EXIT_FAILURE for a typed queue
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_write_front_ISR(Queue* toWrite, const void* item) {
+	TEST_ISR_PRIORITY
+	return queue_try_write_front(toWrite, item);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_fill_level
+* Purpose:    	Get the number of items waiting in the queue given. A single word
+*				is read, so no SVC call is made and the value can't be torn.
+* Arguments:	
+* 		queue - queue to check
+* Returns: 		
+*		number of items in the queue (not counting the ones being read)
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_queue_fill_level(const Queue* queue) {
+	return queue->elementsStored.counter;
+}
+
+
 #endif
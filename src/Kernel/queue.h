@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	03/03/2017
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -26,6 +26,22 @@
 --------------------------------------------------------------------------------*/
 uint32_t queue_init(Queue* toInit, void* bufferMemory, size_t capacity,
 					size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	queue_init_typed
+* Purpose:    	Initialise the queue given to use the type-specific copy routines
+* Arguments:	
+* 		toInit - queue to initialise
+*		bufferMemory - pointer to the memory area to be used as data buffer
+*		capacity - buffer memory size (in number of items it can fit)
+*		ops - typed copy routines (defines the item size too)
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t queue_init_typed(Queue* toInit, void* bufferMemory, size_t capacity,
+						  const QueueOps* ops);
 					
 
 
@@ -85,6 +101,20 @@ uint32_t queue_try_read(Queue* toRead, void* item);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	queue_try_write_front
+* Purpose:    	Put the item given at the front of the queue specified, so that it
+*				is read next. Don't wait if the queue is full.
+* Arguments:	
+* 		toWrite - queue to write to
+*		item - pointer to the item to be put in the queue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t queue_try_write_front(Queue* toWrite, const void* item);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	queue_enqueue
 * Purpose:    	Place the item given in the queue specified.
@@ -135,4 +165,31 @@ uint32_t queue_dequeue(Queue* queue, void* item);
 --------------------------------------------------------------------------------*/
 uint32_t __svc(SVC_QUEUE_DEQUEUE) KrisOS_queue_dequeue(Queue* queue, void* item);
 
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	queue_enqueue_front
+* Purpose:    	Place the item given at the front of the queue specified (in front
+*				of the tail pointer), so that it is read next.
+* Arguments:	
+* 		queue - queue to update
+*		item - item to enqueue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t queue_enqueue_front(Queue* queue, const void* item);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_queue_enqueue_front
+* Purpose:    	Place the item given at the front of the queue specified. SVC call.
+* Arguments:	
+* 		queue - queue to update
+*		item - item to enqueue
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_QUEUE_ENQUEUE_FRONT) KrisOS_queue_enqueue_front(Queue* queue, const void* item);
+
 #endif 
@@ -0,0 +1,384 @@
+/*******************************************************************************
+* File:     	rwlock.c
+* Brief:    	Reader-writer lock implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	A reader-writer lock protects data which is read often and written rarely,
+*	such as configuration or calibration tables. Any number of readers can hold
+*	the lock at the same time, a writer gets exclusive access.
+*
+*	Writers are preferred: once a writer is waiting, new readers have to wait
+*	too, so a steady stream of readers can't starve the writers. When the last
+*	reader leaves, the lock goes to the most urgent writer waiting. When a
+*	writer leaves, the lock goes to the next writer or, if there is none, to
+*	all readers waiting at once, followed by a single scheduling decision. Both
+*	waiting queues are arranged in descending priority order. There is no
+*	priority inheritance. A reader can't take the lock again while it holds it,
+*	as it would wait behind a writer waiting for the reader to leave.
+*
+*	The state of the lock (writer flags and reader count) is kept in one word.
+*	The user API (KrisOS_rwlock_*) updates it in thread mode with exclusive
+*	load/store (LDREX/STREX), the same way as for mutexes and semaphores. The
+*	SVC call (KrisOS_rwlock_*_slow) is made only if the calling task has to
+*	wait or some other task has to be woken up.
+*
+*	READER-WRITER LOCKS ARE NOT ALLOWED TO BE USED INSIDE INTERRUPT HANDLERS!
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_RWLOCK
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_init
+* Purpose:    	Initialise the reader-writer lock given
+* Arguments:	
+* 		toInit - reader-writer lock to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_init(RwLock* toInit) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toInit)
+	
+	// The lock is free and nobody waits for it
+	toInit->state = 0;
+	toInit->writer = toInit->readQueue = toInit->writeQueue = NULL;
+	
+	// Update the total number of reader-writer locks declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalRwLockNo++;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_create
+* Purpose:    	Create a reader-writer lock using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the reader-writer lock created
+--------------------------------------------------------------------------------*/
+RwLock* rwlock_create(void) {
+	
+	RwLock* toCreate = malloc(sizeof(RwLock));
+	rwlock_init(toCreate);
+	return toCreate;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_delete
+* Purpose:    	Delete the reader-writer lock given
+* Arguments:	
+* 		toDelete - reader-writer lock to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock is held or waited on
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_delete(RwLock* toDelete) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		// Only remove locks which are free
+		if (toDelete->state != 0) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// Update the total number of reader-writer locks declared
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalRwLockNo--;
+		#endif
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_hand_over
+* Purpose:    	Give the lock which has just become free to the tasks waiting:
+*				the most urgent writer or, if there are no writers, all readers
+* Arguments:	
+* 		toHandOver - reader-writer lock to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void rwlock_hand_over(RwLock* toHandOver) {
+	
+	Task* toWake;
+	
+	// Writers are preferred
+	if (toHandOver->writeQueue != NULL) {
+		toWake = toHandOver->writeQueue;
+		task_wake(toWake);
+		toHandOver->writer = toWake;
+		toHandOver->state = RWLOCK_WRITER;
+		if (toHandOver->writeQueue != NULL)
+			toHandOver->state |= RWLOCK_WRITERS_WAITING;
+		scheduler_run();
+	}
+	
+	// Otherwise let all the readers in. They are counted as holding the lock
+	// before they run, so the lock can't be taken by a writer in the meantime.
+	else if (toHandOver->readQueue != NULL) {
+		while (toHandOver->readQueue != NULL) {
+			toWake = toHandOver->readQueue;
+			task_wake(toWake);
+			toHandOver->state++;
+		}
+		scheduler_run();
+	}
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_read_lock
+* Purpose:    	Take the lock for reading. Wait if a writer holds the lock or is
+*				waiting for it.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_read_lock(RwLock* toLock) {
+	
+	TEST_NULL_POINTER(toLock)
+	
+	__start_critical();
+	{
+		// Join the other readers, unless a writer is holding or waiting for
+		// the lock. In such case, the writer lets the reader in when done.
+		if (toLock->state & (RWLOCK_WRITER | RWLOCK_WRITERS_WAITING))
+			task_wait(&toLock->readQueue, toLock, RW_WAIT, TIME_INFINITY);
+		else
+			toLock->state++;
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_read_unlock
+* Purpose:    	Release the lock held for reading
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock isn't held for reading
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_read_unlock(RwLock* toUnlock) {
+	
+	TEST_NULL_POINTER(toUnlock)
+	
+	__start_critical();
+	{
+		if ((toUnlock->state & RWLOCK_READERS) == 0) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+	
+		// The last reader to leave hands the lock over to a writer waiting
+		toUnlock->state--;
+		if ((toUnlock->state & RWLOCK_READERS) == 0)
+			rwlock_hand_over(toUnlock);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_write_lock
+* Purpose:    	Take the lock for writing. Wait if the lock is held.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_write_lock(RwLock* toLock) {
+	
+	TEST_NULL_POINTER(toLock)
+	
+	__start_critical();
+	{
+		// Take the lock if it's free. Otherwise, stop new readers from coming in
+		// and wait until the lock is handed over
+		if (toLock->state == 0) {
+			toLock->state = RWLOCK_WRITER;
+			toLock->writer = scheduler.runPtr;
+		}
+		else {
+			toLock->state |= RWLOCK_WRITERS_WAITING;
+			task_wait(&toLock->writeQueue, toLock, RW_WAIT, TIME_INFINITY);
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_write_unlock
+* Purpose:    	Release the lock held for writing
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task isn't the writer
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_write_unlock(RwLock* toUnlock) {
+	
+	// Test if the calling task actually holds the lock for writing
+	if (toUnlock == NULL || toUnlock->writer != scheduler.runPtr)
+		return EXIT_FAILURE;
+	
+	__start_critical();
+	{
+		toUnlock->writer = NULL;
+		toUnlock->state = 0;
+		rwlock_hand_over(toUnlock);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_lock
+* Purpose:    	Take the lock for reading. Many readers can hold the lock at the
+*				same time. Wait if a writer holds the lock or is waiting for it.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_read_lock(RwLock* toLock) {
+	
+	uint32_t state;
+	TEST_NULL_POINTER(toLock)
+	
+	// Count the calling task in as a reader if there are no writers. Repeat if
+	// an exception has been taken in the meantime.
+	do {
+		state = __ldrex(&toLock->state);
+		if (state & (RWLOCK_WRITER | RWLOCK_WRITERS_WAITING)) {
+			__clrex();
+			return KrisOS_rwlock_read_lock_slow(toLock);
+		}
+	} while (__strex(state + 1, &toLock->state));
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_unlock
+* Purpose:    	Release the lock held for reading
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock isn't held for reading
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_read_unlock(RwLock* toUnlock) {
+	
+	uint32_t state;
+	TEST_NULL_POINTER(toUnlock)
+	
+	// Leave in thread mode, unless the lock has to be handed over to a writer
+	do {
+		state = __ldrex(&toUnlock->state);
+		if ((state & RWLOCK_READERS) == 0) {
+			__clrex();
+			return EXIT_FAILURE;
+		}
+		if ((state & RWLOCK_READERS) == 1 && (state & RWLOCK_WRITERS_WAITING)) {
+			__clrex();
+			return KrisOS_rwlock_read_unlock_slow(toUnlock);
+		}
+	} while (__strex(state - 1, &toUnlock->state));
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_lock
+* Purpose:    	Take the lock for writing (exclusive access). Wait if the lock
+*				is held by readers or another writer.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_write_lock(RwLock* toLock) {
+	
+	TEST_NULL_POINTER(toLock)
+	
+	// Take the lock in thread mode if it's free
+	do {
+		if (__ldrex(&toLock->state) != 0) {
+			__clrex();
+			return KrisOS_rwlock_write_lock_slow(toLock);
+		}
+	} while (__strex(RWLOCK_WRITER, &toLock->state));
+	toLock->writer = scheduler.runPtr;
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_unlock
+* Purpose:    	Release the lock held for writing
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task isn't the writer
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_rwlock_write_unlock(RwLock* toUnlock) {
+	
+	// The calling task
+	Task* self = scheduler.runPtr;
+	
+	// Test if the calling task actually holds the lock for writing
+	if (toUnlock == NULL || toUnlock->writer != self)
+		return EXIT_FAILURE;
+	
+	// Nobody else can touch the writer field while the writer flag is set, so
+	// it can be cleared before the lock is released
+	toUnlock->writer = NULL;
+	
+	// Release the lock in thread mode unless there are tasks waiting for it
+	do {
+		if (__ldrex(&toUnlock->state) != RWLOCK_WRITER || toUnlock->readQueue != NULL) {
+			__clrex();
+			toUnlock->writer = self;
+			return KrisOS_rwlock_write_unlock_slow(toUnlock);
+		}
+	} while (__strex(0, &toUnlock->state));
+	return EXIT_SUCCESS;
+}
+
+
+
+#endif
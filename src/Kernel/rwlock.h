@@ -0,0 +1,150 @@
+/*******************************************************************************
+* File:     	rwlock.h
+* Brief:    	Header file for rwlock.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_RWLOCK
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_init
+* Purpose:    	Initialise the reader-writer lock given
+* Arguments:	
+* 		toInit - reader-writer lock to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_init(RwLock* toInit);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_create
+* Purpose:    	Create a reader-writer lock using dynamic memory allocation
+* Arguments:	-
+* Returns: 		
+*		pointer to the reader-writer lock created
+--------------------------------------------------------------------------------*/
+RwLock* rwlock_create(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_delete
+* Purpose:    	Delete the reader-writer lock given
+* Arguments:	
+* 		toDelete - reader-writer lock to delete
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock is held or waited on
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_delete(RwLock* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_read_lock
+* Purpose:    	Take the lock for reading. Wait if a writer holds the lock or is
+*				waiting for it.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_read_lock(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_read_unlock
+* Purpose:    	Release the lock held for reading
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock isn't held for reading
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_read_unlock(RwLock* toUnlock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_write_lock
+* Purpose:    	Take the lock for writing. Wait if the lock is held.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_write_lock(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	rwlock_write_unlock
+* Purpose:    	Release the lock held for writing
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task isn't the writer
+--------------------------------------------------------------------------------*/
+uint32_t rwlock_write_unlock(RwLock* toUnlock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_lock_slow
+* Purpose:    	Take the lock for reading inside the kernel. SVC call.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_READ_LOCK) KrisOS_rwlock_read_lock_slow(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_read_unlock_slow
+* Purpose:    	Release the lock held for reading inside the kernel, handing it
+*				over to a waiting writer. SVC call.
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the lock isn't held for reading
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_READ_UNLOCK) KrisOS_rwlock_read_unlock_slow(RwLock* toUnlock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_lock_slow
+* Purpose:    	Take the lock for writing inside the kernel. SVC call.
+* Arguments:	
+* 		toLock - reader-writer lock to take
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_WRITE_LOCK) KrisOS_rwlock_write_lock_slow(RwLock* toLock);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_rwlock_write_unlock_slow
+* Purpose:    	Release the lock held for writing inside the kernel, handing it
+*				over to the tasks waiting. SVC call.
+* Arguments:	
+* 		toUnlock - reader-writer lock to release
+* Returns: 		
+*		exit status, EXIT_FAILURE if the calling task isn't the writer
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_RWLOCK_WRITE_UNLOCK) KrisOS_rwlock_write_unlock_slow(RwLock* toUnlock);
+
+#endif
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	21/10/2016
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	The KrisOS scheduler is a priority preemptive scheduler. This means that, 
@@ -32,6 +32,20 @@
 *	task in the queue has become ready, then the scheduler has to further investigate
 *	the blocked queue, but usually not the whole of it (because of sorting).
 *
+*	The blocked queue uses a separate pair of links in the task control block (timer
+*	links). So, a task making a timed wait can be inserted into a synchronisation
+*	object's waiting queue and into the blocked queue at the same time. Whichever
+*	event comes first (object available or timeout) removes the task from the
+*	other queue in constant time. If the timeout wins, the SVC call made by the
+*	task returns EXIT_TIMEOUT. TIMED WAITS CAN ONLY BE MADE THROUGH SVC CALLS.
+*
+*	The scheduler can be locked (scheduler_lock/scheduler_unlock, calls can be
+*	nested). While locked, scheduler_run() only records that rescheduling has
+*	been requested and a single scheduling decision is made at the outermost
+*	unlock. This lets kernel paths (and user tasks) wake several tasks with one
+*	decision. A task which blocks (sleeps, waits on an object, deletes itself)
+*	can't keep the CPU, so blocking while the scheduler is locked is an error.
+*
 *	The currently running task doesn't have a separate queue for itself. It is also
 *	located in the ready queue. If a task is removed, it is permanently deregistered 
 *	from the scheduler.
@@ -40,6 +54,11 @@
 * 	task_complete_handler which removes the task which returns from the scheduler
 *	and deletes it if allocated dynamically.
 *
+*	Besides these (extended) tasks, there can be basic tasks, which run to 
+*	completion on a stack shared by all of them (see basictask.c). They are
+*	kept in the same ready queue, the scheduler only places the frame of 
+*	a basic task on the shared stack when it picks the task to run.
+*
 *	If the SHOW_DIAGNOSTIC_DATA option is enabled, an extra task registry is used
 *	to keep track of all the active tasks, no matter which queue they are in.
 *	This solves the problem of tracking all the tasks between various data structures
@@ -65,6 +84,33 @@
 KrisOS_task_static_template(idle, 256, UINT8_MAX)
 #ifdef SHOW_DIAGNOSTIC_DATA
 	KrisOS_task_static_template(stats, 512, DIAG_DATA_PRIO)
+	#if defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+		KrisOS_task_static_template(pong, 256, DIAG_DATA_PRIO - 1)
+	#endif
+	#if defined SYNC_BENCHMARK && defined USE_MUTEX && defined USE_SEMAPHORE
+		KrisOS_task_static_template(mutexBench, 256, DIAG_DATA_PRIO - 1)
+	#endif
+#endif
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_BARRIER
+	void barrierBench(void);
+	Task barrierBenchTask[BARRIER_BENCH_TASKS];
+	const size_t barrierBenchStackSize = 256;
+	uint8_t barrierBenchStack[BARRIER_BENCH_TASKS][256];
+	const uint8_t barrierBenchPriority = DIAG_DATA_PRIO - 1;
+#endif
+#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_RWLOCK && \
+	defined USE_MUTEX && defined USE_SEMAPHORE
+	void readerBench(void);
+	Task readerBenchTask[READER_BENCH_TASKS];
+	const size_t readerBenchStackSize = 256;
+	uint8_t readerBenchStack[READER_BENCH_TASKS][256];
+	const uint8_t readerBenchPriority = DIAG_DATA_PRIO - 1;
+#endif
+#ifdef USE_SOFT_TIMER
+	KrisOS_task_static_template(timerService, TIMER_TASK_STACK_SIZE, TIMER_TASK_PRIO)
+#endif
+#ifdef USE_COROUTINE
+	KrisOS_task_static_template(coroutineExecutor, COROUTINE_TASK_STACK_SIZE, COROUTINE_TASK_PRIO)
 #endif
 
 
@@ -84,9 +130,18 @@ Scheduler scheduler;
 --------------------------------------------------------------------------------*/
 void scheduler_init(void) {
 	
+	#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && \
+		(defined USE_BARRIER || (defined USE_RWLOCK && defined USE_MUTEX && defined USE_SEMAPHORE))
+		uint32_t i;
+	#endif
+	
 	// Initialise the scheduler queues
 	scheduler.blocked = scheduler.ready = NULL;
 	
+	// The scheduler starts unlocked
+	scheduler.lockDepth = 0;
+	scheduler.reschedulePending = 0;
+	
 	// Start assigning task IDs from 1. (Actually +-1 as system tasks have negative 
 	// IDs and user tasks have positive IDs
 	scheduler.lastIDUsed = 1;
@@ -108,6 +163,62 @@ void scheduler_init(void) {
 		task_create_static(&statsTask, stats, &statsStack[statsStackSize], 
 						   statsPriority, 1);
 	#endif
+	
+	// Create the task answering the stats task in the semaphore ping-pong
+	#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_SEMAPHORE
+		KrisOS_task_stack_usage((uint32_t*) &pongStack[0], pongStackSize);
+		task_create_static(&pongTask, pong, &pongStack[pongStackSize], pongPriority, 1);
+	#endif
+	
+	// Create the task timing contended locks of a mutex held by the stats task
+	#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_MUTEX && \
+		defined USE_SEMAPHORE
+		KrisOS_task_stack_usage((uint32_t*) &mutexBenchStack[0], mutexBenchStackSize);
+		task_create_static(&mutexBenchTask, mutexBench, &mutexBenchStack[mutexBenchStackSize], 
+						   mutexBenchPriority, 1);
+	#endif
+	
+	// Create the tasks synchronising with the stats task at the benchmark barriers
+	#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_BARRIER
+		for (i = 0; i < BARRIER_BENCH_TASKS; i++) {
+			KrisOS_task_stack_usage((uint32_t*) &barrierBenchStack[i][0], barrierBenchStackSize);
+			task_create_static(&barrierBenchTask[i], barrierBench, 
+							   &barrierBenchStack[i][barrierBenchStackSize], 
+							   barrierBenchPriority, 1);
+		}
+	#endif
+	
+	// Create the tasks reading next to the stats task in the contended reader
+	// benchmark
+	#if defined SHOW_DIAGNOSTIC_DATA && defined SYNC_BENCHMARK && defined USE_RWLOCK && \
+		defined USE_MUTEX && defined USE_SEMAPHORE
+		for (i = 0; i < READER_BENCH_TASKS; i++) {
+			KrisOS_task_stack_usage((uint32_t*) &readerBenchStack[i][0], readerBenchStackSize);
+			task_create_static(&readerBenchTask[i], readerBench, 
+							   &readerBenchStack[i][readerBenchStackSize], 
+							   readerBenchPriority, 1);
+		}
+	#endif
+	
+	// Create the task running the software timer callbacks
+	#ifdef USE_SOFT_TIMER
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS_task_stack_usage((uint32_t*) &timerServiceStack[0], timerServiceStackSize);
+		#endif
+		task_create_static(&timerServiceTask, timerService, 
+						   &timerServiceStack[timerServiceStackSize], timerServicePriority, 1);
+	#endif
+	
+	// Create the task running the coroutines
+	#ifdef USE_COROUTINE
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS_task_stack_usage((uint32_t*) &coroutineExecutorStack[0], 
+									coroutineExecutorStackSize);
+		#endif
+		task_create_static(&coroutineExecutorTask, coroutineExecutor, 
+						   &coroutineExecutorStack[coroutineExecutorStackSize], 
+						   coroutineExecutorPriority, 1);
+	#endif
 		
 	// Set the runPtr to the idle task
 	scheduler.runPtr = &idleTask;
@@ -130,6 +241,18 @@ uint32_t scheduler_run(void) {
 	
 	__start_critical();
 	{
+		// While the scheduler is locked, only take note of the request. The 
+		// decision is made once, when the scheduler gets unlocked
+		if (scheduler.lockDepth) {
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				if (scheduler.reschedulePending)
+					scheduler.coalescedRuns++;
+			#endif
+			scheduler.reschedulePending = 1;
+			__end_critical();
+			return EXIT_SUCCESS;
+		}
+		
 		// Pick either the top priority ready task (first in the ready queue) or 
 		// (if the time-sliced preemption flag is set) the task next in queue with 
 		// respect to the currently running one, if its priority is equal to the
@@ -139,6 +262,22 @@ uint32_t scheduler_run(void) {
 		else
 			scheduler.topPrioTask = scheduler.ready;
 		
+		// A basic task gets its frame on the shared stack when it is picked to run
+		// for the first time since its activation (or its start is postponed)
+		#ifdef USE_BASIC_TASK
+			scheduler.topPrioTask = basic_task_dispatch(scheduler.topPrioTask);
+		#endif
+		
+		// Publish the task to run. It is also done when the scheduler returns 
+		// to the running task before a pending context switch has been made.
+		// The switches themselves are counted by the context switching code
+		// (see startup.s), as not every decision ends in one.
+		if (kernelInfo.runningTask != scheduler.topPrioTask) {
+			KrisOS_seqlock_write_begin(&kernelInfo.lock);
+			kernelInfo.runningTask = scheduler.topPrioTask;
+			KrisOS_seqlock_write_end(&kernelInfo.lock);
+		}
+		
 		// Perform context-switch only if the next task to run is different from the 
 		// current one, according to the scheduling policy
 		if (scheduler.topPrioTask != scheduler.runPtr) {
@@ -169,6 +308,56 @@ uint32_t scheduler_run(void) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	scheduler_lock
+* Purpose:    	Lock the scheduler. Until the matching scheduler_unlock, requests
+*				to reschedule are only recorded, so the running task can't be
+*				preempted by other tasks. Calls can be nested.
+* Arguments:	-
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t scheduler_lock(void) {
+	
+	__start_critical();
+	{
+		scheduler.lockDepth++;
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	scheduler_unlock
+* Purpose:    	Unlock the scheduler. At the outermost unlock, the scheduler is run
+*				once if any rescheduling was requested while it was locked.
+* Arguments:	-
+* Returns: 
+* 		exit status, EXIT_FAILURE if the scheduler isn't locked
+--------------------------------------------------------------------------------*/
+uint32_t scheduler_unlock(void) {
+	
+	__start_critical();
+	{
+		if (scheduler.lockDepth == 0) {
+			__end_critical();
+			return EXIT_FAILURE;
+		}
+		
+		// Make the scheduling decision deferred while the scheduler was locked
+		if (--scheduler.lockDepth == 0 && scheduler.reschedulePending) {
+			scheduler.reschedulePending = 0;
+			scheduler_run();
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	scheduler_wake_tasks
 * Purpose:    	Wake all the tasks from the blocked queue which are now ready
@@ -177,26 +366,69 @@ uint32_t scheduler_run(void) {
 --------------------------------------------------------------------------------*/
 void scheduler_wake_tasks(void) {
 	
-	// Pointer to the task to wake
+	// Pointer to the task to wake and the task after it in the blocked queue
 	Task* toWake;
+	Task* next;
+	
+	// Synchronisation object and the status of a task whose timed wait has expired
+	void* waitingObj;
+	TaskState status;
 	
 	__start_critical();
 	{
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			scheduler.wakeEvents++;
+		#endif
+		
 		// Go through the blocked queue until a 'not ready' task is encountered (task are 
 		// sorted in ascending delay time, so as soon as we encounter a task with wait
 		// counter greated than current OS 'ticks' value then the search for task
 		// to wake is over.
-		while (scheduler.blocked != NULL && scheduler.blocked->waitCounter <= KrisOS.ticks) {
-			
-			// Remove the ready task from delayed queue and reset its wait counter
+		while (scheduler.blocked != NULL && !TIME_BEFORE(KrisOS.ticks, scheduler.blocked->waitCounter)) {
 			toWake = scheduler.blocked;
-			task_remove(&scheduler.blocked, toWake);
-			toWake->waitCounter = 0;
 			
-			// Insert the task back to the ready queue
-			toWake->status = READY;
-			task_add(&scheduler.ready, toWake);
+			// A sleeping task simply becomes ready. So does a task waiting for a
+			// notification, its SVC call returns 0 set before it has blocked.
+			if (toWake->waitQueue == NULL) {
+				task_wake(toWake);
+				continue;
+			}
+			
+			// Timed wait has expired. Take the task off the object's waiting queue
+			// and make its SVC call return the timeout status. An event group wait
+			// returns the flags which satisfied it, so no flags (0) means timeout.
+			waitingObj = toWake->waitingObj;
+			status = toWake->status;
+			task_wake(toWake);
+			#ifdef USE_EVENT_GROUP
+				task_set_return_value(toWake, status == EVENT_WAIT ? 0 : EXIT_TIMEOUT);
+			#else
+				task_set_return_value(toWake, EXIT_TIMEOUT);
+			#endif
+			
+			// The mutex owner might have inherited the priority of the task which
+			// has just given up waiting
+			#ifdef USE_MUTEX
+				if (status == MTX_WAIT)
+					mutex_update_owner_prio(waitingObj);
+			#endif
+		}
+		
+		// Wake-up coalescing. Wake the sleeping tasks whose slack window has 
+		// already opened together with the tasks woken above, instead of waking
+		// each of them at its own 'tick' later. Only the tasks due within 
+		// TIMER_SLACK_MAX 'ticks' can have an open window.
+		for (toWake = scheduler.blocked; toWake != NULL && 
+			 !TIME_BEFORE(KrisOS.ticks + TIMER_SLACK_MAX, toWake->waitCounter); toWake = next) {
+			next = toWake->timerNext;
+			if (!TIME_BEFORE(KrisOS.ticks, toWake->waitCounter - toWake->waitSlack)) {
+				task_wake(toWake);
+				#ifdef SHOW_DIAGNOSTIC_DATA
+					scheduler.mergedWakeups++;
+				#endif
+			}
 		}
+		
 		// Reschedule tasks as the state of ready queue has changed
 		scheduler_run();
 	}
@@ -304,58 +536,68 @@ uint32_t task_create_static(Task* toDeclare,  void* startAddr, void* stackBottom
 * Returns: 
 * 		exit status
 --------------------------------------------------------------------------------*/
-uint32_t task_sleep(uint64_t delay) {
+uint32_t task_sleep(uint32_t delay) {
+	return task_sleep_slack(delay, scheduler.runPtr->timerSlack);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_sleep_slack
+* Purpose:    	Suspend the execution of the currently running task for at least
+* 				the number of OS ticks given, allowing the wake-up to be delayed by
+*				the slack given, so that it can be shared with other tasks.
+* Arguments: 	
+*		delay - minimum number of OS 'ticks' to suspend execution of the task by
+*		slack - number of 'ticks' the wake-up can be delayed by 
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_sleep_slack(uint32_t delay, uint32_t slack) {
+	
+	// Pointer to the task to delay
+	Task* toDelay;
+	
+	// Iterator through the list of mutexes held by the task
+	#ifdef USE_MUTEX
+		Mutex* mutexIterator;
+		Mutex* nextMutex;
+	#endif
 	
-	// Iterators trough the delayed queue and a pointer to the task to delay
-	Task *iterator, *previous, *toDelay;
+	// The running task can't keep the CPU if it sleeps
+	TEST_SCHEDULER_UNLOCKED
+	TEST_NOT_BASIC_TASK
 	
 	__start_critical();
 	{			
-		// Only the currently executing task can delay itself. So, remove the
-		// calling task from the ready queue
+		// Release the locks the calling task owns, except for the priority ceiling
+		// mutexes. This is done while the task is still ready, so its priority
+		// can be restored.
 		toDelay = scheduler.runPtr;
-		task_remove(&scheduler.ready, toDelay);
-		
-		// Release a (potential) lock the calling tasks might own		
 		#ifdef USE_MUTEX 	
-			mutex_unlock(toDelay->mutexHeld);
+			for (mutexIterator = toDelay->mutexHeld; mutexIterator != NULL; 
+				 mutexIterator = nextMutex) {
+				nextMutex = mutexIterator->nextHeld;
+				if (mutexIterator->ceiling == MTX_NO_CEILING)
+					mutex_unlock(mutexIterator);
+			}
 		#endif		
 		
-		// Update the wait counter and the task status. If the task is suspended
-		// without a timout, set its waitCounter to the maximum value possible
-		toDelay->waitCounter = delay == TIME_INFINITY ? UINT64_MAX : KrisOS.ticks + delay;
+		// Only the currently executing task can delay itself. So, remove the
+		// calling task from the ready queue
+		task_remove(&scheduler.ready, toDelay);
+		
+		// Update the task status 
 		toDelay->status = SLEEPING;
 		
 		// The state of the ready queue has changed so rescheduling is necessary
 		scheduler_run();
 		
-		// Insert the task to the queue with delayed tasks. Insertion sort is 
-		// performed in ascending 'waitCounter' value order.
-		toDelay->next = toDelay->previous = NULL;
-		
-		// The queue is empty case:
-		if (scheduler.blocked == NULL) {
-			scheduler.blocked = toDelay;
-		}
-		// The task to insert to the delayed queue will be the soonest to wake,
-		// inserted at the beginning case:
-		else if (toDelay->waitCounter <= scheduler.blocked->waitCounter) {
-			toDelay->next = scheduler.blocked;
-			scheduler.blocked->previous = toDelay;
-			scheduler.blocked = toDelay;
-		}
-		// Iterate through the queue until the right spot is found 
-		else {
-			iterator = scheduler.blocked;
-			while (iterator != NULL && toDelay->waitCounter > iterator->waitCounter) {
-				previous = iterator;
-				iterator = iterator->next;
-			}
-			toDelay->previous = previous;
-			toDelay->next = iterator;
-			previous->next = toDelay;
-			if (iterator != NULL)
-				iterator->previous = toDelay;
+		// Insert the task to the queue with delayed tasks. A task suspended 
+		// without a timeout is never woken, so it doesn't need to be queued.
+		if (delay != TIME_INFINITY) {
+			toDelay->waitSlack = (slack > TIMER_SLACK_MAX) ? TIMER_SLACK_MAX : slack;
+			timer_add(toDelay, delay);
 		}
 	}
 	__end_critical();
@@ -364,6 +606,26 @@ uint32_t task_sleep(uint64_t delay) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_slack
+* Purpose:    	Set the wake-up slack used by the KrisOS_task_sleep calls of the
+*				running task (TIMER_SLACK_DEFAULT initially)
+* Arguments: 	
+*		slack - number of 'ticks' the wake-ups can be delayed by (at most 
+*				TIMER_SLACK_MAX)
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_set_slack(uint32_t slack) {
+	
+	if (slack > TIMER_SLACK_MAX)
+		return EXIT_FAILURE;
+	scheduler.runPtr->timerSlack = slack;
+	return EXIT_SUCCESS;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	task_delete
 * Purpose:    	Remove the currently running (calling) task from the scheduler and
@@ -375,6 +637,8 @@ uint32_t task_sleep(uint64_t delay) {
 uint32_t task_delete(void) {
 	
 	Task* toDelete;
+	TEST_SCHEDULER_UNLOCKED
+	TEST_NOT_BASIC_TASK
 	__start_critical();
 	{	
 		// Task registry iterator
@@ -394,10 +658,14 @@ uint32_t task_delete(void) {
 				index++;
 			scheduler.taskRegistry[index] = scheduler.taskRegistry[--scheduler.totalTaskNo];
 		#endif
+		KrisOS_seqlock_write_begin(&kernelInfo.lock);
+		kernelInfo.taskNo--;
+		KrisOS_seqlock_write_end(&kernelInfo.lock);
 		
-		// Release a (potential) lock the calling tasks might own			
+		// Release all the locks the calling task owns
 		#ifdef USE_MUTEX 	
-			mutex_unlock(toDelete->mutexHeld);
+			while (toDelete->mutexHeld != NULL)
+				mutex_unlock(toDelete->mutexHeld);
 		#endif	
 		
 		// Free the heap memory the task occupies (if any)
@@ -498,6 +766,236 @@ uint32_t task_remove(Task** queue, Task* toRemove) {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	timer_add
+* Purpose:    	Set the wake-up time of the task given and add it to the blocked 
+*				queue in ascending 'waitCounter' order. The timer links of the task
+*				are used, so the task can be at the same time inserted to a 
+*				synchronisation object's waiting queue.
+* Arguments: 	
+* 		toInsert - task to insert
+*		delay - number of OS 'ticks' to wake the task after (at most TIME_MAX_DELAY)
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void timer_add(Task* toInsert, uint32_t delay) {
+	
+	// Iterators through the blocked queue
+	Task* iterator;
+	Task* previous;
+	
+	__start_critical();
+	{
+		// Longer delays would wrap around and be compared as past times. The 
+		// queue is sorted by the latest wake-up time (with the slack).
+		if (delay > TIME_MAX_DELAY - toInsert->waitSlack)
+			delay = TIME_MAX_DELAY - toInsert->waitSlack;
+		toInsert->waitCounter = KrisOS.ticks + delay + toInsert->waitSlack;
+		
+		// The queue is empty case:
+		if (scheduler.blocked == NULL) {
+			toInsert->timerNext = toInsert->timerPrevious = NULL;
+			scheduler.blocked = toInsert;
+		}
+		// The task to insert to the blocked queue will be the soonest to wake,
+		// inserted at the beginning case:
+		else if (!TIME_BEFORE(scheduler.blocked->waitCounter, toInsert->waitCounter)) {
+			toInsert->timerNext = scheduler.blocked;
+			toInsert->timerPrevious = NULL;
+			scheduler.blocked->timerPrevious = toInsert;
+			scheduler.blocked = toInsert;
+		}
+		// Iterate through the queue until the right spot is found 
+		else {
+			iterator = scheduler.blocked;
+			while (iterator != NULL && TIME_BEFORE(iterator->waitCounter, toInsert->waitCounter)) {
+				previous = iterator;
+				iterator = iterator->timerNext;
+			}
+			toInsert->timerPrevious = previous;
+			toInsert->timerNext = iterator;
+			previous->timerNext = toInsert;
+			if (iterator != NULL)
+				iterator->timerPrevious = toInsert;
+		}
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	timer_remove
+* Purpose:    	Remove the task given from the blocked queue
+* Arguments: 	
+* 		toRemove - task to remove
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void timer_remove(Task* toRemove) {
+	
+	__start_critical();
+	{	
+		// Join the neighbours of the task to remove together
+		if (toRemove->timerPrevious != NULL)
+			toRemove->timerPrevious->timerNext = toRemove->timerNext;
+		if (toRemove->timerNext != NULL)
+			toRemove->timerNext->timerPrevious = toRemove->timerPrevious;
+		
+		// If the task to remove is at the start of the queue then update the queue head 
+		if (scheduler.blocked == toRemove) 
+			scheduler.blocked = toRemove->timerNext;
+		
+		// The task is no longer waiting for a timeout
+		toRemove->timerNext = toRemove->timerPrevious = NULL;
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_wait
+* Purpose:    	Block the currently running task on the waiting queue given. If the
+*				timeout is finite, the task is also added to the blocked queue, so
+*				that it is woken by whichever event comes first.
+* Arguments: 	
+*		waitQueue - waiting queue of the synchronisation object (NULL if the task
+*					is woken directly, e.g. by a notification)
+*		waitingObj - synchronisation object waited on
+*		status - new status of the calling task (MTX_WAIT/SEM_WAIT/...)
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_wait(Task** waitQueue, void* waitingObj, TaskState status, uint32_t timeout) {
+	
+	Task* toWait;
+	TEST_SCHEDULER_UNLOCKED
+	TEST_NOT_BASIC_TASK
+	
+	__start_critical();
+	{
+		// Remove the calling task from the ready queue and link it with the 
+		// synchronisation object
+		toWait = scheduler.runPtr;
+		task_remove(&scheduler.ready, toWait);
+		toWait->status = status;
+		toWait->waitingObj = waitingObj;
+		toWait->waitQueue = waitQueue;
+		
+		// The state of the ready queue has changed so rescheduling is necessary
+		scheduler_run();
+		
+		// Add the calling task to the object's waiting queue (if there is one) and,
+		// if the wait is bounded, to the blocked queue as well
+		if (waitQueue != NULL)
+			task_add(waitQueue, toWait);
+		if (timeout != TIME_INFINITY) {
+			toWait->waitSlack = 0;
+			timer_add(toWait, timeout);
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_wake
+* Purpose:    	Remove the task given from the waiting queue it is blocked on and
+*				from the blocked queue (if it has a timeout set) and make it ready.
+*				The scheduler has to be run by the caller.
+* Arguments: 	
+*		toWake - task to wake
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_wake(Task* toWake) {
+	
+	__start_critical();
+	{
+		// Take the task off the synchronisation object's waiting queue
+		if (toWake->waitQueue != NULL) {
+			task_remove(toWake->waitQueue, toWake);
+			toWake->waitQueue = NULL;
+		}
+		toWake->waitingObj = NULL;
+		
+		// Cancel the timeout (if any). Every wake-up time is valid, so the task
+		// is on the blocked queue only if it is linked into it. 
+		if (toWake->timerPrevious != NULL || scheduler.blocked == toWake)
+			timer_remove(toWake);
+		
+		// Insert the task back to the ready queue
+		toWake->status = READY;
+		task_add(&scheduler.ready, toWake);
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_priority
+* Purpose:    	Change the priority of the task given and re-insert it into the 
+*				queue it currently belongs to, so that the queue stays sorted.
+* Arguments: 	
+*		toUpdate - task to update
+*		priority - new priority of the task
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_set_priority(Task* toUpdate, uint8_t priority) {
+	
+	// Queue the task belongs to (none if the task is sleeping)
+	Task** queue;
+	
+	__start_critical();
+	{
+		if (toUpdate->status == READY || toUpdate->status == RUNNING)
+			queue = &scheduler.ready;
+		else
+			queue = toUpdate->waitQueue;
+		
+		if (queue != NULL) 
+			task_remove(queue, toUpdate);
+		toUpdate->priority = priority;
+		if (queue != NULL)
+			task_add(queue, toUpdate);
+	}
+	__end_critical();
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_return_value
+* Purpose:    	Overwrite the value the SVC call made by the task given returns
+*				(R0 register value in the task's exception stack frame)
+* Arguments: 	
+*		toUpdate - task blocked inside an SVC call
+*		value - value to return
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_set_return_value(Task* toUpdate, uint32_t value) {
+	
+	// Pointer to the saved R0 register value
+	uint32_t* taskFramePtr;
+	
+	// If the task hasn't been switched out yet (the PendSV is still pending), its 
+	// exception stack frame is on top of the process stack. Otherwise, skip the 
+	// registers saved by the context switch (and the floating-point context, if any)
+	if (toUpdate == scheduler.runPtr) {
+		taskFramePtr = (uint32_t*) __get_psp();
+	}
+	else {
+		taskFramePtr = (uint32_t*) (toUpdate->sp + (STACK_FRAME_R0 << 2));
+		if (!(*((uint32_t*) toUpdate->sp) & (1 << EXC_RETURN_FTYPE)))
+			taskFramePtr += STACK_FRAME_FP_SIZE;
+	}
+	*taskFramePtr = value;
+}
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	task_init
 * Purpose:    	Initialise the task control block and stack frame for the task specified
@@ -511,24 +1009,96 @@ uint32_t task_remove(Task** queue, Task* toRemove) {
 --------------------------------------------------------------------------------*/
 uint32_t task_init(Task* toInit, void* startAddr, uint8_t isPrivileged, uint8_t priority) {
 	
-	// Helper pointer for specifying an address within the task's stack where specific
-	// register values are stored
-	uint32_t* taskFramePtr; 
+	// Initialise the task control block and the initial stack frame
+	task_control_init(toInit, isPrivileged, priority);
+	task_frame_init(toInit, startAddr, task_complete_handler, isPrivileged);
+	
+	__start_critical();
+	{
+		// Update the total number of tasks registered at the scheduler and reset the CPU usage counter
+		#ifdef SHOW_DIAGNOSTIC_DATA	
+			scheduler.taskRegistry[scheduler.totalTaskNo++] = toInit;
+			toInit->cpuUsage = 0;
+		#endif
+		KrisOS_seqlock_write_begin(&kernelInfo.lock);
+		kernelInfo.taskNo++;
+		KrisOS_seqlock_write_end(&kernelInfo.lock);
+		
+		// Insert the task to the ready queue in descending priority order and reschedule
+		// task if OS is already running
+		task_add(&scheduler.ready, toInit);
+		if (KrisOS.isRunning)
+			scheduler_run();
+	} 
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_control_init
+* Purpose:    	Initialise the fields of the task control block given and assign
+*				the task its ID
+* Arguments: 	
+*		toInit - pointer to the task control block to initialise
+*		isPrivileged - 1 if the task to initialise should be priviliged, 0 otherwise
+*		priority - priority of the task to initialise
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_control_init(Task* toInit, uint8_t isPrivileged, uint8_t priority) {
 	
 	// Initialise the fields in the task control block
 	toInit->basePrio = toInit->priority = priority;
 	toInit->status = READY;
 	toInit->waitCounter = 0;
 	toInit->waitingObj = NULL;
+	toInit->waitQueue = NULL;
+	toInit->timerNext = toInit->timerPrevious = NULL;
+	toInit->timerSlack = TIMER_SLACK_DEFAULT;
+	toInit->waitSlack = 0;
 	
 	// Initially tasks don't own any mutual exclusion locks
 	#ifdef USE_MUTEX
 		toInit->mutexHeld = NULL;
 	#endif
 	
+	// No notification is pending
+	#ifdef USE_NOTIFY
+		toInit->notifyValue = 0;
+	#endif
+	
+	// Tasks are extended ones (with a private stack) unless made basic tasks
+	#ifdef USE_BASIC_TASK
+		toInit->entry = NULL;
+		toInit->basicBelow = NULL;
+		toInit->activations = toInit->isStarted = 0;
+		toInit->isPrivileged = isPrivileged;
+	#endif
+	
 	// System tasks have negative IDs while user ones have positive IDs.
 	toInit->id = isPrivileged ? -scheduler.lastIDUsed : scheduler.lastIDUsed;
 	scheduler.lastIDUsed++;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_frame_init
+* Purpose:    	Initialise the stack frame the task given is started with. The 
+*				frame is placed at the task's SP value.
+* Arguments: 	
+*		toInit - pointer to the task to have the stack frame initialised
+*		startAddr - address of the first instruction of the task
+*		returnAddr - address the task returns to once completed
+*		isPrivileged - 1 if the task should be priviliged, 0 otherwise
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_frame_init(Task* toInit, void* startAddr, void* returnAddr, uint8_t isPrivileged) {
+	
+	// Helper pointer for specifying an address within the task's stack where specific
+	// register values are stored
+	uint32_t* taskFramePtr; 
 
 	// Set the initial PC register value to the starting address of task's code
 	taskFramePtr = (uint32_t*) (toInit->sp + (STACK_FRAME_PC << 2));	
@@ -537,7 +1107,7 @@ uint32_t task_init(Task* toInit, void* startAddr, uint8_t isPrivileged, uint8_t
 	// Set the initial LR register value to the method for handling completed
 	// tasks, the ones which have returned
 	taskFramePtr = (uint32_t*) (toInit->sp + (STACK_FRAME_LR << 2));				   
-	*taskFramePtr = (uint32_t) task_complete_handler;
+	*taskFramePtr = (uint32_t) returnAddr;
 	
 	// Set the initial value of xPSR register (see scheduler.h)
 	taskFramePtr = (uint32_t*) (toInit->sp + (STACK_FRAME_xPSR << 2));				   
@@ -551,23 +1121,6 @@ uint32_t task_init(Task* toInit, void* startAddr, uint8_t isPrivileged, uint8_t
 	// This will specify access level of the task.
 	taskFramePtr = (uint32_t*) (toInit->sp + (STACK_FRAME_CONTROL << 2));				   
 	*taskFramePtr = isPrivileged ? 0x2 : 0x3;
-	
-	__start_critical();
-	{
-		// Update the total number of tasks registered at the scheduler and reset the CPU usage counter
-		#ifdef SHOW_DIAGNOSTIC_DATA	
-			scheduler.taskRegistry[scheduler.totalTaskNo++] = toInit;
-			toInit->cpuUsage = 0;
-		#endif
-		
-		// Insert the task to the ready queue in descending priority order and reschedule
-		// task if OS is already running
-		task_add(&scheduler.ready, toInit);
-		if (KrisOS.isRunning)
-			scheduler_run();
-	} 
-	__end_critical();
-	return EXIT_SUCCESS;
 }
 
 
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	04/11/2016
-* Last mod: 	14/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -33,6 +33,15 @@
 
 
 
+/*-------------------------------------------------------------------------------
+* Number of words of floating-point context (S16-S31) saved on top of the exception
+* stack frame, if the EXC_RETURN bit 4 of the task is cleared 
+*------------------------------------------------------------------------------*/
+#define STACK_FRAME_FP_SIZE 16
+#define EXC_RETURN_FTYPE 4
+
+
+
 /*-------------------------------------------------------------------------------
 * Initial value of xPSR register set for each task (only Thumb mode bit set)
 *------------------------------------------------------------------------------*/
@@ -69,11 +78,17 @@ typedef struct {
 	Task* blocked; 							// Blocked tasks queue
 	int32_t lastIDUsed; 					// Last task ID assigned (used for unique ID assignment)
 	uint8_t preemptFlag; 					// Time sliced preemption flag. 1 if 
-#ifdef SHOW_DIAGNOSTIC_DATA 				// preemption should be performed.
+											// preemption should be performed.
+	uint32_t lockDepth; 					// Scheduler lock nesting counter
+	uint8_t reschedulePending; 				// 1 if scheduling was requested while locked
+#ifdef SHOW_DIAGNOSTIC_DATA 				
 	uint32_t idleTime; 						// Number of OS 'ticks' the idle task has been running for
 	uint32_t contextSwitchNo; 				// Context switch counter
+	uint32_t coalescedRuns; 				// Scheduling requests merged by the scheduler lock
+	uint32_t wakeEvents; 					// Blocked queue wake-ups (OS 'ticks' waking tasks)
+	uint32_t mergedWakeups; 				// Sleeps ended early to share another wake-up
 	uint32_t totalTaskNo; 					// Total number of tasks declared
-	Task* taskRegistry[TASK_REGISTRY_SIZE]; // Size of the task registry 
+	Task* taskRegistry[TASK_REGISTRY_SIZE + SYNC_BENCH_TASK_NO]; // Size of the task registry 
 #endif
 } Scheduler; 								
 
@@ -81,6 +96,15 @@ extern Scheduler scheduler;
 
 
 
+/*-------------------------------------------------------------------------------
+* Wrap-safe comparison of two times in OS 'ticks' (1 if a is before b). The OS
+* 'ticks' counter is 32-bit and wraps, so the times are compared through their
+* signed difference. Valid for times less than TIME_MAX_DELAY 'ticks' apart.
+*------------------------------------------------------------------------------*/
+#define TIME_BEFORE(a, b) ((int32_t) ((a) - (b)) < 0)
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	scheduler_init
 * Purpose:    	Initialise the scheduler
@@ -102,6 +126,31 @@ uint32_t scheduler_run(void);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	scheduler_lock
+* Purpose:    	Lock the scheduler. Until the matching scheduler_unlock, requests
+*				to reschedule are only recorded, so the running task can't be
+*				preempted by other tasks. Calls can be nested.
+* Arguments:	-
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t scheduler_lock(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	scheduler_unlock
+* Purpose:    	Unlock the scheduler. At the outermost unlock, the scheduler is run
+*				once if any rescheduling was requested while it was locked.
+* Arguments:	-
+* Returns: 
+* 		exit status, EXIT_FAILURE if the scheduler isn't locked
+--------------------------------------------------------------------------------*/
+uint32_t scheduler_unlock(void);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	scheduler_wake_tasks
 * Purpose:    	Wake all the tasks from the blocked queue which are now ready
@@ -156,7 +205,35 @@ uint32_t task_create_static(Task* toDeclare,  void* startAddr, void* stackBottom
 * Returns: 
 * 		exit status
 --------------------------------------------------------------------------------*/
-uint32_t task_sleep(uint64_t delay);
+uint32_t task_sleep(uint32_t delay);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_sleep_slack
+* Purpose:    	Suspend the execution of the currently running task for at least
+* 				the number of OS ticks given, allowing the wake-up to be delayed by
+*				the slack given, so that it can be shared with other tasks.
+* Arguments: 	
+*		delay - minimum number of OS 'ticks' to suspend execution of the task by
+*		slack - number of 'ticks' the wake-up can be delayed by 
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_sleep_slack(uint32_t delay, uint32_t slack);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_slack
+* Purpose:    	Set the wake-up slack used by the task_sleep calls of the 
+*				currently running task
+* Arguments: 	
+*		slack - number of 'ticks' the wake-ups can be delayed by
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_set_slack(uint32_t slack);
 
 
 
@@ -199,6 +276,91 @@ uint32_t task_remove(Task** queue, Task* toRemove);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	timer_add
+* Purpose:    	Set the wake-up time of the task given and add it to the blocked 
+*				queue in ascending 'waitCounter' order. The timer links of the task
+*				are used, so the task can be at the same time inserted to a 
+*				synchronisation object's waiting queue. The wake-up slack of the
+*				task (waitSlack) is added to the delay.
+* Arguments: 	
+* 		toInsert - task to insert
+*		delay - minimum number of OS 'ticks' to wake the task after (at most 
+*				TIME_MAX_DELAY)
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void timer_add(Task* toInsert, uint32_t delay);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	timer_remove
+* Purpose:    	Remove the task given from the blocked queue
+* Arguments: 	
+* 		toRemove - task to remove
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void timer_remove(Task* toRemove);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_wait
+* Purpose:    	Block the currently running task on the waiting queue given. If the
+*				timeout is finite, the task is also added to the blocked queue, so
+*				that it is woken by whichever event comes first.
+* Arguments: 	
+*		waitQueue - waiting queue of the synchronisation object (NULL if the task
+*					is woken directly, e.g. by a notification)
+*		waitingObj - synchronisation object waited on
+*		status - new status of the calling task (MTX_WAIT/SEM_WAIT/...)
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 
+* 		exit status
+--------------------------------------------------------------------------------*/
+uint32_t task_wait(Task** waitQueue, void* waitingObj, TaskState status, uint32_t timeout);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_wake
+* Purpose:    	Remove the task given from the waiting queue it is blocked on and
+*				from the blocked queue (if it has a timeout set) and make it ready.
+*				The scheduler has to be run by the caller.
+* Arguments: 	
+*		toWake - task to wake
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_wake(Task* toWake);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_priority
+* Purpose:    	Change the priority of the task given and re-insert it into the 
+*				queue it currently belongs to, so that the queue stays sorted.
+* Arguments: 	
+*		toUpdate - task to update
+*		priority - new priority of the task
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_set_priority(Task* toUpdate, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_set_return_value
+* Purpose:    	Overwrite the value the SVC call made by the task given returns
+*				(R0 register value in the task's exception stack frame)
+* Arguments: 	
+*		toUpdate - task blocked inside an SVC call
+*		value - value to return
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_set_return_value(Task* toUpdate, uint32_t value);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	task_init
 * Purpose:    	Initialise the task control block and stack frame for the task specified
@@ -214,6 +376,35 @@ uint32_t task_init(Task* toInit, void* startAddr, uint8_t isPrivileged, uint8_t
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	task_control_init
+* Purpose:    	Initialise the fields of the task control block given and assign
+*				the task its ID
+* Arguments: 	
+*		toInit - pointer to the task control block to initialise
+*		isPrivileged - 1 if the task to initialise should be priviliged, 0 otherwise
+*		priority - priority of the task to initialise
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_control_init(Task* toInit, uint8_t isPrivileged, uint8_t priority);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	task_frame_init
+* Purpose:    	Initialise the stack frame the task given is started with. The 
+*				frame is placed at the task's SP value.
+* Arguments: 	
+*		toInit - pointer to the task to have the stack frame initialised
+*		startAddr - address of the first instruction of the task
+*		returnAddr - address the task returns to once completed
+*		isPrivileged - 1 if the task should be priviliged, 0 otherwise
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void task_frame_init(Task* toInit, void* startAddr, void* returnAddr, uint8_t isPrivileged);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	task_complete_handler
 * Purpose:    	Code to be executed should a task return
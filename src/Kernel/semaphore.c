@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	02/02/2016
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	Semaphores are a standard task synchronisation primitive. Contrary to mutual
@@ -13,6 +13,17 @@
 *	event. Semaphores can be also released by a different task than the ones which took
 *	it. The semaphore waiting queue is arranged in descending priority order.
 *
+*	The user API (KrisOS_sem_*) updates the counter in thread mode with exclusive
+*	load/store (LDREX/STREX) whenever no task has to block or be woken up. Any 
+*	exception taken between the two instructions makes the store fail, so the 
+*	counter can't be corrupted by a concurrent kernel or ISR update. The SVC call
+*	(KrisOS_sem_*_slow) is made only if the counter is zero on acquire or there
+*	are tasks waiting on release.
+*
+*	Coroutines don't block on semaphores. A coroutine awaiting a semaphore is
+*	registered with it instead, and a release notifies the coroutine executor
+*	task if there are any registered.
+*
 *	BLOCKING SEMAPHORE ACQUISITION IS NOT ALLOWED INSIDE INTERRUPT HANDLERS! 
 *	SVC calls made by the user will generate HardFault when these calls
 *	occur inside interrupt handlers, which already run in Handler processor mode.
@@ -40,11 +51,15 @@ uint32_t sem_init(Semaphore* toInit, uint32_t startVal) {
 	// Initialise the semaphore parameters according to the input arguments
 	toInit->waitingQueue = NULL;
 	toInit->counter = startVal;
+	#ifdef USE_COROUTINE
+		toInit->coroutineWaiters = 0;
+	#endif
 	
 	// Update the total number of semaphores declared
 	#ifdef SHOW_DIAGNOSTIC_DATA
 		KrisOS.totalSemNo++;
 	#endif	
+	kernel_info_count(&kernelInfo.semNo, 1);
 	return EXIT_SUCCESS;
 }
 
@@ -93,6 +108,7 @@ uint32_t sem_delete(Semaphore* toDelete) {
 		#ifdef SHOW_DIAGNOSTIC_DATA
 			KrisOS.totalSemNo--;	
 		#endif		
+		kernel_info_count(&kernelInfo.semNo, -1);
 		
 		// Free the heap memory occupied (if allocated on heap)
 		#ifdef USE_HEAP
@@ -146,6 +162,22 @@ uint32_t sem_try_acquire(Semaphore* toAcquire) {
 * Returns: -
 --------------------------------------------------------------------------------*/
 uint32_t sem_acquire(Semaphore* toAcquire) {
+	return sem_acquire_timed(toAcquire, TIME_INFINITY);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	sem_acquire_timed
+* Purpose:    	Decrement the semaphore. Wait if unsuccessful, but for no longer
+*				than the timeout specified.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status. If the timeout expires first, the SVC call returns EXIT_TIMEOUT
+--------------------------------------------------------------------------------*/
+uint32_t sem_acquire_timed(Semaphore* toAcquire, uint32_t timeout) {
 
 	// Validate the semaphore pointer
 	TEST_NULL_POINTER(toAcquire)
@@ -153,20 +185,8 @@ uint32_t sem_acquire(Semaphore* toAcquire) {
 	{		
 		// Try non-blicking acquisition of the semaphore. If it fails force the 
 		// calling task to wait on this semaphore
-		if (sem_try_acquire(toAcquire) == EXIT_FAILURE) {
-			
-			// Link the semaphore with the calling task
-			scheduler.runPtr->waitingObj = toAcquire;
-			
-			// Remove the calling task from the ready queue and re-run the 
-			// scheduler as the state of the ready queue has changed
-			task_remove(&scheduler.ready, scheduler.runPtr);
-			scheduler.runPtr->status = SEM_WAIT;
-			scheduler_run();
-			
-			// Add the calling task to the semaphore waiting queue
-			task_add(&toAcquire->waitingQueue, scheduler.runPtr);
-		}	
+		if (sem_try_acquire(toAcquire) == EXIT_FAILURE) 
+			task_wait(&toAcquire->waitingQueue, toAcquire, SEM_WAIT, timeout);
 	}
 	__end_critical();
 	return EXIT_SUCCESS;
@@ -193,14 +213,18 @@ uint32_t sem_release(Semaphore* toRelease) {
 		// it up without changing the semaphore value
 		if (toRelease->waitingQueue != NULL) {
 			nextToAcquire = toRelease->waitingQueue;
-			task_remove(&toRelease->waitingQueue, nextToAcquire);
-			nextToAcquire->waitingObj = NULL;
-			task_add(&scheduler.ready, nextToAcquire);
+			task_wake(nextToAcquire);
 			scheduler_run();
 		}
 		// Otherwise increment the semaphore counter
 		else {
 			toRelease->counter++;
+			
+			// Let the coroutines awaiting the semaphore try to acquire it
+			#ifdef USE_COROUTINE
+				if (toRelease->coroutineWaiters)
+					coroutine_sem_released();
+			#endif
 		}
 	}
 	__end_critical();
@@ -218,6 +242,7 @@ uint32_t sem_release(Semaphore* toRelease) {
 *		exit status 
 --------------------------------------------------------------------------------*/
 uint32_t KrisOS_sem_release_ISR(Semaphore* toRelease) {
+	TEST_ISR_PRIORITY
 	return sem_release(toRelease);
 }
 
@@ -233,9 +258,108 @@ uint32_t KrisOS_sem_release_ISR(Semaphore* toRelease) {
 *		exit status 
 --------------------------------------------------------------------------------*/
 uint32_t KrisOS_sem_acquire_ISR(Semaphore* toAcquire) {
+	TEST_ISR_PRIORITY
 	return sem_try_acquire(toAcquire);
 }
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_try_acquire
+* Purpose:    	Attempt to decrement the semaphore. Don't wait if unsucessful.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+* Returns: 		
+*		exit status. EXIT_FAILURE if semaphore can't be taken
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_sem_try_acquire(Semaphore* toAcquire) {
+	
+	uint32_t counter;
+	TEST_NULL_POINTER(toAcquire)
+	
+	// Decrement the counter if it's positive. Repeat if an exception has been
+	// taken in the meantime
+	do {
+		counter = __ldrex(&toAcquire->counter);
+		if (counter == 0) {
+			__clrex();
+			return EXIT_FAILURE;
+		}
+	} while (__strex(counter - 1, &toAcquire->counter));
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_acquire
+* Purpose:    	Decrement the semaphore. Wait if unsuccessful.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_sem_acquire(Semaphore* toAcquire) {
+	
+	// Enter the kernel only if the calling task has to wait
+	if (KrisOS_sem_try_acquire(toAcquire) == EXIT_SUCCESS)
+		return EXIT_SUCCESS;
+	return KrisOS_sem_acquire_slow(toAcquire);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_acquire_timed
+* Purpose:    	Decrement the semaphore. Wait if unsuccessful, but for no longer
+*				than the timeout specified.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the semaphore hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_sem_acquire_timed(Semaphore* toAcquire, uint32_t timeout) {
+	
+	// Enter the kernel only if the calling task has to wait
+	if (KrisOS_sem_try_acquire(toAcquire) == EXIT_SUCCESS)
+		return EXIT_SUCCESS;
+	return KrisOS_sem_acquire_timed_slow(toAcquire, timeout);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_release
+* Purpose:    	Increment the semaphore.
+* Arguments:	
+*		toRelease - semaphore to release
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_sem_release(Semaphore* toRelease) {
+	
+	uint32_t counter;
+	TEST_NULL_POINTER(toRelease)
+	
+	// Increment the counter in thread mode, unless there is a task to wake
+	do {
+		counter = __ldrex(&toRelease->counter);
+		if (toRelease->waitingQueue != NULL) {
+			__clrex();
+			return KrisOS_sem_release_slow(toRelease);
+		}
+	} while (__strex(counter + 1, &toRelease->counter));
+	
+	// Let the coroutines awaiting the semaphore try to acquire it. They register
+	// before trying, so none can miss the release.
+	#ifdef USE_COROUTINE
+		if (toRelease->coroutineWaiters)
+			KrisOS_notify(&coroutineExecutorTask, 0, NOTIFY_INCREMENT);
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
 #endif
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	02/02/2016
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -75,6 +75,20 @@ uint32_t sem_acquire(Semaphore* toAcquire);
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	sem_acquire_timed
+* Purpose:    	Decrement the semaphore. Wait if unsuccessful, but for no longer
+*				than the timeout specified.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status. If the timeout expires first, the SVC call returns EXIT_TIMEOUT
+--------------------------------------------------------------------------------*/
+uint32_t sem_acquire_timed(Semaphore* toAcquire, uint32_t timeout);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	sem_release
 * Purpose:    	Increment the semaphore.
@@ -85,4 +99,45 @@ uint32_t sem_acquire(Semaphore* toAcquire);
 --------------------------------------------------------------------------------*/
 uint32_t sem_release(Semaphore* toRelease);
 
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_acquire_slow
+* Purpose:    	Decrement the semaphore inside the kernel. Wait if unsuccessful.
+*				SVC call.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_SEM_ACQUIRE) KrisOS_sem_acquire_slow(Semaphore* toAcquire);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_acquire_timed_slow
+* Purpose:    	Decrement the semaphore inside the kernel. Wait if unsuccessful, 
+*				but for no longer than the timeout specified. SVC call.
+* Arguments:	
+* 		toAcquire - semaphore to acquire
+*		timeout - maximum number of OS 'ticks' to wait for (TIME_INFINITY - no limit)
+* Returns: 		
+*		exit status, EXIT_TIMEOUT if the semaphore hasn't been taken on time
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_SEM_ACQUIRE_TIMED) KrisOS_sem_acquire_timed_slow(Semaphore* toAcquire, 
+																	uint32_t timeout);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_sem_release_slow
+* Purpose:    	Increment the semaphore inside the kernel, waking the top priority
+*				waiting task. SVC call.
+* Arguments:	
+*		toRelease - semaphore to release
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_SEM_RELEASE) KrisOS_sem_release_slow(Semaphore* toRelease);
+
 #endif
@@ -0,0 +1,110 @@
+/*******************************************************************************
+* File:     	seqlock.c
+* Brief:    	Sequence lock implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	A sequence lock protects data which is written rarely (or by a single writer) 
+*	and read often, by many readers. The writer increments the sequence counter 
+*	before and after updating the data, so the counter is odd while an update 
+*	is in progress. A reader samples the counter, copies the data and then checks
+*	the counter again. If the counter has changed (or was odd) the copy might be
+*	torn and the reader simply retries.
+*
+*	Writers must not interleave. In KrisOS they update the protected data inside
+*	a kernel critical section (SVC call or interrupt handler), so they never 
+*	block and never wait for readers. User code can protect its own data with
+*	the same functions, provided it has a single writer (or serialises the 
+*	writers, e.g. with a mutex). Readers don't modify the lock at all, they
+*	don't mask interrupts and can run in unprivileged Thread mode. Any number
+*	of readers can sample the protected data concurrently.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_init
+* Purpose:    	Initialise the sequence lock given
+* Arguments:	
+* 		toInit - sequence lock to initialise
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_init(SeqLock* toInit) {
+	
+	TEST_NULL_POINTER(toInit)
+	toInit->sequence = 0;
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_write_begin
+* Purpose:    	Mark the start of an update of the data protected by the lock. 
+*				Writers must not interleave, so it has to be called inside a
+*				critical section or by the only writer of the data.
+* Arguments:	
+* 		lock - sequence lock to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_seqlock_write_begin(SeqLock* lock) {
+	lock->sequence++;
+	__dmb(0xF);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_write_end
+* Purpose:    	Mark the end of an update of the data protected by the lock. 
+*				Has to be called by the writer which called
+*				KrisOS_seqlock_write_begin (inside the same critical section).
+* Arguments:	
+* 		lock - sequence lock to update
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void KrisOS_seqlock_write_end(SeqLock* lock) {
+	__dmb(0xF);
+	lock->sequence++;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_read_begin
+* Purpose:    	Start reading the data protected by the lock given
+* Arguments:	
+* 		lock - sequence lock to read
+* Returns: 		
+*		sequence number to pass to KrisOS_seqlock_read_retry
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_read_begin(const SeqLock* lock) {
+	
+	uint32_t sequence = lock->sequence;
+	__dmb(0xF);
+	return sequence;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_seqlock_read_retry
+* Purpose:    	Check if the data read since KrisOS_seqlock_read_begin might have
+*				been modified by a writer in the meantime.
+* Arguments:	
+* 		lock - sequence lock to check
+*		sequence - value returned by KrisOS_seqlock_read_begin
+* Returns: 		
+*		1 if the read has to be repeated, 0 if the data read is consistent
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_seqlock_read_retry(const SeqLock* lock, uint32_t sequence) {
+	
+	__dmb(0xF);
+	return (sequence & 1) || lock->sequence != sequence;
+}
@@ -0,0 +1,346 @@
+/*******************************************************************************
+* File:     	softtimer.c
+* Brief:    	Software timer service implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	Software timers run a callback function once (TIMER_ONE_SHOT) or periodically
+*	(TIMER_AUTO_RELOAD) without a task of their own. All the callbacks are run by
+*	a single high priority system task - the timer service task - so a periodic
+*	action costs a timer control block instead of a task with its private stack.
+*	Callbacks share the stack of the timer service task (TIMER_TASK_STACK_SIZE),
+*	so they should be short and MUST NOT BLOCK, otherwise all the other timers
+*	are delayed as well.
+*
+*	The running timers are kept in a hashed timer wheel: an array of 
+*	TIMER_WHEEL_SIZE doubly linked lists (slots) indexed by the expiry time 
+*	modulo the wheel size. Starting and stopping a timer take constant time, 
+*	however many timers are running. On each OS 'tick' the OS timer interrupt 
+*	only checks whether the slot of the current 'tick' is empty. If it isn't,
+*	the timer service task is notified. The task then visits the slots which 
+*	hold timers (at most TIMER_WHEEL_SIZE, however long it hasn't run for) and
+*	runs the callbacks of the timers whose expiry time has come. Timers further
+*	away than one revolution of the wheel stay in their slot until their expiry
+*	time is reached. Auto-reload timers are re-inserted one period after their
+*	previous expiry time, so their period doesn't drift when the callbacks are
+*	run late.
+*
+*	SOFTWARE TIMERS ARE NOT ALLOWED TO BE USED INSIDE INTERRUPT HANDLERS.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_SOFT_TIMER
+/*-------------------------------------------------------------------------------
+* Timer wheel
+--------------------------------------------------------------------------------*/
+static SoftTimer* timerWheel[TIMER_WHEEL_SIZE];
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_insert
+* Purpose:    	Insert the timer given into the wheel slot of its expiry time
+* Arguments:	
+* 		toInsert - timer to insert
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void soft_timer_insert(SoftTimer* toInsert) {
+	
+	SoftTimer** slot = &timerWheel[toInsert->expiry & (TIMER_WHEEL_SIZE - 1)];
+	
+	toInsert->previous = NULL;
+	toInsert->next = *slot;
+	if (*slot != NULL)
+		(*slot)->previous = toInsert;
+	*slot = toInsert;
+	toInsert->isActive = 1;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_remove
+* Purpose:    	Remove the timer given from its wheel slot
+* Arguments:	
+* 		toRemove - timer to remove
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void soft_timer_remove(SoftTimer* toRemove) {
+	
+	if (toRemove->previous != NULL)
+		toRemove->previous->next = toRemove->next;
+	else
+		timerWheel[toRemove->expiry & (TIMER_WHEEL_SIZE - 1)] = toRemove->next;
+	if (toRemove->next != NULL)
+		toRemove->next->previous = toRemove->previous;
+	toRemove->isActive = 0;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_take_expired
+* Purpose:    	Take a timer which has expired by the time given off the wheel 
+*				slot given. Auto-reload timers are inserted back, to expire one
+*				period after their previous expiry time.
+* Arguments:	
+*		slot - index of the wheel slot to search
+* 		now - current time (in OS 'ticks')
+* Returns: 		
+*		timer which has expired, NULL if there are no more in the slot
+--------------------------------------------------------------------------------*/
+static SoftTimer* soft_timer_take_expired(uint32_t slot, uint32_t now) {
+	
+	SoftTimer* iterator;
+	
+	__start_critical();
+	{
+		// Expiry times are never further than TIME_MAX_DELAY away, so the 
+		// signed difference handles the wrap-around of the 'tick' counter
+		iterator = timerWheel[slot];
+		while (iterator != NULL && (int32_t) (iterator->expiry - now) > 0)
+			iterator = iterator->next;
+		
+		if (iterator != NULL) {
+			soft_timer_remove(iterator);
+			if (iterator->mode == TIMER_AUTO_RELOAD) {
+				iterator->expiry += iterator->period;
+				soft_timer_insert(iterator);
+			}
+		}
+	}
+	__end_critical();
+	return iterator;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_service_init
+* Purpose:    	Initialise the timer wheel (no timers running)
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void soft_timer_service_init(void) {
+	
+	uint32_t index;
+	
+	for (index = 0; index < TIMER_WHEEL_SIZE; index++)
+		timerWheel[index] = NULL;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_tick
+* Purpose:    	Wake the timer service task if timers might expire at the current
+*				OS 'tick'. Called by the OS timer interrupt handler.
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void soft_timer_tick(void) {
+	if (timerWheel[KrisOS.ticks & (TIMER_WHEEL_SIZE - 1)] != NULL)
+		notify_give(&timerServiceTask, 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_init
+* Purpose:    	Initialise the software timer given. The timer is stopped.
+* Arguments:	
+* 		toInit - timer to initialise
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_init(SoftTimer* toInit, TimerCallback callback, uint32_t period, 
+						 uint8_t mode) {
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(toInit)
+	TEST_NULL_POINTER(callback)
+	if (period == 0 || period > TIME_MAX_DELAY || mode > TIMER_AUTO_RELOAD)
+		return EXIT_FAILURE;
+	
+	toInit->next = toInit->previous = NULL;
+	toInit->expiry = 0;
+	toInit->period = period;
+	toInit->callback = callback;
+	toInit->mode = mode;
+	toInit->isActive = 0;
+	
+	// Update the total number of software timers declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalTimerNo++;
+	#endif
+	return EXIT_SUCCESS;
+}
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_create
+* Purpose:    	Create a software timer using dynamic memory allocation
+* Arguments:	
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		pointer to the timer created
+--------------------------------------------------------------------------------*/
+SoftTimer* soft_timer_create(TimerCallback callback, uint32_t period, uint8_t mode) {
+	
+	SoftTimer* toCreate = malloc(sizeof(SoftTimer));
+	soft_timer_init(toCreate, callback, period, mode);
+	return toCreate;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_delete
+* Purpose:    	Stop the software timer given and delete it
+* Arguments:	
+* 		toDelete - timer to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_delete(SoftTimer* toDelete) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toDelete)
+	
+	__start_critical();
+	{
+		if (toDelete->isActive)
+			soft_timer_remove(toDelete);
+	
+		// Update the total number of software timers declared
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS.totalTimerNo--;
+		#endif
+		free(toDelete);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_start
+* Purpose:    	Start the software timer given, so that it expires after its 
+*				period. A timer which is already running isn't affected.
+* Arguments:	
+* 		toStart - timer to start
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_start(SoftTimer* toStart) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toStart)
+	
+	__start_critical();
+	{
+		if (!toStart->isActive) {
+			toStart->expiry = KrisOS.ticks + toStart->period;
+			soft_timer_insert(toStart);
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_stop
+* Purpose:    	Stop the software timer given
+* Arguments:	
+* 		toStop - timer to stop
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_stop(SoftTimer* toStop) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toStop)
+	
+	__start_critical();
+	{
+		if (toStop->isActive)
+			soft_timer_remove(toStop);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_reset
+* Purpose:    	Restart the software timer given, so that it expires a full period
+*				from now. A stopped timer is started.
+* Arguments:	
+* 		toReset - timer to restart
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_reset(SoftTimer* toReset) {
+	
+	// Validate the input argument
+	TEST_NULL_POINTER(toReset)
+	
+	__start_critical();
+	{
+		if (toReset->isActive)
+			soft_timer_remove(toReset);
+		toReset->expiry = KrisOS.ticks + toReset->period;
+		soft_timer_insert(toReset);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*******************************************************************************
+* Task: 	timerService
+* Purpose: 	Timer service task. Runs the callbacks of the software timers which
+*			have expired. Only the wheel slots holding timers are searched, so
+*			a pass costs the same however many 'ticks' it has to catch up with.
+*******************************************************************************/
+void timerService(void) {
+	
+	SoftTimer* expired;
+	uint32_t slot, now;
+	
+	while (1) {
+		KrisOS_notify_wait(NOTIFY_CLEAR, TIME_INFINITY);
+		
+		// Run the callbacks of all the timers due by now. A slot which is empty
+		// now can only get timers expiring in the future, so it is skipped 
+		// without entering a critical section.
+		now = KrisOS.ticks;
+		for (slot = 0; slot < TIMER_WHEEL_SIZE; slot++) {
+			if (timerWheel[slot] == NULL)
+				continue;
+			while ((expired = soft_timer_take_expired(slot, now)) != NULL)
+				expired->callback(expired);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*******************************************************************************
+* File:     	softtimer.h
+* Brief:    	Header file for softtimer.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_SOFT_TIMER
+/*-------------------------------------------------------------------------------
+* Timer service task control block (declared in scheduler.c)
+--------------------------------------------------------------------------------*/
+extern Task timerServiceTask;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_service_init
+* Purpose:    	Initialise the timer wheel (no timers running)
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void soft_timer_service_init(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_tick
+* Purpose:    	Wake the timer service task if timers might expire at the current
+*				OS 'tick'. Called by the OS timer interrupt handler.
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void soft_timer_tick(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_init
+* Purpose:    	Initialise the software timer given. The timer is stopped.
+* Arguments:	
+* 		toInit - timer to initialise
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_init(SoftTimer* toInit, TimerCallback callback, uint32_t period, 
+						 uint8_t mode);
+
+
+
+#ifdef USE_HEAP
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_create
+* Purpose:    	Create a software timer using dynamic memory allocation
+* Arguments:	
+*		callback - function run by the timer service task when the timer expires
+*		period - timer period (in OS 'ticks', 1 to TIME_MAX_DELAY)
+*		mode - TIMER_ONE_SHOT/TIMER_AUTO_RELOAD
+* Returns: 		
+*		pointer to the timer created
+--------------------------------------------------------------------------------*/
+SoftTimer* soft_timer_create(TimerCallback callback, uint32_t period, uint8_t mode);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_delete
+* Purpose:    	Stop the software timer given and delete it
+* Arguments:	
+* 		toDelete - timer to delete
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_delete(SoftTimer* toDelete);
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_start
+* Purpose:    	Start the software timer given, so that it expires after its 
+*				period. A timer which is already running isn't affected.
+* Arguments:	
+* 		toStart - timer to start
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_start(SoftTimer* toStart);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_stop
+* Purpose:    	Stop the software timer given
+* Arguments:	
+* 		toStop - timer to stop
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_stop(SoftTimer* toStop);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	soft_timer_reset
+* Purpose:    	Restart the software timer given, so that it expires a full period
+*				from now. A stopped timer is started.
+* Arguments:	
+* 		toReset - timer to restart
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t soft_timer_reset(SoftTimer* toReset);
+
+#endif
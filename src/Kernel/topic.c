@@ -0,0 +1,358 @@
+/*******************************************************************************
+* File:     	topic.c
+* Brief:    	Publish/subscribe topic bus
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 	
+*	A topic delivers every sample published on it to all of its subscribers 
+*	without copying the sample. The publisher loans a buffer from the topic's
+*	pool, fills it in place and publishes it. The buffer is then referenced from
+*	the ring of every subscriber and its reference count is set to the number of
+*	subscribers it was delivered to. Each subscriber receives a pointer to the
+*	sample and releases it when done. The last release returns the buffer to
+*	the pool.
+*
+*	Every subscriber has its own bounded ring of TOPIC_SUBSCRIBER_DEPTH samples
+*	and chooses what happens when it falls behind:
+*		1. TOPIC_DROP_OLDEST - the oldest unread sample is dropped to make room
+*		   for the new one, the publisher never waits for this subscriber.
+*		2. TOPIC_BLOCK - the publisher waits until the subscriber has room.
+*	Each topic and subscriber counts the samples dropped. The subscriber's lag
+*	is the number of samples published but not yet received.
+*
+*	Like queues, the blocking calls are user-level functions composed of 
+*	several SVC calls so that the PendSV interrupt can switch the context 
+*	between them (see queue.c). The pool and the rings are guarded by semaphores:
+*	'freeBuffers' counts the buffers left in the pool, 'samplesReady' and 
+*	'freeSlots' count the filled and the empty ring slots of a subscriber.
+*
+*	Subscribers should be registered before the samples are published. A
+*	subscriber with TOPIC_BLOCK policy added while a publisher is waiting
+*	for the other subscribers might miss that sample.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_TOPIC
+/*-------------------------------------------------------------------------------
+* Function:    	topic_buffer_put
+* Purpose:    	Drop a reference to the buffer given, return it to the pool if 
+*				this was the last one. Has to be called in a critical section.
+* Arguments:	
+* 		topic - topic the buffer belongs to
+*		buffer - buffer to dereference
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+static void topic_buffer_put(Topic* topic, TopicBuffer* buffer) {
+	
+	if (--buffer->refCount == 0) {
+		buffer->nextFree = topic->freeList;
+		topic->freeList = buffer;
+		sem_release(&topic->freeBuffers);
+	}
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_init
+* Purpose:    	Initialise the topic given and split the pool memory into buffers
+* Arguments:	
+* 		toInit - topic to initialise
+*		poolMemory - memory area for the sample buffers (8-byte aligned,
+*					 bufferNo * TOPIC_SLOT_SIZE(itemSize) bytes long)
+*		bufferNo - number of sample buffers in the pool
+*		itemSize - size of a single sample
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_init(Topic* toInit, void* poolMemory, size_t bufferNo, size_t itemSize) {
+	
+	TopicBuffer* buffer;
+	uint32_t index;
+	
+	// Validate the input parameters
+	TEST_NULL_POINTER(toInit)
+	TEST_NULL_POINTER(poolMemory)
+	TEST_INVALID_SIZE(bufferNo)
+	TEST_INVALID_SIZE(itemSize)
+	
+	// Link all the buffers in the pool into the free list
+	toInit->freeList = NULL;
+	for (index = 0; index < bufferNo; index++) {
+		buffer = (TopicBuffer*) ((uint8_t*) poolMemory + index * TOPIC_SLOT_SIZE(itemSize));
+		buffer->refCount = 0;
+		buffer->nextFree = toInit->freeList;
+		toInit->freeList = buffer;
+	}
+	sem_init(&toInit->freeBuffers, bufferNo);
+	
+	toInit->subscribers = NULL;
+	toInit->itemSize = itemSize;
+	toInit->published = toInit->dropped = 0;
+	
+	// Update the total number of topics declared
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		KrisOS.totalTopicNo++;
+	#endif	
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_subscribe
+* Purpose:    	Register a subscriber to the topic given
+* Arguments:	
+* 		topic - topic to subscribe to
+*		subscriber - subscriber to initialise and register
+*		policy - what to do when the subscriber's ring is full
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_subscribe(Topic* topic, TopicSubscriber* subscriber, TopicPolicy policy) {
+	
+	TEST_NULL_POINTER(topic)
+	TEST_NULL_POINTER(subscriber)
+	
+	// Initialise the subscriber's ring and the semaphores guarding it
+	subscriber->topic = topic;
+	subscriber->policy = policy;
+	subscriber->head = subscriber->tail = 0;
+	subscriber->dropped = 0;
+	sem_init(&subscriber->samplesReady, 0);
+	sem_init(&subscriber->freeSlots, TOPIC_SUBSCRIBER_DEPTH);
+	
+	// Add it to the topic's subscriber list
+	__start_critical();
+	{
+		subscriber->next = topic->subscribers;
+		topic->subscribers = subscriber;
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_take_buffer
+* Purpose:    	Take a buffer off the pool's free list. The caller must have 
+*				acquired the 'freeBuffers' semaphore first.
+* Arguments:	
+* 		topic - topic to take the buffer from
+* Returns: 		
+*		pointer to the sample memory of the buffer
+--------------------------------------------------------------------------------*/
+void* topic_take_buffer(Topic* topic) {
+	
+	TopicBuffer* buffer;
+	
+	__start_critical();
+	{
+		buffer = topic->freeList;
+		topic->freeList = buffer->nextFree;
+		buffer->refCount = 1;
+	}
+	__end_critical();
+	return buffer + 1;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_deliver
+* Purpose:    	Place the sample given in the ring of every subscriber of the topic.
+*				TOPIC_BLOCK subscribers must have had a slot reserved by the 
+*				caller (their 'freeSlots' semaphore acquired).
+* Arguments:	
+* 		topic - topic to publish on
+*		sample - sample memory obtained from topic_take_buffer
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_deliver(Topic* topic, void* sample) {
+	
+	TopicBuffer* buffer = (TopicBuffer*) sample - 1;
+	TopicSubscriber* subscriber;
+	
+	TEST_NULL_POINTER(topic)
+	TEST_NULL_POINTER(sample)
+	
+	__start_critical();
+	{
+		// The publisher's reference (taken by topic_take_buffer) is handed over
+		// to the first subscriber, each other subscriber adds a reference
+		buffer->refCount = 0;
+		topic->published++;
+		
+		// All the subscribers woken up are scheduled with a single decision
+		scheduler_lock();
+		for (subscriber = topic->subscribers; subscriber != NULL; subscriber = subscriber->next) {
+			
+			// Make room in a full ring by dropping the oldest sample. The number of 
+			// samples waiting doesn't change in this case. Otherwise, wake up the
+			// subscriber.
+			if (subscriber->head - subscriber->tail == TOPIC_SUBSCRIBER_DEPTH) {
+				topic_buffer_put(topic, subscriber->ring[subscriber->tail++ % TOPIC_SUBSCRIBER_DEPTH]);
+				subscriber->dropped++;
+				topic->dropped++;
+				#ifdef SHOW_DIAGNOSTIC_DATA
+					KrisOS.topicDrops++;
+				#endif
+			}
+			else {
+				sem_release(&subscriber->samplesReady);
+			}
+			
+			// Add the sample to the subscriber's ring
+			subscriber->ring[subscriber->head++ % TOPIC_SUBSCRIBER_DEPTH] = buffer;
+			buffer->refCount++;
+		}
+		scheduler_unlock();
+		
+		// Nobody listens, return the buffer to the pool straight away
+		if (buffer->refCount == 0) {
+			buffer->refCount = 1;
+			topic_buffer_put(topic, buffer);
+		}
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_take_sample
+* Purpose:    	Take the oldest sample off the subscriber's ring. The caller must
+*				have acquired the 'samplesReady' semaphore first.
+* Arguments:	
+* 		subscriber - subscriber to update
+* Returns: 		
+*		pointer to the sample
+--------------------------------------------------------------------------------*/
+void* topic_take_sample(TopicSubscriber* subscriber) {
+	
+	TopicBuffer* buffer;
+	
+	__start_critical();
+	{
+		buffer = subscriber->ring[subscriber->tail++ % TOPIC_SUBSCRIBER_DEPTH];
+		
+		// Let the publisher waiting for room in this ring carry on
+		if (subscriber->policy == TOPIC_BLOCK)
+			sem_release(&subscriber->freeSlots);
+	}
+	__end_critical();
+	return buffer + 1;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_release
+* Purpose:    	Drop the reference to the sample given
+* Arguments:	
+* 		topic - topic the sample was published on
+*		sample - sample to release
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_release(Topic* topic, void* sample) {
+	
+	TEST_NULL_POINTER(topic)
+	TEST_NULL_POINTER(sample)
+	
+	__start_critical();
+	{
+		topic_buffer_put(topic, (TopicBuffer*) sample - 1);
+	}
+	__end_critical();
+	return EXIT_SUCCESS;
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_loan
+* Purpose:    	Get an empty sample buffer from the topic's pool. Wait if the 
+*				pool is empty.
+* Arguments:	
+* 		topic - topic to publish on later
+* Returns: 		
+*		pointer to the sample memory to fill in
+--------------------------------------------------------------------------------*/
+void* KrisOS_topic_loan(Topic* topic) {
+	
+	TEST_NULL_POINTER(topic)
+	
+	// Wait for a free buffer, then take it off the free list
+	KrisOS_sem_acquire(&topic->freeBuffers);
+	return KrisOS_topic_take_buffer(topic);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_publish
+* Purpose:    	Deliver the sample to all subscribers of the topic. Wait for the 
+*				TOPIC_BLOCK subscribers which have no room left.
+* Arguments:	
+* 		topic - topic to publish on
+*		sample - sample buffer obtained from KrisOS_topic_loan
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_topic_publish(Topic* topic, void* sample) {
+	
+	TopicSubscriber* subscriber;
+	
+	TEST_NULL_POINTER(topic)
+	
+	// Reserve a slot in the ring of each subscriber which doesn't accept drops
+	for (subscriber = topic->subscribers; subscriber != NULL; subscriber = subscriber->next) 
+		if (subscriber->policy == TOPIC_BLOCK)
+			KrisOS_sem_acquire(&subscriber->freeSlots);
+	
+	return KrisOS_topic_deliver(topic, sample);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_receive
+* Purpose:    	Get the oldest unread sample. Wait if there are none.
+* Arguments:	
+* 		subscriber - subscriber reading the topic
+* Returns: 		
+*		pointer to the sample, release it with KrisOS_topic_release when done
+--------------------------------------------------------------------------------*/
+const void* KrisOS_topic_receive(TopicSubscriber* subscriber) {
+	
+	TEST_NULL_POINTER(subscriber)
+	
+	KrisOS_sem_acquire(&subscriber->samplesReady);
+	return KrisOS_topic_take_sample(subscriber);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_lag
+* Purpose:    	Get the number of samples published but not yet received by 
+*				the subscriber given
+* Arguments:	
+* 		subscriber - subscriber to check
+* Returns: 		
+*		number of samples waiting
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_topic_lag(const TopicSubscriber* subscriber) {
+	return subscriber->head - subscriber->tail;
+}
+#endif
@@ -0,0 +1,136 @@
+/*******************************************************************************
+* File:     	topic.h
+* Brief:    	Header file for topic.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_TOPIC
+/*-------------------------------------------------------------------------------
+* Function:    	topic_init
+* Purpose:    	Initialise the topic given and split the pool memory into buffers
+* Arguments:	
+* 		toInit - topic to initialise
+*		poolMemory - memory area for the sample buffers (8-byte aligned,
+*					 bufferNo * TOPIC_SLOT_SIZE(itemSize) bytes long)
+*		bufferNo - number of sample buffers in the pool
+*		itemSize - size of a single sample
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_init(Topic* toInit, void* poolMemory, size_t bufferNo, size_t itemSize);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_subscribe
+* Purpose:    	Register a subscriber to the topic given
+* Arguments:	
+* 		topic - topic to subscribe to
+*		subscriber - subscriber to initialise and register
+*		policy - what to do when the subscriber's ring is full
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_subscribe(Topic* topic, TopicSubscriber* subscriber, TopicPolicy policy);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_take_buffer
+* Purpose:    	Take a buffer off the pool's free list. The caller must have 
+*				acquired the 'freeBuffers' semaphore first.
+* Arguments:	
+* 		topic - topic to take the buffer from
+* Returns: 		
+*		pointer to the sample memory of the buffer
+--------------------------------------------------------------------------------*/
+void* topic_take_buffer(Topic* topic);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_take_buffer
+* Purpose:    	Take a buffer off the pool's free list. SVC call.
+* Arguments:	
+* 		topic - topic to take the buffer from
+* Returns: 		
+*		pointer to the sample memory of the buffer
+--------------------------------------------------------------------------------*/
+void* __svc(SVC_TOPIC_TAKE_BUFFER) KrisOS_topic_take_buffer(Topic* topic);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_deliver
+* Purpose:    	Place the sample given in the ring of every subscriber of the topic.
+*				TOPIC_BLOCK subscribers must have had a slot reserved by the 
+*				caller (their 'freeSlots' semaphore acquired).
+* Arguments:	
+* 		topic - topic to publish on
+*		sample - sample memory obtained from topic_take_buffer
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_deliver(Topic* topic, void* sample);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_deliver
+* Purpose:    	Place the sample given in the ring of every subscriber of the topic.
+*				SVC call.
+* Arguments:	
+* 		topic - topic to publish on
+*		sample - sample memory obtained from topic_take_buffer
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t __svc(SVC_TOPIC_DELIVER) KrisOS_topic_deliver(Topic* topic, void* sample);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_take_sample
+* Purpose:    	Take the oldest sample off the subscriber's ring. The caller must
+*				have acquired the 'samplesReady' semaphore first.
+* Arguments:	
+* 		subscriber - subscriber to update
+* Returns: 		
+*		pointer to the sample
+--------------------------------------------------------------------------------*/
+void* topic_take_sample(TopicSubscriber* subscriber);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_topic_take_sample
+* Purpose:    	Take the oldest sample off the subscriber's ring. SVC call.
+* Arguments:	
+* 		subscriber - subscriber to update
+* Returns: 		
+*		pointer to the sample
+--------------------------------------------------------------------------------*/
+void* __svc(SVC_TOPIC_TAKE_SAMPLE) KrisOS_topic_take_sample(TopicSubscriber* subscriber);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	topic_release
+* Purpose:    	Drop the reference to the sample given
+* Arguments:	
+* 		topic - topic the sample was published on
+*		sample - sample to release
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t topic_release(Topic* topic, void* sample);
+
+#endif
@@ -0,0 +1,174 @@
+/*******************************************************************************
+* File:     	workqueue.c
+* Brief:    	Deferred interrupt work queues implementation
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*	An interrupt handler which has more to do than clearing its interrupt 
+*	source either does the work with other interrupts masked or signals 
+*	a dedicated task, which costs a stack and a scheduler slot per interrupt. 
+*	Work queues let the handlers defer the work (a function and its argument) 
+*	to a few shared worker tasks instead. There are WORKQUEUE_NO queues, each 
+*	run by its own privileged worker task with the priority given in 
+*	WORKQUEUE_PRIORITIES, so urgent and background work can be separated.
+*
+*	Each queue is a ring buffer. Producers reserve a slot with LDREX/STREX, so
+*	interrupt handlers of any priority allowed to call the kernel can submit
+*	work at the same time in O(1) without any lock. The item is published by 
+*	writing its function last. The worker takes the items in order and stops at
+*	the first slot which hasn't been published yet. The producer which has 
+*	reserved it notifies the worker when it finishes, so no item is missed.
+*	The functions run in the worker task, so they can block and use any KrisOS
+*	call available to the tasks.
+*
+*	The number of items waiting and the time from the submission of an item
+*	until its worker starts running it are recorded for the statistics task.
+*******************************************************************************/
+#include "system.h"
+#include "kernel.h"
+
+
+
+#ifdef USE_WORKQUEUE
+/*-------------------------------------------------------------------------------
+* Work queues, their worker tasks and the workers' private stacks (8-byte 
+* aligned, as required by the procedure call standard)
+--------------------------------------------------------------------------------*/
+WorkQueue workQueues[WORKQUEUE_NO];
+static Task workerTask[WORKQUEUE_NO];
+static uint8_t workerStack[WORKQUEUE_NO][WORKQUEUE_STACK_SIZE] __attribute__((aligned(8)));
+static const uint8_t workerPriority[WORKQUEUE_NO] = WORKQUEUE_PRIORITIES;
+
+
+
+/*******************************************************************************
+* Task: 	workqueue_worker
+* Purpose: 	Worker task. Runs the work items of its queue in submission order.
+*******************************************************************************/
+static void workqueue_worker(void) {
+	
+	// The worker's queue is found by the position of its task control block
+	WorkQueue* queue = &workQueues[scheduler.runPtr - workerTask];
+	WorkItem* item;
+	WorkFunction function;
+	void* argument;
+	
+	while (1) {
+		KrisOS_notify_wait(NOTIFY_CLEAR, TIME_INFINITY);
+		
+		// Take the published items until a free (or not yet published) slot 
+		while ((function = (item = &queue->items[queue->taken & 
+			   (WORKQUEUE_CAPACITY - 1)])->function) != NULL) {
+			argument = item->argument;
+			#ifdef SHOW_DIAGNOSTIC_DATA
+				cycle_stat_update(&queue->latency, item->submitted);
+				if (queue->reserved - queue->taken > queue->peakPending)
+					queue->peakPending = queue->reserved - queue->taken;
+			#endif
+			
+			// Free the slot before running the function, so the queue can be 
+			// refilled meanwhile
+			item->function = NULL;
+			queue->taken++;
+			function(argument);
+		}
+	}
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	workqueue_service_init
+* Purpose:    	Initialise the work queues and create their worker tasks
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void workqueue_service_init(void) {
+	
+	uint32_t queue;
+	uint32_t index;
+	
+	for (queue = 0; queue < WORKQUEUE_NO; queue++) {
+		for (index = 0; index < WORKQUEUE_CAPACITY; index++)
+			workQueues[queue].items[index].function = NULL;
+		workQueues[queue].reserved = workQueues[queue].taken = 0;
+		
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			workQueues[queue].peakPending = 0;
+			cycle_stat_reset(&workQueues[queue].latency);
+			KrisOS_task_stack_usage((uint32_t*) &workerStack[queue][0], WORKQUEUE_STACK_SIZE);
+		#endif
+		task_create_static(&workerTask[queue], workqueue_worker, 
+						   &workerStack[queue][WORKQUEUE_STACK_SIZE], workerPriority[queue], 1);
+	}
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	work_submit
+* Purpose:    	Submit a work item to the work queue given and notify its worker
+* Arguments:	
+* 		queue - work queue number (0 to WORKQUEUE_NO - 1)
+*		function - function to run
+*		argument - argument to run the function with
+* Returns: 		
+*		exit status, EXIT_FAILURE if the queue is full
+--------------------------------------------------------------------------------*/
+uint32_t work_submit(uint32_t queue, WorkFunction function, void* argument) {
+	
+	WorkQueue* toSubmit;
+	WorkItem* item;
+	uint32_t slot;
+	
+	// Validate the input arguments
+	TEST_NULL_POINTER(function)
+	if (queue >= WORKQUEUE_NO)
+		return EXIT_FAILURE;
+	toSubmit = &workQueues[queue];
+	
+	// Reserve a slot. A slot is free once the worker has taken the item which
+	// used it a full ring earlier.
+	do {
+		slot = __ldrex(&toSubmit->reserved);
+		if (slot - toSubmit->taken >= WORKQUEUE_CAPACITY) {
+			__clrex();
+			return EXIT_FAILURE;
+		}
+	} while (__strex(slot + 1, &toSubmit->reserved));
+	
+	// Fill in the slot and publish the item by writing its function
+	item = &toSubmit->items[slot & (WORKQUEUE_CAPACITY - 1)];
+	item->argument = argument;
+	#ifdef SHOW_DIAGNOSTIC_DATA
+		item->submitted = DWT->CYCCNT;
+	#endif
+	item->function = function;
+	
+	// Wake the worker. The notification is counted even if the worker is busy,
+	// so it looks at the queue again before waiting.
+	return notify_give(&workerTask[queue], 0, NOTIFY_INCREMENT);
+}
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	KrisOS_work_submit_ISR
+* Purpose:    	Submit a work item to the work queue given inside an interrupt 
+*				service routine
+* Arguments:	
+* 		queue - work queue number (0 to WORKQUEUE_NO - 1)
+*		function - function to run
+*		argument - argument to run the function with
+* Returns: 		
+*		exit status, EXIT_FAILURE if the queue is full
+--------------------------------------------------------------------------------*/
+uint32_t KrisOS_work_submit_ISR(uint32_t queue, WorkFunction function, void* argument) {
+	TEST_ISR_PRIORITY
+	return work_submit(queue, function, argument);
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*******************************************************************************
+* File:     	workqueue.h
+* Brief:    	Header file for workqueue.c
+* Author: 		Krzysztof Koch
+* Version:		V1.00
+* Date created:	18/10/2026
+* Last mod: 	18/10/2026
+*
+* Note: 		
+*******************************************************************************/
+#include "KrisOS.h"
+
+
+
+#ifdef USE_WORKQUEUE
+/*-------------------------------------------------------------------------------
+* Work item. The function is written last, so a non-NULL function marks an item
+* which is complete.
+--------------------------------------------------------------------------------*/
+typedef struct {
+	volatile WorkFunction function; 	// Function to run (NULL - slot free)
+	void* volatile argument; 			// Argument to run the function with
+#ifdef SHOW_DIAGNOSTIC_DATA
+	volatile uint32_t submitted; 		// CPU cycle counter value at submission
+#endif
+} WorkItem;
+
+
+
+/*-------------------------------------------------------------------------------
+* Work queue definition. A ring buffer with any number of producers (interrupt
+* handlers and SVC calls) and a single consumer (the worker task).
+--------------------------------------------------------------------------------*/
+typedef struct {
+	WorkItem items[WORKQUEUE_CAPACITY]; // Ring buffer of work items
+	volatile uint32_t reserved; 		// Number of slots taken by the producers
+	volatile uint32_t taken; 			// Number of items taken by the worker
+#ifdef SHOW_DIAGNOSTIC_DATA
+	uint32_t peakPending; 				// Most items waiting at the same time
+	CycleStat latency; 					// Time from submission to the worker
+#endif
+} WorkQueue;
+
+extern WorkQueue workQueues[WORKQUEUE_NO];
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	workqueue_service_init
+* Purpose:    	Initialise the work queues and create their worker tasks
+* Arguments:	-
+* Returns: 		-
+--------------------------------------------------------------------------------*/
+void workqueue_service_init(void);
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	work_submit
+* Purpose:    	Submit a work item to the work queue given and notify its worker
+* Arguments:	
+* 		queue - work queue number (0 to WORKQUEUE_NO - 1)
+*		function - function to run
+*		argument - argument to run the function with
+* Returns: 		
+*		exit status, EXIT_FAILURE if the queue is full
+--------------------------------------------------------------------------------*/
+uint32_t work_submit(uint32_t queue, WorkFunction function, void* argument);
+
+#endif
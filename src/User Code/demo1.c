@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	10/02/2017
-* Last mod: 	16/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 * 	Demo application showing mutual exclusion lock on the UART module in
@@ -21,7 +21,6 @@
 ------------------------------------------------------------------------------*/
 KrisOS_task_dynamic_template(primes, 400, 61)
 KrisOS_task_static_template(welcomeMessage, 256, 27)
-KrisOS_task_dynamic_template(ledPWM, 256, 41)
 
 
 
@@ -134,8 +133,9 @@ int main(void) {
 	KrisOS_task_create_static(&welcomeMessageTask, welcomeMessage, 
 		&welcomeMessageStack[welcomeMessageStackSize], welcomeMessagePriority); 
 	
-	// Create the RGB PWM LED task
-	ledPWMTaskPtr = KrisOS_task_create(ledPWM, ledPWMStackSize, ledPWMPriority);
+	// Start the RGB PWM LED colour transition (software timer, or a task if
+	// software timers are disabled)
+	ledPWM_start();
 	
 	// Run the operating system
 	KrisOS_start();
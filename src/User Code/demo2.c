@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	10/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 * 	Demo application showing aperiodic tasks interacting with the environment
@@ -12,6 +12,7 @@
 *	is used except for the KrisOS usage stats task and the UART driver.
 *******************************************************************************/
 #include "KrisOS.h"
+#include "led_pulse.h"
 
 
 
@@ -23,7 +24,6 @@ KrisOS_task_static_template(thermometerReader, 256, 53)
 KrisOS_task_static_template(lightSensor, 400, 13)
 KrisOS_task_dynamic_template(nokiaLCDSetup, 400, 1)
 KrisOS_task_dynamic_template(nokiaLCDBacklight, 256, 5)
-KrisOS_task_dynamic_template(ledPWM, 256, 7)
 
 
 
@@ -59,8 +59,9 @@ int main(void) {
 												  nokiaLCDBacklightStackSize, 
 												  nokiaLCDBacklightPriority);	  
 												  
-	// Create the RGB LED colour transition task
-	ledPWMTaskPtr = KrisOS_task_create(ledPWM, ledPWMStackSize, ledPWMPriority);
+	// Start the RGB LED colour transition (software timer, or a task if
+	// software timers are disabled)
+	ledPWM_start();
 	
 	// Run the operating system
 	KrisOS_start();
@@ -4,11 +4,13 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	09/03/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *	A program which shows a gradual RGB LED colour change thanks to changing the 
-*	duty cycle of the 3 LEDs in turns.
+*	duty cycle of the 3 LEDs in turns. Each step of the transition is made by
+*	a software timer callback, so the demo doesn't need a task of its own. With
+*	software timers disabled, a task makes the same steps between sleeps.
 *
 *	The Tiva C Launchpad on-board RGB LED is located at pins:
 *		1. PF1 - red
@@ -20,60 +22,96 @@
 
 
 
+/*-----------------------------------------------------------------------------
+* Colour transition sequence. Each phase dims (rising = 0) or brightens 
+* (rising = 1) one LED. Phase 0 is run once, then phases 1 to 6 are repeated.
+------------------------------------------------------------------------------*/
+#define RGB_PHASE_NO 7
+
+static const RGB_LED phaseColour[RGB_PHASE_NO] = {RED, BLUE, RED, GREEN, BLUE, RED, GREEN};
+static const uint8_t phaseRising[RGB_PHASE_NO] = {1, 1, 0, 1, 0, 1, 0};
+
+
+
+/*-----------------------------------------------------------------------------
+* Software timer (or task) stepping the colour transition and the transition
+* state
+------------------------------------------------------------------------------*/
+#ifdef USE_SOFT_TIMER
+	static SoftTimer ledPWMTimer;
+#else
+	KrisOS_task_static_template(ledPWM, 256, RGB_TASK_PRIORITY)
+#endif
+static uint32_t maxDuty;
+static uint32_t dutyCycle;
+static uint32_t phase;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	ledPWM_step
+* Purpose:    	Software timer callback which makes one step of the gentle RGB 
+*				colour transition by dimming/brightening the three LEDs in turn
+* Arguments:	
+*		expired - timer which has expired (NULL if called by the ledPWM task)
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+static void ledPWM_step(SoftTimer* expired) {
+	
+	ledPWM_set_duty(dutyCycle, phaseColour[phase]);
+	
+	// Move to the next duty cycle, or to the next phase at the end of the ramp.
+	// Brightening goes from 0 to maxDuty, dimming from maxDuty down to 1.
+	if (phaseRising[phase] ? dutyCycle++ == maxDuty : --dutyCycle == 0) {
+		phase = (phase == RGB_PHASE_NO - 1) ? 1 : phase + 1;
+		dutyCycle = phaseRising[phase] ? 0 : maxDuty;
+	}
+}
+
+
+
+#ifndef USE_SOFT_TIMER
 /*******************************************************************************
 * Task: 	ledPWM
-* Purpose: 	RGB LED controller task which displays gradual colout change
+* Purpose: 	RGB LED controller task which displays gradual colour change, used
+*			when software timers are disabled
 *******************************************************************************/
 void ledPWM(void) {
-	
-	// Current duty cycle of the LED which is now fading-down or fading-up
-	uint32_t dutyCycle;
-	
-	// Maximum duty cycle allowed for the PWM frequency specified 
-	uint32_t maxDuty;
-	
-	// Initialise the PWM on the RGB LED
-	maxDuty = ledPWM_init(RGB_LED_PWM_FREQ);
-	
-	// Make gentle transitions of the RGB colour by dimming/brightening
-	// all three LEDs in turn
-	for (dutyCycle = 0; dutyCycle <= maxDuty; dutyCycle++) {
-		ledPWM_set_duty(dutyCycle, RED);
+	while (1) {
+		ledPWM_step(NULL);
 		KrisOS_task_sleep(RGB_SWITCH_RATE);
 	}
+}
+#endif
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	ledPWM_start
+* Purpose:    	Initialise the PWM on the RGB LED and start the gradual colour 
+*				change, driven by an auto-reload software timer (no task needed)
+*				or, with software timers disabled, by a task of its own
+* Arguments:	-
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t ledPWM_start(void) {
 	
-	while (1) {
-		
-		for (dutyCycle = 0; dutyCycle <= maxDuty; dutyCycle++) {
-			ledPWM_set_duty(dutyCycle, BLUE);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-		
-		for (dutyCycle = maxDuty; dutyCycle > 0; dutyCycle--) {
-			ledPWM_set_duty(dutyCycle, RED);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-		
-		for (dutyCycle = 0; dutyCycle <= maxDuty; dutyCycle++) {
-			ledPWM_set_duty(dutyCycle, GREEN);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-		
-		for (dutyCycle = maxDuty; dutyCycle > 0; dutyCycle--) {
-			ledPWM_set_duty(dutyCycle, BLUE);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-		
-		for (dutyCycle = 0; dutyCycle <= maxDuty; dutyCycle++) {
-			ledPWM_set_duty(dutyCycle, RED);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-		
-		for (dutyCycle = maxDuty; dutyCycle > 0; dutyCycle--) {
-			ledPWM_set_duty(dutyCycle, GREEN);
-			KrisOS_task_sleep(RGB_SWITCH_RATE);
-		}
-	}
+	maxDuty = ledPWM_init(RGB_LED_PWM_FREQ);
+	dutyCycle = phase = 0;
+	
+	#ifdef USE_SOFT_TIMER
+		if (KrisOS_timer_init(&ledPWMTimer, ledPWM_step, RGB_SWITCH_RATE, 
+							  TIMER_AUTO_RELOAD) != EXIT_SUCCESS)
+			return EXIT_FAILURE;
+		return KrisOS_timer_start(&ledPWMTimer);
+	#else
+		#ifdef SHOW_DIAGNOSTIC_DATA
+			KrisOS_task_stack_usage((void*) ledPWMStack, ledPWMStackSize);
+		#endif
+		return KrisOS_task_create_static(&ledPWMTask, ledPWM, &ledPWMStack[ledPWMStackSize], 
+										 ledPWMPriority);
+	#endif
 }
 
 
@@ -82,7 +120,7 @@ void ledPWM(void) {
 * Function:    	ledPWM_init
 * Purpose:    	Initialise the PF1, PF2 and PF3 pins for PWM to control the RGB LED
 *				colour.
-* Arguments:
+* Arguments:	
 *		frequency - PWM LED frequency (same for all RGB pins), in Hz
 * Returns: 
 *		maximum duty cycle allowed given the frequency specified
@@ -133,7 +171,7 @@ uint32_t ledPWM_init(uint32_t frequency) {
 /*-------------------------------------------------------------------------------
 * Function:    	ledPWM_set_duty
 * Purpose:    	Set the PWM duty cycle of the LED colour given.
-* Arguments:
+* Arguments:	
 *		dutyCycle - duty cycle to set (in PWM clock ticks)
 *		colour - LED pin to change its duty cycle (red/green/blue)
 * Returns: 		-	
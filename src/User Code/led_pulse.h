@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	09/03/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 		
 *******************************************************************************/
@@ -26,6 +26,14 @@
 
 
 
+/*-----------------------------------------------------------------------------
+* Priority of the task stepping the colour transition when software timers are
+* disabled
+------------------------------------------------------------------------------*/
+#define RGB_TASK_PRIORITY 41
+
+
+
 /*-----------------------------------------------------------------------------
 * The three LED pins associated with PF1, PF2 and PF3 GPIO pins
 ------------------------------------------------------------------------------*/
@@ -37,11 +45,24 @@ typedef enum {
 
 
 
+/*-------------------------------------------------------------------------------
+* Function:    	ledPWM_start
+* Purpose:    	Initialise the PWM on the RGB LED and start the gradual colour 
+*				change, driven by an auto-reload software timer (no task needed)
+*				or, with software timers disabled, by a task of its own
+* Arguments:	-
+* Returns: 		
+*		exit status
+--------------------------------------------------------------------------------*/
+uint32_t ledPWM_start(void);
+
+
+
 /*-------------------------------------------------------------------------------
 * Function:    	ledPWM_init
 * Purpose:    	Initialise the PF1, PF2 and PF3 pins for PWM to control the RGB LED
 *				colour.
-* Arguments:
+* Arguments:	
 *		frequency - PWM LED frequency (same for all RGB pins), in Hz
 * Returns: 
 *		maximum duty cycle allowed given the frequency specified
@@ -53,7 +74,7 @@ uint32_t ledPWM_init(uint32_t frequency);
 /*-------------------------------------------------------------------------------
 * Function:    	ledPWM_set_duty
 * Purpose:    	Set the PWM duty cycle of the LED colour given.
-* Arguments:
+* Arguments:	
 *		dutyCycle - duty cycle to set (in PWM clock ticks)
 *		colour - LED pin to change its duty cycle (red/green/blue)
 * Returns: 		-	
@@ -4,16 +4,17 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	20/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 
 *	Program which warns the user when the illumination level around has exceeded
 *	the limit. An ADC is used with a digital comparator and an ADC0SS3 interrupt is 
 *	triggered when the converted sample from ADC connected to a photoresistor 
-*	exceeds the maximum allowable value. The interrupt handler then increments
-*	the semaphore, on which the task to handle the excessive illumination is 
-* 	waiting. The task then generates an alert sound and error message on the 
-*	nokia LCD screen.
+*	exceeds the maximum allowable value. The interrupt handler then notifies
+*	the task to handle the excessive illumination directly (task notification,
+*	no semaphore needed). The task then displays an error message on the nokia
+*	LCD screen and plays the alert sound - through a coroutine if coroutines 
+*	are enabled, otherwise by itself.
 *
 *	Tiva C launchpad pin usage:
 *		1. PB6 - piezo buzzer PWM output pin
@@ -27,10 +28,42 @@
 
 
 /*-------------------------------------------------------------------------------
-* Semaphore for synchronisation between the digital comparator interrupt handler
-* and the task for reacting to excessive amount of light.
+* Alert 'melody' tone frequencies (in Hz), one tone per 1000 OS 'ticks'
 --------------------------------------------------------------------------------*/
-Semaphore lightSensorSem;
+static const uint32_t alertTones[] = {700, 500, 1000};
+
+
+
+#ifdef USE_COROUTINE
+/*-------------------------------------------------------------------------------
+* Coroutine playing the alert 'melody'
+--------------------------------------------------------------------------------*/
+static Coroutine alertMelody;
+
+
+
+/*-------------------------------------------------------------------------------
+* Function:    	alert_melody
+* Purpose:    	Coroutine playing the alert 'melody', one tone per 1000 OS 'ticks'
+* Arguments:	
+*		self - the coroutine
+* Returns: 		
+*		CO_WAITING while the melody is played, CO_ENDED once finished
+--------------------------------------------------------------------------------*/
+static uint32_t alert_melody(Coroutine* self) {
+	
+	// Tone being played (static, as the coroutine has no stack of its own)
+	static uint32_t tone;
+	
+	KrisOS_co_begin(self);
+	for (tone = 0; tone < sizeof(alertTones) / sizeof(alertTones[0]); tone++) {
+		buzzer_tone(alertTones[tone]);
+		KrisOS_co_sleep(self, 1000);
+	}
+	buzzer_off();
+	KrisOS_co_end(self);
+}
+#endif
 
 
 
@@ -43,8 +76,10 @@ void lightSensor(void) {
 	// Helper cursor for drawing horizontal bars of the warining message
 	uint32_t cursor;
 	
-	// Initialise the semaphore for interrupt-task synchronisation
-	KrisOS_sem_init(&lightSensorSem, 0);
+	// Tone of the alert 'melody' being played (when played by this task)
+	#ifndef USE_COROUTINE
+		uint32_t tone;
+	#endif
 	
 	// Initialise the ADC module to read voltage level at the photoresistor
 	light_sensor_init();
@@ -53,9 +88,9 @@ void lightSensor(void) {
 	buzzer_init();
 
 	while(1) {
-		// Wait on the semaphore - wait untill ADC0SS3 IRQ is generated, which 
-		// releases this semaphore
-		KrisOS_sem_acquire(&lightSensorSem);
+		// Wait for a notification - wait untill ADC0SS3 IRQ is generated, which 
+		// notifies this task. The word counts alerts, as the semaphore did.
+		KrisOS_notify_wait(NOTIFY_DECREMENT, TIME_INFINITY);
 		
 		// Output the warning message on the LCD screen
 		KrisOS_mutex_lock(nokiaMtx);
@@ -67,14 +102,19 @@ void lightSensor(void) {
 			nokia5110_send(DATA, 0x02);
 		KrisOS_mutex_unlock(nokiaMtx);
 		
-		// Generate the sound alert
-		buzzer_tone(700);
-		KrisOS_task_sleep(1000);
-		buzzer_tone(500);
-		KrisOS_task_sleep(1000);
-		buzzer_tone(1000);
-		KrisOS_task_sleep(1000);
-		buzzer_off();
+		// Generate the sound alert. The 'melody' is played by a coroutine, which
+		// finishes before the warning message is cleared. Without coroutines 
+		// the task plays it itself.
+		#ifdef USE_COROUTINE
+			KrisOS_coroutine_start(&alertMelody, alert_melody, NULL);
+			KrisOS_task_sleep(3000);
+		#else
+			for (tone = 0; tone < sizeof(alertTones) / sizeof(alertTones[0]); tone++) {
+				buzzer_tone(alertTones[tone]);
+				KrisOS_task_sleep(1000);
+			}
+			buzzer_off();
+		#endif
 		
 		// Clear the warning message
 		KrisOS_task_sleep(5000);
@@ -152,8 +192,9 @@ void light_sensor_init(void) {
 	ADC0->IM |= (1 << IM_DCONSS3);
 	ADC0->ACTSS |= 1 << ACTSS_ASEN3;
 	
-	// Register the SS3 IRQs at NVIC with a significant priority
-	KrisOS_irq_set_prio(ADC0SS3_IRQn, 1);
+	// Register the SS3 IRQs at NVIC with a significant priority. The handler 
+	// notifies a task, so it can't be more urgent than MAX_SYSCALL_PRIORITY
+	KrisOS_irq_set_prio(ADC0SS3_IRQn, MAX_SYSCALL_PRIORITY);
 	KrisOS_irq_enable(ADC0SS3_IRQn);	
 }
 
@@ -244,7 +285,7 @@ void ADC0SS3_Handler(void) {
 	ADC0->ISC |= 1 << ISC_DCINSS3;
 	
 	// Notify the task responsible for handling the excessive light energy amount
-	KrisOS_sem_release_ISR(&lightSensorSem);
+	KrisOS_notify_ISR(&lightSensorTask, 0, NOTIFY_INCREMENT);
 }
 
 
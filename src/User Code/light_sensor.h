@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	21/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 
 *******************************************************************************/
@@ -30,10 +30,10 @@
 
 
 /*-------------------------------------------------------------------------------
-* Semaphore for synchronisation between the digital comparator interrupt handler
-* and the task for reacting to excessive amount of light.
+* Task reacting to excessive amount of light. Notified directly by the digital 
+* comparator interrupt handler.
 --------------------------------------------------------------------------------*/
-extern Semaphore lightSensorSem;
+extern Task lightSensorTask;
 
 
 
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	11/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 
 *	All code necessary for handling the LCD screen with PCD8544 controller from
@@ -211,9 +211,6 @@ void nokiaLCDSetup(void) {
 --------------------------------------------------------------------------------*/
 void nokia5110_init(void) {
 	
-	// Variable for adding a short delay during module reset
-	uint32_t delay;
-	
 	// Activate the SSI0 module and enable clock on port A. Add a small delay.
 	SYSCTL->RCGCSSI |= 1 << RCGC_SSI0;
 	SYSCTL->RCGCGPIO |= (1 << RCGCGPIO_PORTA); 
@@ -253,9 +250,9 @@ void nokia5110_init(void) {
 	// Re-enable SSI0
 	SSI0->CR1 |= 1 << CR1_SSE;
 	
-	// Reset the LCD screen controller
+	// Reset the LCD screen controller (the reset pulse has to be at least 100ns)
 	RST = RST_LOW;
-	for (delay = 0; delay < 10; delay++);
+	KrisOS_ndelay(100);
 	RST = RST_HIGH;
 	
 	// A set of setup commands send to the PCD8544 controller:
@@ -4,13 +4,16 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	25/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 
 *	The nokiaLCDBacklight waits for GPIOF interrupts generated by the button press.
 *	The interrupt handler increments the semaphore, for which this task is waiting.
 *	When the nokiaLCDBacklight task can continue, it switches the state of the GPIO
 *	PF0 pin to change the state of the backlight LED from on to off, or vice-versa.
+*	With work queues enabled, the task only sets up the pins and completes. The 
+*	interrupt handler defers switching the backlight to a work queue instead, 
+*	so no task (and stack) is kept just to wait for the button.
 *
 *	The following Tiva C GPIO pins are used for controlling the backlight operation:
 *		1. PB0 - LIGHT (on nokia 5110)
@@ -36,6 +39,22 @@ Semaphore* backlightSem;
 
 
 
+#ifdef USE_WORKQUEUE
+/*-------------------------------------------------------------------------------
+* Function:    	nokia5110_backlight_toggle
+* Purpose:    	Work item deferred by the GPIOF IRQ handler. Switch the backlight 
+*				state.
+* Arguments:	
+*		argument - unused
+* Returns: 		-	
+--------------------------------------------------------------------------------*/
+static void nokia5110_backlight_toggle(void* argument) {
+	LIGHT = !LIGHT;
+}
+#endif
+
+
+
 /*******************************************************************************
 * Task: 	nokiaLCDBacklight
 * Purpose: 	LED backlight controller task.
@@ -46,19 +65,25 @@ void nokiaLCDBacklight(void) {
 	uint32_t lightIsOff = 1;
 	
 	// Create the semaphore for synchronisation between the GPIOF IRQs and this task
-	backlightSem = KrisOS_sem_create(0);
+	#ifndef USE_WORKQUEUE
+		backlightSem = KrisOS_sem_create(0);
+	#endif
 	
 	// Setup the controller push button and the GPIO output pin for the backlight
 	nokia5110_backlight_switch_init();
 	nokia5110_backlight_control_pin_init();
+	LIGHT = lightIsOff;
 	
 	// Wait on a semaphore until the button is pressed then switch the backlight 
-	// state
-	while(1) {
-		LIGHT = lightIsOff;
-		KrisOS_sem_acquire(backlightSem);
-		lightIsOff = !lightIsOff;
-	}
+	// state. With work queues the button presses are handled by the worker task
+	// and this task completes.
+	#ifndef USE_WORKQUEUE
+		while(1) {
+			KrisOS_sem_acquire(backlightSem);
+			lightIsOff = !lightIsOff;
+			LIGHT = lightIsOff;
+		}
+	#endif
 }
 
 
@@ -112,9 +137,14 @@ void nokia5110_backlight_switch_init(void) {
 --------------------------------------------------------------------------------*/
 void GPIOF_Handler(void) {
 	
-	// Release the semaphore for which nokiaLCDBacklight task is waiting and clear
-	// the interrupt source
-	KrisOS_sem_release_ISR(backlightSem);
+	// Release the semaphore for which nokiaLCDBacklight task is waiting (or defer
+	// switching the backlight to the urgent work queue) and clear the interrupt 
+	// source
+	#ifdef USE_WORKQUEUE
+		KrisOS_work_submit_ISR(0, nokia5110_backlight_toggle, NULL);
+	#else
+		KrisOS_sem_release_ISR(backlightSem);
+	#endif
 	GPIOF->ICR |= 1 << PIN0;
 }
 
@@ -4,7 +4,7 @@
 * Author: 		Krzysztof Koch
 * Version:		V1.00
 * Date created:	15/02/2017
-* Last mod: 	09/03/2017
+* Last mod: 	18/10/2026
 *
 * Note: 
 *	Digital thermometer program that periodically reads the TC74 digital temperature
@@ -34,9 +34,11 @@
 
 /*-------------------------------------------------------------------------------
 * Queue for sending temperature values between the 'thermometerWriter' and 
-* 'thermometerReader' tasks
+* 'thermometerReader' tasks. Typed queue, items are copied with single byte 
+* loads/stores. Each side has one task, so they write/read it through the 
+* generated routines, without an SVC call unless one of them has to block.
 --------------------------------------------------------------------------------*/
-Queue* thermometerQueue;
+KrisOS_queue_typed_template(thermometer, int8_t, THERMOMETER_QUEUE_SIZE)
 
 
 
@@ -51,7 +53,8 @@ void thermometerWriter(void) {
 	int8_t temperature;
 	
 	// Initialise the inter-task queue
-	thermometerQueue = KrisOS_queue_create(THERMOMETER_QUEUE_SIZE, sizeof(int8_t));
+	KrisOS_queue_init_typed(&thermometerQueue, thermometerBuffer, thermometerCapacity, 
+							&thermometerOps);
 	
 	// Initialise the I2C module for communicating with the temperature sensor
 	i2c_init();
@@ -64,11 +67,12 @@ void thermometerWriter(void) {
 		temperature = i2c_read(START, STOP);
 		
 		// Write to the queue
-		KrisOS_queue_write(thermometerQueue, &temperature);
+		thermometerWrite(&thermometerQueue, &temperature);
 			
 		// The standard temperature converstion rate for TC74 is 8 samples/s so
-		// a delay is necessary
-		KrisOS_task_sleep(TEMPERATURE_CONVERSION_DELAY);
+		// a delay is necessary. It is only a minimum, so the wake-up can be 
+		// shared with other tasks.
+		KrisOS_task_sleep_slack(TEMPERATURE_CONVERSION_DELAY, TIMER_SLACK_MAX);
 	}
 }
 
@@ -94,7 +98,7 @@ void thermometerReader(void) {
 		// Accumulate the temperature readings and compute their average
 		temperatureAverage = 0;
 		for (sampleNo = 0; sampleNo < TEMP_AVERAG_SAMPLE_NO; sampleNo++) {
-			KrisOS_queue_read(thermometerQueue, &temperatureRead);
+			thermometerRead(&thermometerQueue, &temperatureRead);
 			temperatureAverage += temperatureRead;
 		}
 		temperatureAverage /= TEMP_AVERAG_SAMPLE_NO;